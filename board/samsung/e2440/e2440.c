@@ -27,6 +27,7 @@
 
 #include <common.h>
 #include <netdev.h>
+#include <bootstage.h>
 #include <asm/arch/s3c24x0_cpu.h>
 
 DECLARE_GLOBAL_DATA_PTR;
@@ -81,6 +82,9 @@ int board_init (void)
 					s3c24x0_get_base_clock_power();
 	struct s3c24x0_gpio * const gpio = s3c24x0_get_base_gpio();
 
+	/* the SPL time stamps depend on the PLL setting it ran with */
+	bootstage_spl_import ();
+
 	/* to reduce PLL lock time, adjust the LOCKTIME register */
 	clk_power->LOCKTIME = 0xFFFFFF;
 
@@ -0,0 +1,122 @@
+/*
+ * Boot stage time stamps
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+#ifdef USE_HOSTCC
+#include "mkimage.h"
+#include <time.h>
+#else
+#include <common.h>
+#endif
+#include <bootstage.h>
+
+static struct bootstage_record records[CONFIG_BOOTSTAGE_MAX];
+static int rec_count;
+static int rec_lost;
+static ulong time_base;
+
+#ifdef USE_HOSTCC
+ulong timer_get_boot_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000UL + ts.tv_nsec / 1000;
+}
+#else
+/*
+ * Fallback for CPUs without a dedicated helper: millisecond resolution
+ * is all get_timer() can give us.
+ */
+ulong __timer_get_boot_us(void)
+{
+	return get_timer(0) * (1000000 / CONFIG_SYS_HZ);
+}
+ulong timer_get_boot_us(void)
+	__attribute__((weak, alias("__timer_get_boot_us")));
+#endif
+
+/*
+ * Offset added to all following time stamps.  Used to continue the
+ * time line of an earlier stage (the NAND SPL) whose timer has been
+ * reprogrammed since.
+ */
+void bootstage_set_base(ulong time_us)
+{
+	time_base = time_us;
+}
+
+ulong bootstage_add_record(const char *name, ulong addr, ulong time_us)
+{
+	struct bootstage_record *rec;
+
+	if (rec_count >= CONFIG_BOOTSTAGE_MAX) {
+		rec_lost++;
+		return time_us;
+	}
+
+	rec = &records[rec_count++];
+	rec->name = name;
+	rec->addr = addr;
+	rec->time_us = time_us;
+
+	return time_us;
+}
+
+ulong bootstage_mark_addr(const char *name, ulong addr)
+{
+	return bootstage_add_record(name, addr,
+				    time_base + timer_get_boot_us());
+}
+
+ulong bootstage_mark(const char *name)
+{
+	return bootstage_mark_addr(name, 0);
+}
+
+const struct bootstage_record *bootstage_get_records(int *count)
+{
+	*count = rec_count;
+	return records;
+}
+
+void bootstage_report(void)
+{
+	struct bootstage_record *rec;
+	ulong prev = 0;
+	int i;
+
+	printf("Timer summary in microseconds:\n");
+	printf("%10s %10s  %s\n", "Mark", "Elapsed", "Stage");
+
+	for (i = 0, rec = records; i < rec_count; i++, rec++) {
+		printf("%10lu %10lu  %s", rec->time_us,
+		       rec->time_us - prev, rec->name);
+		if (rec->addr)
+			printf(" %08lx", rec->addr);
+		printf("\n");
+		prev = rec->time_us;
+	}
+
+	if (rec_lost)
+		printf("(%d stages not recorded, increase CONFIG_BOOTSTAGE_MAX)\n",
+		       rec_lost);
+}
@@ -34,6 +34,7 @@
 #include <bzlib.h>
 #include <environment.h>
 #include <lmb.h>
+#include <bootstage.h>
 #include <linux/ctype.h>
 #include <asm/byteorder.h>
 
@@ -63,10 +64,6 @@
 
 DECLARE_GLOBAL_DATA_PTR;
 
-#ifndef CONFIG_SYS_BOOTM_LEN
-#define CONFIG_SYS_BOOTM_LEN	0x800000	/* use 8MByte as default max gunzip size */
-#endif
-
 #ifdef CONFIG_BZIP2
 extern void bz_internal_error(int);
 #endif
@@ -617,9 +614,13 @@ int do_bootm (cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
 			return do_bootm_subcommand(cmdtp, flag, argc, argv);
 	}
 
+	bootstage_mark("bootm_start");
+
 	if (bootm_start(cmdtp, flag, argc, argv))
 		return 1;
 
+	bootstage_mark("bootm_verified");
+
 	/*
 	 * We have reached the point of no return: we are going to
 	 * overwrite all exception vector code, so we cannot easily
@@ -650,6 +651,7 @@ int do_bootm (cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
 #endif
 
 	ret = bootm_load_os(images.os, &load_end, 1);
+	bootstage_mark("bootm_loaded");
 
 	if (ret < 0) {
 		if (ret == BOOTM_ERR_RESET)
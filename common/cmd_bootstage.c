@@ -0,0 +1,57 @@
+/*
+ * Boot stage time stamps
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+#include <common.h>
+#include <command.h>
+#include <bootstage.h>
+
+int do_bootstage(cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
+{
+	if (argc > 2) {
+		cmd_usage(cmdtp);
+		return 1;
+	}
+
+	if (argc == 2) {
+		if (strcmp(argv[1], "mark") == 0) {
+			bootstage_mark("user");
+			return 0;
+		}
+		if (strcmp(argv[1], "report") != 0) {
+			cmd_usage(cmdtp);
+			return 1;
+		}
+	}
+
+	bootstage_report();
+
+	return 0;
+}
+
+U_BOOT_CMD(
+	bootstage,	2,	1,	do_bootstage,
+	"show boot stage time stamps",
+	"[report]\n"
+	"    - print the time stamps recorded since reset\n"
+	"bootstage mark\n"
+	"    - record the current time as stage \"user\""
+);
@@ -55,6 +55,7 @@ void set_working_fdt_addr(void *addr)
 	char buf[17];
 
 	working_fdt = addr;
+	fdt_index_blob(addr);
 
 	sprintf(buf, "%lx", (unsigned long)addr);
 	setenv("fdtaddr", buf);
@@ -165,6 +166,7 @@ int do_fdt (cmd_tbl_t * cmdtp, int flag, int argc, char *argv[])
 			return 1;
 		}
 		working_fdt = newaddr;
+		fdt_index_blob(newaddr);
 
 	/********************************************************************
 	 * Make a new node
@@ -34,7 +34,7 @@
 DECLARE_GLOBAL_DATA_PTR;
 
 #if defined(CONFIG_CMD_LOADB)
-static ulong load_serial_ymodem (ulong offset);
+static ulong load_serial_ymodem (ulong offset, int mode);
 #endif
 
 #if defined(CONFIG_CMD_LOADS)
@@ -481,8 +481,24 @@ int do_load_serial_bin (cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
 			offset,
 			load_baudrate);
 
-		addr = load_serial_ymodem (offset);
+		addr = load_serial_ymodem (offset, xyzModem_ymodem);
 
+		if (addr == ~0) {
+			printf ("## Binary (ymodem) download aborted\n");
+			rcode = 1;
+		}
+	} else if (strcmp(argv[0],"loadyg")==0) {
+		printf ("## Ready for binary (ymodem-g) download "
+			"to 0x%08lX at %d bps...\n",
+			offset,
+			load_baudrate);
+
+		addr = load_serial_ymodem (offset, xyzModem_ymodem_g);
+
+		if (addr == ~0) {
+			printf ("## Binary (ymodem-g) download aborted\n");
+			rcode = 1;
+		}
 	} else {
 
 		printf ("## Ready for binary (kermit) download "
@@ -963,19 +979,20 @@ static int getcxmodem(void) {
 		return (getc());
 	return -1;
 }
-static ulong load_serial_ymodem (ulong offset)
+static ulong load_serial_ymodem (ulong offset, int mode)
 {
 	int size;
 	char buf[32];
-	int err;
+	int err = 0;
 	int res;
 	connection_info_t info;
 	char ymodemBuf[1024];
 	ulong store_addr = ~0;
 	ulong addr = 0;
+	int broken;
 
 	size = 0;
-	info.mode = xyzModem_ymodem;
+	info.mode = mode;
 	res = xyzModem_stream_open (&info, &err);
 	if (!res) {
 
@@ -1002,13 +1019,23 @@ static ulong load_serial_ymodem (ulong offset)
 			}
 
 		}
+		if (err && mode == xyzModem_ymodem_g)
+			printf ("%s\n", xyzModem_error (err));
 	} else {
 		printf ("%s\n", xyzModem_error (err));
 	}
+	broken = err && mode == xyzModem_ymodem_g;
 
 	xyzModem_stream_close (&err);
-	xyzModem_stream_terminate (false, &getcxmodem);
+	/*
+	 * A broken ymodem-g transfer can't be retried, so stop the
+	 * sender instead of letting it stream into the console.
+	 */
+	xyzModem_stream_terminate (broken, &getcxmodem);
 
+	/* what arrived of a broken transfer is of no use */
+	if (broken)
+		return (~0);
 
 	flush_cache (offset, size);
 
@@ -1086,6 +1113,15 @@ U_BOOT_CMD(
 	" with offset 'off' and baudrate 'baud'"
 );
 
+U_BOOT_CMD(
+	loadyg, 3, 0,	do_load_serial_bin,
+	"load binary file over serial line (ymodem-g mode)",
+	"[ off ] [ baud ]\n"
+	"    - load binary file over an error free serial line"
+	" with offset 'off' and baudrate 'baud',\n"
+	"      blocks are streamed without waiting for an ACK"
+);
+
 #endif
 
 /* -------------------------------------------------------------------- */
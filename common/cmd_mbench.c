@@ -0,0 +1,74 @@
+/*
+ * SDRAM bandwidth and latency benchmark
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+
+#include <common.h>
+#include <command.h>
+#include <div64.h>
+#include <mbench.h>
+
+#ifndef CONFIG_SYS_MBENCH_SIZE
+#define CONFIG_SYS_MBENCH_SIZE	(1 << 20)
+#endif
+
+static unsigned long long mbench_start;
+
+unsigned long long mbench_time_ns(void)
+{
+	unsigned long long ticks = get_ticks() - mbench_start;
+	unsigned long long frac;
+	ulong tbclk = get_tbclk();
+
+	/* split into seconds and rest so ticks * 10^9 cannot overflow */
+	frac = do_div(ticks, tbclk) * 1000000000ULL;
+	do_div(frac, tbclk);
+
+	return ticks * 1000000000ULL + frac;
+}
+
+int do_mbench(cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
+{
+	ulong addr = CONFIG_SYS_MEMTEST_START;
+	ulong size = CONFIG_SYS_MBENCH_SIZE;
+	ulong loops = 4;
+
+	if (argc > 1)
+		addr = simple_strtoul(argv[1], NULL, 16);
+	if (argc > 2)
+		size = simple_strtoul(argv[2], NULL, 16);
+	if (argc > 3)
+		loops = simple_strtoul(argv[3], NULL, 10);
+
+	printf("mbench: 0x%08lx, 0x%lx bytes, %lu loops, D-cache %s\n",
+	       addr, size, loops, dcache_status() ? "on" : "off");
+
+	mbench_start = get_ticks();
+	return mbench((void *)addr, size, loops);
+}
+
+U_BOOT_CMD(
+	mbench,	4,	0,	do_mbench,
+	"SDRAM bandwidth and latency benchmark",
+	"[addr [size [loops]]]\n"
+	"    - read/write/copy bandwidth with byte, word and burst\n"
+	"      accesses, and random access latency (destroys the data)"
+);
@@ -198,6 +198,29 @@ int do_mmcops(cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
 			printf("%d blocks read: %s\n",
 				n, (n==cnt) ? "OK" : "ERROR");
 			return (n == cnt) ? 0 : 1;
+#ifdef CONFIG_SPARSE_IMAGE
+		} else if (strcmp(argv[1], "write.sparse") == 0) {
+			int dev = simple_strtoul(argv[2], NULL, 10);
+			void *addr = (void *)simple_strtoul(argv[3], NULL, 16);
+			ulong blk = simple_strtoul(argv[4], NULL, 16);
+			struct mmc *mmc = find_mmc_device(dev);
+			char *len = getenv("filesize");
+
+			if (!mmc)
+				return 1;
+			if (!len) {
+				puts("No image length, $filesize not set\n");
+				return 1;
+			}
+
+			printf("\nMMC write sparse: dev # %d, block # %ld ... ",
+				dev, blk);
+
+			mmc_init(mmc);
+
+			return mmc_write_sparse(mmc, blk, addr,
+					simple_strtoul(len, NULL, 16)) ? 1 : 0;
+#endif
 		} else if (strcmp(argv[1], "write") == 0) {
 			int dev = simple_strtoul(argv[2], NULL, 10);
 			void *addr = (void *)simple_strtoul(argv[3], NULL, 16);
@@ -234,6 +257,10 @@ U_BOOT_CMD(
 	"MMC sub system",
 	"read <device num> addr blk# cnt\n"
 	"mmc write <device num> addr blk# cnt\n"
+#ifdef CONFIG_SPARSE_IMAGE
+	"mmc write.sparse <device num> addr blk# - write sparse image\n"
+	"    of $filesize bytes\n"
+#endif
 	"mmc rescan <device num>\n"
 	"mmc list - lists available devices");
 #endif
@@ -16,6 +16,9 @@
 #include <asm/byteorder.h>
 #include <jffs2/jffs2.h>
 #include <nand.h>
+#ifdef CONFIG_CMD_NAND_TFTP
+#include <net.h>
+#endif
 
 #if defined(CONFIG_CMD_MTDPARTS)
 
@@ -79,6 +82,66 @@ static int nand_dump(nand_info_t *nand, ulong off, int only_oob)
 	return 0;
 }
 
+#ifdef CONFIG_CMD_NAND_TFTP
+static int nand_tftp_store(void *priv, ulong offset, const uchar *src,
+			   unsigned len)
+{
+	struct nand_stream *ns = priv;
+
+	/* a restarted transfer begins again with the first block */
+	if (offset == 0)
+		nand_stream_reset(ns);
+
+	if (offset != ns->total) {
+		printf("\nNAND tftp: out of order data at 0x%lx\n", offset);
+		return -1;
+	}
+
+	return nand_stream_write(ns, src, len);
+}
+
+static int nand_tftp_flush(void *priv)
+{
+	return nand_stream_flush(priv, 0);
+}
+
+/*
+ * Load a file by TFTP straight into flash: every complete erase block
+ * is programmed as soon as it has arrived, so neither the file size
+ * nor the programming time is limited by a RAM staging buffer.
+ */
+static int nand_tftp(nand_info_t *nand, ulong off, size_t size)
+{
+	struct nand_stream ns;
+	struct tftp_sink sink;
+	int ret;
+
+	if (nand_stream_open(&ns, nand, off, size))
+		return -1;
+
+	sink.store = nand_tftp_store;
+	sink.flush = nand_tftp_flush;
+	sink.priv = &ns;
+
+	TftpSink = &sink;
+	ret = NetLoop(TFTP);
+	TftpSink = NULL;
+
+	if (ret < 0) {
+		puts("NAND tftp: transfer failed, flash contents incomplete\n");
+	} else {
+		ret = nand_stream_flush(&ns, 1);
+		if (!ret)
+			ret = nand_stream_verify(&ns);
+		printf(" %zu bytes written: %s\n", ns.total,
+		       ret ? "ERROR" : "OK");
+	}
+
+	nand_stream_close(&ns);
+	return ret;
+}
+#endif
+
 /* ------------------------------------------------------------------------- */
 
 static inline int str2long(char *p, ulong *num)
@@ -271,7 +334,7 @@ int do_nand(cmd_tbl_t * cmdtp, int flag, int argc, char *argv[])
 	    strncmp(cmd, "dump", 4) != 0 &&
 	    strncmp(cmd, "read", 4) != 0 && strncmp(cmd, "write", 5) != 0 &&
 	    strcmp(cmd, "scrub") != 0 && strcmp(cmd, "markbad") != 0 &&
-	    strcmp(cmd, "biterr") != 0 &&
+	    strcmp(cmd, "biterr") != 0 && strcmp(cmd, "tftp") != 0 &&
 	    strcmp(cmd, "lock") != 0 && strcmp(cmd, "unlock") != 0 )
 		goto usage;
 
@@ -378,6 +441,36 @@ int do_nand(cmd_tbl_t * cmdtp, int flag, int argc, char *argv[])
 			else
 				ret = nand_write_skip_bad(nand, off, &size,
 							  (u_char *)addr);
+#ifdef CONFIG_LZMA
+		} else if (!strcmp(s, ".lzma") && read) {
+			size_t len = CONFIG_SYS_BOOTM_LEN;
+			char buf[12];
+
+			/* 'size' is the area the stream may spread over */
+			ret = nand_read_lzma(nand, off, size, (u_char *)addr,
+					     &len);
+			printf(" %zu bytes uncompressed: %s\n", len,
+			       ret ? "ERROR" : "OK");
+			if (ret == 0) {
+				sprintf(buf, "%zX", len);
+				setenv("filesize", buf);
+			}
+			return ret == 0 ? 0 : 1;
+#endif
+#ifdef CONFIG_SPARSE_IMAGE
+		} else if (!strcmp(s, ".sparse") && !read) {
+			char *len = getenv("filesize");
+
+			if (!len) {
+				puts("No image length, $filesize not set\n");
+				return 1;
+			}
+			/* 'size' limits the area the image may spread over */
+			ret = nand_write_sparse(nand, off, size, (void *)addr,
+					simple_strtoul(len, NULL, 16));
+			printf(" sparse image %s\n", ret ? "ERROR" : "OK");
+			return ret == 0 ? 0 : 1;
+#endif
 		} else if (!strcmp(s, ".oob")) {
 			/* out-of-band data */
 			mtd_oob_ops_t ops = {
@@ -401,6 +494,21 @@ int do_nand(cmd_tbl_t * cmdtp, int flag, int argc, char *argv[])
 		return ret == 0 ? 0 : 1;
 	}
 
+#ifdef CONFIG_CMD_NAND_TFTP
+	if (strcmp(cmd, "tftp") == 0) {
+		if (argc < 4)
+			goto usage;
+
+		printf("\nNAND tftp: ");
+		if (arg_off_size(argc - 3, argv + 3, nand, &off, &size) != 0)
+			return 1;
+
+		copy_filename(BootFile, argv[2], sizeof(BootFile));
+		ret = nand_tftp(nand, off, size);
+		return ret == 0 ? 0 : 1;
+	}
+#endif
+
 	if (strcmp(cmd, "markbad") == 0) {
 		argc -= 2;
 		argv += 2;
@@ -483,6 +591,21 @@ U_BOOT_CMD(nand, CONFIG_SYS_MAXARGS, 1, do_nand,
 	"nand write - addr off|partition size\n"
 	"    read/write 'size' bytes starting at offset 'off'\n"
 	"    to/from memory address 'addr', skipping bad blocks.\n"
+#ifdef CONFIG_LZMA
+	"nand read.lzma - addr off|partition size\n"
+	"    uncompress the LZMA stream in 'size' bytes at 'off'\n"
+	"    to 'addr' while reading it\n"
+#endif
+#ifdef CONFIG_SPARSE_IMAGE
+	"nand write.sparse - addr off|partition [size]\n"
+	"    write sparse image of $filesize bytes at 'addr', erasing\n"
+	"    (not writing) its empty parts, 'size' bytes available at 'off'\n"
+#endif
+#ifdef CONFIG_CMD_NAND_TFTP
+	"nand tftp - [hostIPaddr:]filename off|partition [size]\n"
+	"    write file from TFTP server directly to flash at 'off',\n"
+	"    block by block, skipping bad blocks, and verify it\n"
+#endif
 	"nand erase [clean] [off size] - erase 'size' bytes from\n"
 	"    offset 'off' (entire device if not specified)\n"
 	"nand bad - show bad blocks\n"
@@ -0,0 +1,65 @@
+/*
+ * Time the execution of a command
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+#include <common.h>
+#include <command.h>
+#include <div64.h>
+
+int do_time(cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
+{
+	cmd_tbl_t *cmd;
+	unsigned long long start, us;
+	ulong frac;
+	int rcode;
+
+	if (argc < 2) {
+		cmd_usage(cmdtp);
+		return 1;
+	}
+
+	cmd = find_cmd(argv[1]);
+	if (!cmd) {
+		printf("Unknown command '%s' - try 'help'\n", argv[1]);
+		return 1;
+	}
+	if (argc - 1 > cmd->maxargs) {
+		cmd_usage(cmd);
+		return 1;
+	}
+
+	start = get_ticks();
+	rcode = cmd->cmd(cmd, flag, argc - 1, argv + 1);
+	us = (get_ticks() - start) * 1000000ULL;
+	do_div(us, get_tbclk());
+	frac = do_div(us, 1000000);
+
+	printf("time: %lu.%06lu s\n", (ulong)us, frac);
+
+	return rcode;
+}
+
+U_BOOT_CMD(
+	time,	CONFIG_SYS_MAXARGS,	0,	do_time,
+	"run a command and report the time it took",
+	"command [args...]\n"
+	"    - e.g. 'time run bootcmd' times the bootcmd script"
+);
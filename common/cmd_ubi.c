@@ -311,7 +311,6 @@ static int ubi_volume_write(char *volume, void *buf, size_t size)
 static int ubi_volume_read(char *volume, char *buf, size_t size)
 {
 	int err, lnum, off, len, tbuf_size, i = 0;
-	size_t count_save = size;
 	void *tbuf;
 	unsigned long long tmp;
 	struct ubi_volume *vol = NULL;
@@ -352,7 +351,7 @@ static int ubi_volume_read(char *volume, char *buf, size_t size)
 	if (vol->corrupted)
 		printf("read from corrupted volume %d", vol->vol_id);
 	if (offp + size > vol->used_bytes)
-		count_save = size = vol->used_bytes - offp;
+		size = vol->used_bytes - offp;
 
 	tbuf_size = vol->usable_leb_size;
 	if (size < tbuf_size)
@@ -392,7 +391,7 @@ static int ubi_volume_read(char *volume, char *buf, size_t size)
 	} while (size);
 
 	free(tbuf);
-	return err ? err : count_save - size;
+	return err;
 }
 
 static int ubi_dev_scan(struct mtd_info *info, char *ubidev,
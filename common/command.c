@@ -100,25 +100,31 @@ int _do_help (cmd_tbl_t *cmd_start, int cmd_items, cmd_tbl_t * cmdtp, int
 /***************************************************************************
  * find command table entry for a command
  */
+/*
+ * Some commands allow length modifiers (like "cp.b");
+ * compare command name only until first dot.
+ */
+static int cmd_name_len(const char *cmd)
+{
+	const char *p = strchr(cmd, '.');
+
+	return p ? p - cmd : strlen(cmd);
+}
+
 cmd_tbl_t *find_cmd_tbl (const char *cmd, cmd_tbl_t *table, int table_len)
 {
 	cmd_tbl_t *cmdtp;
 	cmd_tbl_t *cmdtp_temp = table;	/*Init value */
-	const char *p;
 	int len;
 	int n_found = 0;
 
-	/*
-	 * Some commands allow length modifiers (like "cp.b");
-	 * compare command name only until first dot.
-	 */
-	len = ((p = strchr(cmd, '.')) == NULL) ? strlen (cmd) : (p - cmd);
+	len = cmd_name_len(cmd);
 
 	for (cmdtp = table;
 	     cmdtp != table + table_len;
 	     cmdtp++) {
 		if (strncmp (cmd, cmdtp->name, len) == 0) {
-			if (len == strlen (cmdtp->name))
+			if (cmdtp->name[len] == '\0')
 				return cmdtp;	/* full match */
 
 			cmdtp_temp = cmdtp;	/* abbreviated command ? */
@@ -132,10 +138,80 @@ cmd_tbl_t *find_cmd_tbl (const char *cmd, cmd_tbl_t *table, int table_len)
 	return NULL;	/* not found or ambiguous command */
 }
 
+/*
+ * The linker collects the commands in link order. The table is sorted
+ * by name on first use, so that lookups are a binary search and all
+ * abbreviations of a name are next to each other. If the table can't
+ * be written (still in flash), the linear search is used.
+ */
+static int cmd_table_sorted;
+
+static void sort_cmd_table(void)
+{
+	cmd_tbl_t *start = &__u_boot_cmd_start;
+	cmd_tbl_t *end = &__u_boot_cmd_end;
+	cmd_tbl_t *cmdtp, *p, tmp;
+
+	/* insertion sort, the table is small and mostly sorted anyway */
+	for (cmdtp = start + 1; cmdtp < end; cmdtp++) {
+		if (strcmp(cmdtp[-1].name, cmdtp->name) <= 0)
+			continue;
+		tmp = *cmdtp;
+		for (p = cmdtp; p > start && strcmp(p[-1].name, tmp.name) > 0;
+		     p--)
+			p[0] = p[-1];
+		*p = tmp;
+	}
+
+	for (cmdtp = start + 1; cmdtp < end; cmdtp++)
+		if (strcmp(cmdtp[-1].name, cmdtp->name) > 0)
+			return;
+	cmd_table_sorted = 1;
+}
+
+/* first command in the sorted table not below the first len chars of cmd */
+static cmd_tbl_t *find_cmd_prefix(const char *cmd, int len)
+{
+	cmd_tbl_t *lo = &__u_boot_cmd_start;
+	cmd_tbl_t *hi = &__u_boot_cmd_end;
+
+	while (lo < hi) {
+		cmd_tbl_t *mid = lo + (hi - lo) / 2;
+
+		if (strncmp(mid->name, cmd, len) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
 cmd_tbl_t *find_cmd (const char *cmd)
 {
-	int len = &__u_boot_cmd_end - &__u_boot_cmd_start;
-	return find_cmd_tbl(cmd, &__u_boot_cmd_start, len);
+	cmd_tbl_t *cmdtp;
+	int len;
+
+	if (!cmd_table_sorted) {
+		sort_cmd_table();
+		if (!cmd_table_sorted)
+			return find_cmd_tbl(cmd, &__u_boot_cmd_start,
+				&__u_boot_cmd_end - &__u_boot_cmd_start);
+	}
+
+	len = cmd_name_len(cmd);
+	cmdtp = find_cmd_prefix(cmd, len);
+	if (cmdtp == &__u_boot_cmd_end || strncmp(cmdtp->name, cmd, len))
+		return NULL;		/* not found */
+
+	/* a full match sorts before all longer names it abbreviates */
+	if (cmdtp->name[len] == '\0')
+		return cmdtp;
+
+	if (cmdtp + 1 != &__u_boot_cmd_end &&
+	    strncmp(cmdtp[1].name, cmd, len) == 0)
+		return NULL;		/* ambiguous abbreviation */
+
+	return cmdtp;
 }
 
 int cmd_usage(cmd_tbl_t *cmdtp)
@@ -200,8 +276,7 @@ void install_auto_complete(void)
 static int complete_cmdv(int argc, char *argv[], char last_char, int maxv, char *cmdv[])
 {
 	cmd_tbl_t *cmdtp;
-	const char *p;
-	int len, clen;
+	int len;
 	int n_found = 0;
 	const char *cmd;
 
@@ -235,25 +310,19 @@ static int complete_cmdv(int argc, char *argv[], char last_char, int maxv, char
 	}
 
 	cmd = argv[0];
-	/*
-	 * Some commands allow length modifiers (like "cp.b");
-	 * compare command name only until first dot.
-	 */
-	p = strchr(cmd, '.');
-	if (p == NULL)
-		len = strlen(cmd);
-	else
-		len = p - cmd;
-
-	/* return the partial matches */
-	for (cmdtp = &__u_boot_cmd_start; cmdtp != &__u_boot_cmd_end; cmdtp++) {
+	len = cmd_name_len(cmd);
 
-		clen = strlen(cmdtp->name);
-		if (clen < len)
-			continue;
+	/* return the partial matches, a range of the sorted table */
+	cmdtp = &__u_boot_cmd_start;
+	if (cmd_table_sorted)
+		cmdtp = find_cmd_prefix(cmd, len);
+	for (; cmdtp != &__u_boot_cmd_end; cmdtp++) {
 
-		if (memcmp(cmd, cmdtp->name, len) != 0)
+		if (strncmp(cmd, cmdtp->name, len) != 0) {
+			if (cmd_table_sorted)
+				break;
 			continue;
+		}
 
 		/* too many! */
 		if (n_found >= maxv - 2) {
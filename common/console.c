@@ -29,6 +29,13 @@
 
 DECLARE_GLOBAL_DATA_PTR;
 
+/*
+ * Serial drivers which queue output reimplement serial_flush(), to get
+ * it out before a reset or the jump to an OS
+ */
+void __serial_flush(void) {}
+void serial_flush(void) __attribute__((weak, alias("__serial_flush")));
+
 #ifdef CONFIG_AMIGAONEG3SE
 int console_changed = 0;
 #endif
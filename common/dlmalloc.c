@@ -1517,6 +1517,13 @@ void *sbrk(ptrdiff_t increment)
 	if ((new < mem_malloc_start) || (new > mem_malloc_end))
 		return NULL;
 
+	/*
+	 * Memory given back by malloc_trim() must read as zero when it is
+	 * handed out again, calloc() relies on that (MORECORE_CLEARS).
+	 */
+	if (increment < 0)
+		memset((void *)new, 0, -increment);
+
 	mem_malloc_brk = new;
 
 	return (void *)old;
@@ -22,6 +22,7 @@
  */
 
 #include <common.h>
+#include <malloc.h>
 #include <stdio_dev.h>
 #include <linux/ctype.h>
 #include <linux/types.h>
@@ -602,6 +603,42 @@ void fdt_fixup_crypto_node(void *blob, int sec_rev)
 }
 #endif /* defined(CONFIG_MPC83xx) || defined(CONFIG_MPC85xx) */
 
+#ifdef CONFIG_OF_LIBFDT_INDEX
+/*
+ * Index blob so that the path, phandle and compatible lookups of the
+ * fixups do not each walk the whole tree. NULL just drops the index.
+ */
+void fdt_index_blob(void *blob)
+{
+	static void *buf;
+	int size, err;
+
+	fdt_index_detach();
+	free(buf);
+	buf = NULL;
+
+	if (!blob)
+		return;
+
+	size = fdt_index_size(blob);
+	if (size < 0)
+		return;
+	/* room for the nodes added by the fixups */
+	size += size / 4;
+
+	buf = malloc(size);
+	if (!buf)
+		return;
+
+	err = fdt_index_attach(blob, buf, size);
+	if (err) {
+		debug("fdt_index_attach: %s\n", fdt_strerror(err));
+		free(buf);
+		buf = NULL;
+	}
+}
+#endif
+
 /* Resize the fdt to its actual size + a bit of padding */
 int fdt_resize(void *blob)
 {
@@ -280,8 +280,12 @@ struct variables {
 	int flg_export;
 	int flg_read_only;
 	struct variables *next;
+	struct variables *hash_next;	/* chain in var_hash[] */
 };
 
+/* local variables are also hashed by name, scripts look them up a lot */
+#define VAR_HASH_SIZE	32
+
 /* globals, connect us to the outside world
  * the first three support $?, $#, and $1 */
 #ifndef __U_BOOT__
@@ -315,6 +319,7 @@ static int flag_repeat = 0;
 static int do_repeat = 0;
 static struct variables *top_vars = NULL ;
 #endif /*__U_BOOT__ */
+static struct variables *var_hash[VAR_HASH_SIZE];
 
 #define B_CHUNK (100)
 #define B_NOSPAC 1
@@ -1539,11 +1544,37 @@ shell_terminal_error:
  * now has its stdout directed to the input of the appropriate pipe,
  * so this routine is noticeably simpler.
  */
+#ifdef CONFIG_SYS_HUSH_PARSE_CACHE
+/* set while a cached parse tree runs, see parse_string_cached() */
+static int parse_cache_running;
+
+/*
+ * Commands may change their argv[] strings, which would change a cached
+ * tree. Hand them a copy, array and strings in one allocation.
+ */
+static char **dup_argv(int argc, char **argv)
+{
+	char **copy, *p;
+	int i, len = 0;
+
+	for (i = 0; i < argc; i++)
+		len += strlen(argv[i]) + 1;
+	copy = xmalloc((argc + 1) * sizeof(char *) + len);
+	p = (char *)(copy + argc + 1);
+	for (i = 0; i < argc; i++) {
+		copy[i] = strcpy(p, argv[i]);
+		p += strlen(p) + 1;
+	}
+	copy[argc] = NULL;
+	return copy;
+}
+#endif
+
 static int run_pipe_real(struct pipe *pi)
 {
 	int i;
 #ifndef __U_BOOT__
-	int nextin, nextout;
+	int nextin, nextout, nvars;
 	int pipefds[2];				/* pipefds[0] is for reading */
 	struct child_prog *child;
 	struct built_in_command *x;
@@ -1556,7 +1587,7 @@ static int run_pipe_real(struct pipe *pi)
 	(void) &child;
 # endif
 #else
-	int nextin;
+	int nextin, nvars;
 	int flag = do_repeat ? CMD_FLAG_REPEAT : 0;
 	struct child_prog *child;
 	cmd_tbl_t *cmdtp;
@@ -1627,6 +1658,8 @@ static int run_pipe_real(struct pipe *pi)
 			}
 			return EXIT_SUCCESS;   /* don't worry about errors in set_local_var() yet */
 		}
+		/* count locally, a cached parse tree is run again */
+		nvars = child->sp;
 		for (i = 0; is_assignment(child->argv[i]); i++) {
 			p = insert_var_value(child->argv[i]);
 #ifndef __U_BOOT__
@@ -1635,11 +1668,11 @@ static int run_pipe_real(struct pipe *pi)
 			set_local_var(p, 0);
 #endif
 			if (p != child->argv[i]) {
-				child->sp--;
+				nvars--;
 				free(p);
 			}
 		}
-		if (child->sp) {
+		if (nvars) {
 			char * str = NULL;
 
 			str = make_string((child->argv + i));
@@ -1705,6 +1738,16 @@ static int run_pipe_real(struct pipe *pi)
 #else
 				/* OK - call function to do the command */
 
+#ifdef CONFIG_SYS_HUSH_PARSE_CACHE
+				if (parse_cache_running) {
+					char **argv = dup_argv(child->argc - i,
+							       &child->argv[i]);
+
+					rcode = (cmdtp->cmd)
+(cmdtp, flag,child->argc-i,argv);
+					free(argv);
+				} else
+#endif
 				rcode = (cmdtp->cmd)
 (cmdtp, flag,child->argc-i,&child->argv[i]);
 				if ( !cmdtp->repeatable )
@@ -1802,11 +1845,26 @@ static int run_pipe_real(struct pipe *pi)
 	return -1;
 }
 
+/*
+ * Give the "for" pipe its variable name back when the loop is left
+ * early, the parse tree may be run again.
+ */
+static void free_for_list(struct pipe *pi, char **list, char **save_list,
+			  char *save_name)
+{
+	while (*list)
+		free(*list++);
+	free(pi->progs->argv[0]);
+	free(save_list);
+	pi->progs->argv[0] = save_name;
+}
+
 static int run_list_real(struct pipe *pi)
 {
 	char *save_name = NULL;
 	char **list = NULL;
 	char **save_list = NULL;
+	struct pipe *for_pipe = NULL;
 	struct pipe *rpipe;
 	int flag_rep = 0;
 #ifndef __U_BOOT__
@@ -1846,6 +1904,9 @@ static int run_list_real(struct pipe *pi)
 				/* check Ctrl-C */
 				ctrlc();
 				if ((had_ctrlc())) {
+					if (list)
+						free_for_list(for_pipe, list,
+							save_list, save_name);
 					return 1;
 				}
 #endif
@@ -1875,6 +1936,7 @@ static int run_list_real(struct pipe *pi)
 				list = make_list_in(pi->next->progs->argv,
 					pi->progs->argv[0]);
 				save_list = list;
+				for_pipe = pi;
 				save_name = pi->progs->argv[0];
 				pi->progs->argv[0] = NULL;
 				flag_rep = 1;
@@ -1946,6 +2008,9 @@ static int run_list_real(struct pipe *pi)
 #else
 		if (rcode < -1) {
 			last_return_code = -rcode - 2;
+			if (list)
+				free_for_list(for_pipe, list, save_list,
+					      save_name);
 			return -2;	/* exit */
 		}
 		last_return_code=(rcode == 0) ? 0 : 1;
@@ -2176,6 +2241,50 @@ static int xglob(o_string *dest, int flags, glob_t *pglob)
 static char *get_dollar_var(char ch);
 #endif
 
+static unsigned int hush_hash(const char *s)
+{
+	unsigned int h = 0;
+
+	while (*s)
+		h = h * 31 + (unsigned char)*s++;
+	return h;
+}
+
+static struct variables **var_hash_slot(const char *name)
+{
+	return &var_hash[hush_hash(name) % VAR_HASH_SIZE];
+}
+
+static void var_hash_add(struct variables *var)
+{
+	struct variables **slot = var_hash_slot(var->name);
+
+	var->hash_next = *slot;
+	*slot = var;
+}
+
+static void var_hash_del(struct variables *var)
+{
+	struct variables **p;
+
+	for (p = var_hash_slot(var->name); *p; p = &(*p)->hash_next) {
+		if (*p == var) {
+			*p = var->hash_next;
+			break;
+		}
+	}
+}
+
+static struct variables *find_local_var(const char *name)
+{
+	struct variables *cur;
+
+	for (cur = *var_hash_slot(name); cur; cur = cur->hash_next)
+		if (strcmp(cur->name, name) == 0)
+			return cur;
+	return NULL;
+}
+
 /* This is used to get/check local shell variables */
 static char *get_local_var(const char *s)
 {
@@ -2189,10 +2298,8 @@ static char *get_local_var(const char *s)
 		return get_dollar_var(s[1]);
 #endif
 
-	for (cur = top_vars; cur; cur=cur->next)
-		if(strcmp(cur->name, s)==0)
-			return cur->value;
-	return NULL;
+	cur = find_local_var(s);
+	return cur ? cur->value : NULL;
 }
 
 /* This is used to set local shell variables
@@ -2231,10 +2338,7 @@ int set_local_var(const char *s, int flg_export)
 	}
 	*value++ = 0;
 
-	for(cur = top_vars; cur; cur = cur->next) {
-		if(strcmp(cur->name, name)==0)
-			break;
-	}
+	cur = find_local_var(name);
 
 	if(cur) {
 		if(strcmp(cur->value, value)==0) {
@@ -2271,6 +2375,7 @@ int set_local_var(const char *s, int flg_export)
 				cur->flg_read_only = 0;
 				while(bottom->next) bottom=bottom->next;
 				bottom->next = cur;
+				var_hash_add(cur);
 			}
 		}
 	}
@@ -2295,10 +2400,7 @@ void unset_local_var(const char *name)
 	struct variables *cur;
 
 	if (name) {
-		for (cur = top_vars; cur; cur=cur->next) {
-			if(strcmp(cur->name, name)==0)
-				break;
-		}
+		cur = find_local_var(name);
 		if(cur!=0) {
 			struct variables *next = top_vars;
 			if(cur->flg_read_only) {
@@ -2309,6 +2411,7 @@ void unset_local_var(const char *name)
 				if(cur->flg_export)
 					unsetenv(cur->name);
 #endif
+				var_hash_del(cur);
 				free(cur->name);
 				free(cur->value);
 				while (next->next != cur)
@@ -3153,42 +3256,71 @@ void update_ifs_map(void)
 	mapset(ifs, 2);            /* also flow through if quoted */
 }
 
-/* most recursion does not come through here, the exeception is
- * from builtin_source() */
-int parse_stream_outer(struct in_str *inp, int flag)
+/*
+ * Parse one line of input. Returns parse_stream()'s code and the pipe
+ * list in *list, NULL if there is nothing to run.
+ */
+static int parse_stream_list(struct in_str *inp, int flag, struct pipe **list)
 {
-
 	struct p_context ctx;
 	o_string temp=NULL_O_STRING;
 	int rcode;
+
+	ctx.type = flag;
+	initialize_context(&ctx);
+	update_ifs_map();
+	if (!(flag & FLAG_PARSE_SEMICOLON) || (flag & FLAG_REPARSING)) mapset((uchar *)";$&|", 0);
+	inp->promptmode=1;
+	rcode = parse_stream(&temp, &ctx, inp, '\n');
 #ifdef __U_BOOT__
-	int code = 0;
+	if (rcode == 1) flag_repeat = 0;
 #endif
-	do {
-		ctx.type = flag;
-		initialize_context(&ctx);
-		update_ifs_map();
-		if (!(flag & FLAG_PARSE_SEMICOLON) || (flag & FLAG_REPARSING)) mapset((uchar *)";$&|", 0);
-		inp->promptmode=1;
-		rcode = parse_stream(&temp, &ctx, inp, '\n');
+	if (rcode != 1 && ctx.old_flag != 0) {
+		syntax();
 #ifdef __U_BOOT__
-		if (rcode == 1) flag_repeat = 0;
+		flag_repeat = 0;
 #endif
-		if (rcode != 1 && ctx.old_flag != 0) {
-			syntax();
+	}
+	if (rcode != 1 && ctx.old_flag == 0) {
+		done_word(&temp, &ctx);
+		done_pipe(&ctx,PIPE_SEQ);
+		*list = ctx.list_head;
+	} else {
+		if (ctx.old_flag != 0) {
+			free(ctx.stack);
+			b_reset(&temp);
+		}
 #ifdef __U_BOOT__
-			flag_repeat = 0;
+		if (inp->__promptme == 0) printf("<INTERRUPT>\n");
+		inp->__promptme = 1;
 #endif
-		}
-		if (rcode != 1 && ctx.old_flag == 0) {
-			done_word(&temp, &ctx);
-			done_pipe(&ctx,PIPE_SEQ);
+		temp.nonnull = 0;
+		temp.quote = 0;
+		inp->p = NULL;
+		free_pipe_list(ctx.list_head,0);
+		*list = NULL;
+	}
+	b_free(&temp);
+	return rcode;
+}
+
+/* most recursion does not come through here, the exeception is
+ * from builtin_source() */
+int parse_stream_outer(struct in_str *inp, int flag)
+{
+	struct pipe *list;
+	int rcode;
+#ifdef __U_BOOT__
+	int code = 0;
+#endif
+	do {
+		rcode = parse_stream_list(inp, flag, &list);
+		if (list) {
 #ifndef __U_BOOT__
-			run_list(ctx.list_head);
+			run_list(list);
 #else
-			code = run_list(ctx.list_head);
+			code = run_list(list);
 			if (code == -2) {	/* exit */
-				b_free(&temp);
 				code = 0;
 				/* XXX hackish way to not allow exit from main loop */
 				if (inp->peek == file_peek) {
@@ -3200,21 +3332,7 @@ int parse_stream_outer(struct in_str *inp, int flag)
 			if (code == -1)
 			    flag_repeat = 0;
 #endif
-		} else {
-			if (ctx.old_flag != 0) {
-				free(ctx.stack);
-				b_reset(&temp);
-			}
-#ifdef __U_BOOT__
-			if (inp->__promptme == 0) printf("<INTERRUPT>\n");
-			inp->__promptme = 1;
-#endif
-			temp.nonnull = 0;
-			temp.quote = 0;
-			inp->p = NULL;
-			free_pipe_list(ctx.list_head,0);
 		}
-		b_free(&temp);
 	} while (rcode != -1 && !(flag & FLAG_EXIT_FROM_LOOP));   /* loop on syntax errors, return on EOF */
 #ifndef __U_BOOT__
 	return 0;
@@ -3223,6 +3341,82 @@ int parse_stream_outer(struct in_str *inp, int flag)
 #endif /* __U_BOOT__ */
 }
 
+#ifdef CONFIG_SYS_HUSH_PARSE_CACHE
+/*
+ * Parse trees of the scripts run by "run", bootcmd and bootd, keyed by
+ * their text. Setting a variable to a new script gives a new key, so an
+ * entry never goes stale; the least recently used one is replaced.
+ */
+static struct parse_cache {
+	char		*text;
+	unsigned int	hash;
+	struct pipe	*list;
+	int		busy;		/* being run, maybe recursively */
+	ulong		used;
+} parse_cache[CONFIG_SYS_HUSH_PARSE_CACHE];
+static ulong parse_cache_clock;
+
+/*
+ * parse_string_outer() for FLAG_EXIT_FROM_LOOP, which only ever runs the
+ * first line. Returns -1 if the cache can't be used.
+ */
+static int parse_string_cached(const char *s, int flag)
+{
+	struct parse_cache *pc, *victim = NULL;
+	unsigned int hash = hush_hash(s);
+	struct in_str input;
+	struct pipe *list;
+	char *line;
+	int i, code;
+
+	for (i = 0; i < CONFIG_SYS_HUSH_PARSE_CACHE; i++) {
+		pc = &parse_cache[i];
+		if (pc->list && pc->hash == hash && strcmp(pc->text, s) == 0) {
+			/* "for" loops patch the tree while it runs */
+			if (pc->busy)
+				return -1;
+			goto run;
+		}
+		if (!pc->busy && (!victim || pc->used < victim->used))
+			victim = pc;
+	}
+	if (!victim)
+		return -1;
+
+	/* as in parse_string_outer(), the parser wants a trailing newline */
+	line = xmalloc(strlen(s) + 2);
+	strcpy(line, s);
+	strcat(line, "\n");
+	setup_string_in_str(&input, line);
+	parse_stream_list(&input, flag, &list);
+	free(line);
+	if (!list)
+		return 0;
+
+	pc = victim;
+	if (pc->list) {
+		free_pipe_list(pc->list, 0);
+		free(pc->text);
+	}
+	pc->text = xmalloc(strlen(s) + 1);
+	strcpy(pc->text, s);
+	pc->hash = hash;
+	pc->list = list;
+run:
+	pc->used = ++parse_cache_clock;
+	pc->busy++;
+	parse_cache_running++;
+	code = run_list_real(pc->list);
+	parse_cache_running--;
+	pc->busy--;
+	if (code == -2)		/* exit */
+		code = 0;
+	if (code == -1)
+		flag_repeat = 0;
+	return (code != 0) ? 1 : 0;
+}
+#endif
+
 #ifndef __U_BOOT__
 static int parse_string_outer(const char *s, int flag)
 #else
@@ -3235,6 +3429,13 @@ int parse_string_outer(char *s, int flag)
 	int rcode;
 	if ( !s || !*s)
 		return 1;
+#ifdef CONFIG_SYS_HUSH_PARSE_CACHE
+	if ((flag & FLAG_EXIT_FROM_LOOP) && !(flag & FLAG_REPARSING)) {
+		rcode = parse_string_cached(s, flag);
+		if (rcode >= 0)
+			return rcode;
+	}
+#endif
 	if (!(p = strchr(s, '\n')) || *++p) {
 		p = xmalloc(strlen(s) + 2);
 		strcpy(p, s);
@@ -3292,6 +3493,7 @@ int u_boot_hush_start(void)
 		top_vars->next = 0;
 		top_vars->flg_export = 0;
 		top_vars->flg_read_only = 1;
+		var_hash_add(top_vars);
 #ifndef CONFIG_RELOC_FIXUP_WORKS
 		u_boot_hush_reloc();
 #endif
@@ -3372,6 +3574,8 @@ int hush_main(int argc, char **argv)
 	last_bg_pid = 0;
 	job_list = NULL;
 	last_jobid = 0;
+	if (!find_local_var(shell_ver.name))
+		var_hash_add(&shell_ver);
 
 	/* Initialize some more globals to non-zero values */
 	set_cwd();
@@ -39,6 +39,7 @@
 #endif
 
 #include <post.h>
+#include <bootstage.h>
 
 #if defined(CONFIG_SILENT_CONSOLE) || defined(CONFIG_POST) || defined(CONFIG_CMDLINE_EDITING)
 DECLARE_GLOBAL_DATA_PTR;
@@ -401,6 +402,7 @@ void main_loop (void)
 # ifdef CONFIG_AUTOBOOT_KEYED
 		int prev = disable_ctrlc(1);	/* disable Control C checking */
 # endif
+		bootstage_mark("bootdelay");
 
 # ifndef CONFIG_SYS_HUSH_PARSER
 		run_command (s, 0);
@@ -0,0 +1,256 @@
+/*
+ * Sparse flash image writer
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <watchdog.h>
+#include <asm/errno.h>
+#include <sparse_format.h>
+
+/* Largest buffer used to expand FILL chunks */
+#define SPARSE_FILL_BUF_SIZE	(64 << 10)
+
+int is_sparse_image(const void *image)
+{
+	const struct sparse_header *hdr = image;
+
+	return le32_to_cpu(hdr->magic) == SPARSE_HEADER_MAGIC;
+}
+
+/*
+ * Walk the chunk list once without writing anything: check every chunk
+ * header against the image length and return the size of the sparse
+ * image, or 0 if it is bad. Sizes are compared by division, so that a
+ * chunk header can't overflow them.
+ */
+static ulong sparse_check_chunks(const struct sparse_header *hdr, ulong len)
+{
+	ulong hdr_sz = le16_to_cpu(hdr->chunk_hdr_sz);
+	ulong blk_sz = le32_to_cpu(hdr->blk_sz);
+	ulong chunks = le32_to_cpu(hdr->total_chunks);
+	ulong total_blks = le32_to_cpu(hdr->total_blks);
+	ulong off = le16_to_cpu(hdr->file_hdr_sz);
+	ulong blks = 0;
+	ulong i;
+
+	if (off > len) {
+		puts("Sparse image: header truncated\n");
+		return 0;
+	}
+
+	for (i = 0; i < chunks; i++) {
+		const struct sparse_chunk *c;
+		ulong chunk_sz, total_sz, data_sz;
+
+		if (len - off < hdr_sz) {
+			printf("Sparse chunk %lu: image truncated at 0x%lx\n",
+			       i, off);
+			return 0;
+		}
+		c = (const struct sparse_chunk *)((const uchar *)hdr + off);
+		chunk_sz = le32_to_cpu(c->chunk_sz);
+		total_sz = le32_to_cpu(c->total_sz);
+
+		if (chunk_sz > total_blks - blks) {
+			printf("Sparse chunk %lu: %lu blocks past the end of "
+			       "the image\n", i, chunk_sz);
+			return 0;
+		}
+
+		switch (le16_to_cpu(c->chunk_type)) {
+		case SPARSE_CHUNK_RAW:
+			if (chunk_sz > (len - off - hdr_sz) / blk_sz) {
+				printf("Sparse chunk %lu: image truncated at "
+				       "0x%lx\n", i, off);
+				return 0;
+			}
+			data_sz = chunk_sz * blk_sz;
+			break;
+		case SPARSE_CHUNK_FILL:
+			data_sz = sizeof(uint32_t);
+			break;
+		case SPARSE_CHUNK_DONT_CARE:
+			data_sz = 0;
+			break;
+		default:
+			printf("Sparse chunk %lu: unknown type 0x%04x\n",
+			       i, le16_to_cpu(c->chunk_type));
+			return 0;
+		}
+
+		if (total_sz != hdr_sz + data_sz) {
+			printf("Sparse chunk %lu: bad size %lu\n", i, total_sz);
+			return 0;
+		}
+		if (total_sz > len - off) {
+			printf("Sparse chunk %lu: image truncated at 0x%lx\n",
+			       i, off);
+			return 0;
+		}
+
+		blks += chunk_sz;
+		off += total_sz;
+	}
+
+	if (blks != total_blks) {
+		printf("Sparse image: chunks cover %lu of %lu blocks\n",
+		       blks, total_blks);
+		return 0;
+	}
+
+	return off;
+}
+
+/*
+ * Expand a FILL chunk into a buffer of whole blocks and write that
+ * repeatedly.
+ */
+static int sparse_fill(struct sparse_storage *info, ulong blk_sz,
+		       uint32_t val, ulong len)
+{
+	ulong buf_sz = SPARSE_FILL_BUF_SIZE - SPARSE_FILL_BUF_SIZE % blk_sz;
+	uint32_t *buf;
+	ulong i;
+	int ret = 0;
+
+	if (buf_sz == 0)
+		buf_sz = blk_sz;
+	if (buf_sz > len)
+		buf_sz = len;
+
+	buf = malloc(buf_sz);
+	if (!buf) {
+		puts("Sparse image: out of memory\n");
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < buf_sz / sizeof(uint32_t); i++)
+		buf[i] = val;
+
+	while (len && !ret) {
+		ulong n = len < buf_sz ? len : buf_sz;
+
+		ret = info->write(info, buf, n);
+		len -= n;
+	}
+
+	free(buf);
+	return ret;
+}
+
+/**
+ * flash_sparse - write a sparse image
+ * @info:	storage backend
+ * @image:	sparse image in memory
+ * @len:	bytes of the image in memory
+ *
+ * The image is checked completely (chunk headers against @len, CRC)
+ * before the backend sees any data. Returns 0 on success.
+ */
+int flash_sparse(struct sparse_storage *info, const void *image, ulong len)
+{
+	const struct sparse_header *hdr = image;
+	const uchar *p;
+	ulong blk_sz, size, chunks, i;
+	ulong written = 0, skipped = 0;
+	uint32_t crc;
+	int ret = 0;
+
+	if (len < sizeof(struct sparse_header) || !is_sparse_image(image)) {
+		puts("Not a sparse image\n");
+		return -EINVAL;
+	}
+
+	if (le16_to_cpu(hdr->major_version) != SPARSE_MAJOR_VERSION ||
+	    le16_to_cpu(hdr->file_hdr_sz) < sizeof(struct sparse_header) ||
+	    le16_to_cpu(hdr->chunk_hdr_sz) < sizeof(struct sparse_chunk)) {
+		printf("Sparse image: unsupported version %u.%u\n",
+		       le16_to_cpu(hdr->major_version),
+		       le16_to_cpu(hdr->minor_version));
+		return -EINVAL;
+	}
+
+	blk_sz = le32_to_cpu(hdr->blk_sz);
+	if (!blk_sz || blk_sz % info->align) {
+		printf("Sparse image: block size %lu is not a multiple "
+		       "of %lu\n", blk_sz, info->align);
+		return -EINVAL;
+	}
+
+	if ((u64)le32_to_cpu(hdr->total_blks) * blk_sz > info->size) {
+		printf("Sparse image: %u blocks of %lu bytes do not fit "
+		       "into 0x%lx bytes\n", le32_to_cpu(hdr->total_blks),
+		       blk_sz, info->size);
+		return -EINVAL;
+	}
+
+	size = sparse_check_chunks(hdr, len);
+	if (!size)
+		return -EINVAL;
+
+	p = (const uchar *)hdr + le16_to_cpu(hdr->file_hdr_sz);
+	crc = crc32(0, p, size - le16_to_cpu(hdr->file_hdr_sz));
+	if (crc != le32_to_cpu(hdr->image_checksum)) {
+		printf("Sparse image: bad checksum %08x, expected %08x\n",
+		       crc, le32_to_cpu(hdr->image_checksum));
+		return -EINVAL;
+	}
+
+	chunks = le32_to_cpu(hdr->total_chunks);
+	for (i = 0; i < chunks && !ret; i++) {
+		const struct sparse_chunk *c = (const struct sparse_chunk *)p;
+		const uchar *data = p + le16_to_cpu(hdr->chunk_hdr_sz);
+		ulong len = le32_to_cpu(c->chunk_sz) * blk_sz;
+		uint32_t val;
+
+		WATCHDOG_RESET();
+
+		switch (le16_to_cpu(c->chunk_type)) {
+		case SPARSE_CHUNK_RAW:
+			ret = info->write(info, data, len);
+			written += len;
+			break;
+		case SPARSE_CHUNK_FILL:
+			memcpy(&val, data, sizeof(val));
+			val = le32_to_cpu(val);
+			if (info->fill_erased && val == 0xffffffff) {
+				ret = info->skip(info, len);
+				skipped += len;
+			} else {
+				ret = sparse_fill(info, blk_sz, val, len);
+				written += len;
+			}
+			break;
+		case SPARSE_CHUNK_DONT_CARE:
+			ret = info->skip(info, len);
+			skipped += len;
+			break;
+		}
+
+		p += le32_to_cpu(c->total_sz);
+	}
+
+	printf("Sparse image: %lu chunks, %lu bytes written, %lu bytes "
+	       "skipped%s\n", i, written, skipped, ret ? " - ERROR" : "");
+
+	return ret;
+}
@@ -157,6 +157,17 @@ struct us_data {
 
 static struct us_data usb_stor[USB_MAX_STOR_DEV];
 
+#define USB_READY	(1 << 0)	/* unit answered TEST UNIT READY */
+
+/*
+ * Blocks per READ(10)/WRITE(10). Every command costs a CBW and a CSW
+ * transfer, so this is worth raising as far as the host controller
+ * driver can queue in one bulk transfer.
+ */
+#ifndef CONFIG_SYS_USB_MAX_XFER_BLK
+#define CONFIG_SYS_USB_MAX_XFER_BLK	20
+#endif
+
 
 #define USB_STOR_TRANSPORT_GOOD	   0
 #define USB_STOR_TRANSPORT_FAILED -1
@@ -663,7 +674,9 @@ int usb_stor_BBB_transport(ccb *srb, struct us_data *us)
 		usb_stor_BBB_reset(us);
 		return USB_STOR_TRANSPORT_FAILED;
 	}
-	wait_ms(5);
+	/* only give a unit that is still spinning up time to settle */
+	if (!(us->flags & USB_READY))
+		wait_ms(5);
 	pipein = usb_rcvbulkpipe(us->pusb_dev, us->ep_in);
 	pipeout = usb_sndbulkpipe(us->pusb_dev, us->ep_out);
 	/* DATA phase + error handling */
@@ -925,8 +938,10 @@ static int usb_test_unit_ready(ccb *srb, struct us_data *ss)
 		srb->cmd[0] = SCSI_TST_U_RDY;
 		srb->datalen = 0;
 		srb->cmdlen = 12;
-		if (ss->transport(srb, ss) == USB_STOR_TRANSPORT_GOOD)
+		if (ss->transport(srb, ss) == USB_STOR_TRANSPORT_GOOD) {
+			ss->flags |= USB_READY;
 			return 0;
+		}
 		usb_request_sense(srb, ss);
 		wait_ms(100);
 	} while (retries--);
@@ -1007,7 +1022,7 @@ static void usb_bin_fixup(struct usb_device_descriptor descriptor,
 }
 #endif /* CONFIG_USB_BIN_FIXUP */
 
-#define USB_MAX_READ_BLK 20
+#define USB_MAX_READ_BLK CONFIG_SYS_USB_MAX_XFER_BLK
 
 unsigned long usb_stor_read(int device, unsigned long blknr,
 			    unsigned long blkcnt, void *buffer)
@@ -1084,7 +1099,7 @@ retry_it:
 	return blkcnt;
 }
 
-#define USB_MAX_WRITE_BLK 20
+#define USB_MAX_WRITE_BLK CONFIG_SYS_USB_MAX_XFER_BLK
 
 unsigned long usb_stor_write(int device, unsigned long blknr,
 				unsigned long blkcnt, const void *buffer)
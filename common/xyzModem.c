@@ -87,6 +87,7 @@ static struct
   int len, mode, total_retries;
   int total_SOH, total_STX, total_CAN;
   bool crc_mode, at_eof, tx_ack;
+  bool streaming;		/* YMODEM-G: no ACK/NAK for data blocks */
 #ifdef USE_YMODEM_LENGTH
   unsigned long file_length, read_length;
 #endif
@@ -97,6 +98,9 @@ static struct
 #define xyzModem_MAX_RETRIES_WITH_CRC    10
 #define xyzModem_CAN_COUNT                3	/* Wait for 3 CAN before quitting */
 
+/* Character asking the sender to (re)start: 'G' streams, 'C' wants CRC */
+#define xyzModem_START (xyz.streaming ? 'G' : (xyz.crc_mode ? 'C' : NAK))
+
 
 #ifndef REDBOOT			/*SB */
 typedef int cyg_int32;
@@ -551,7 +555,8 @@ xyzModem_stream_open (connection_info_t * info, int *err)
   xyz.crc_mode = true;
   xyz.at_eof = false;
   xyz.tx_ack = false;
-  xyz.mode = info->mode;
+  xyz.streaming = (info->mode == xyzModem_ymodem_g);
+  xyz.mode = xyz.streaming ? xyzModem_ymodem : info->mode;
   xyz.total_retries = 0;
   xyz.total_SOH = 0;
   xyz.total_STX = 0;
@@ -561,7 +566,7 @@ xyzModem_stream_open (connection_info_t * info, int *err)
   xyz.file_length = 0;
 #endif
 
-  CYGACC_COMM_IF_PUTC (*xyz.__chan, (xyz.crc_mode ? 'C' : NAK));
+  CYGACC_COMM_IF_PUTC (*xyz.__chan, xyzModem_START);
 
   if (xyz.mode == xyzModem_xmodem)
     {
@@ -586,6 +591,13 @@ xyzModem_stream_open (connection_info_t * info, int *err)
 #endif
 	      /* The rest of the file name data block quietly discarded */
 	      xyz.tx_ack = true;
+	      if (xyz.streaming)
+		{
+		  /* The sender waits for a 'G' before streaming the data */
+		  CYGACC_COMM_IF_PUTC (*xyz.__chan, ACK);
+		  CYGACC_COMM_IF_PUTC (*xyz.__chan, 'G');
+		  xyz.tx_ack = false;
+		}
 	    }
 	  xyz.next_blk = 1;
 	  xyz.len = 0;
@@ -593,10 +605,10 @@ xyzModem_stream_open (connection_info_t * info, int *err)
 	}
       else if (stat == xyzModem_timeout)
 	{
-	  if (--crc_retries <= 0)
+	  if (--crc_retries <= 0 && !xyz.streaming)
 	    xyz.crc_mode = false;
 	  CYGACC_CALL_IF_DELAY_US (5 * 100000);	/* Extra delay for startup */
-	  CYGACC_COMM_IF_PUTC (*xyz.__chan, (xyz.crc_mode ? 'C' : NAK));
+	  CYGACC_COMM_IF_PUTC (*xyz.__chan, xyzModem_START);
 	  xyz.total_retries++;
 	  ZM_DEBUG (zm_dprintf ("NAK (%d)\n", __LINE__));
 	}
@@ -631,7 +643,7 @@ xyzModem_stream_read (char *buf, int size, int *err)
 		{
 		  if (xyz.blk == xyz.next_blk)
 		    {
-		      xyz.tx_ack = true;
+		      xyz.tx_ack = !xyz.streaming;
 		      ZM_DEBUG (zm_dprintf
 				("ACK block %d (%d)\n", xyz.blk, __LINE__));
 		      xyz.next_blk = (xyz.next_blk + 1) & 0xFF;
@@ -678,7 +690,8 @@ xyzModem_stream_read (char *buf, int size, int *err)
 		  else if (xyz.blk == ((xyz.next_blk - 1) & 0xFF))
 		    {
 		      /* Just re-ACK this so sender will get on with it */
-		      CYGACC_COMM_IF_PUTC (*xyz.__chan, ACK);
+		      if (!xyz.streaming)
+			CYGACC_COMM_IF_PUTC (*xyz.__chan, ACK);
 		      continue;	/* Need new header */
 		    }
 		  else
@@ -697,7 +710,7 @@ xyzModem_stream_read (char *buf, int size, int *err)
 		  if (xyz.mode == xyzModem_ymodem)
 		    {
 		      CYGACC_COMM_IF_PUTC (*xyz.__chan,
-					   (xyz.crc_mode ? 'C' : NAK));
+					   xyzModem_START);
 		      xyz.total_retries++;
 		      ZM_DEBUG (zm_dprintf ("Reading Final Header\n"));
 		      stat = xyzModem_get_hdr ();
@@ -707,7 +720,12 @@ xyzModem_stream_read (char *buf, int size, int *err)
 		  xyz.at_eof = true;
 		  break;
 		}
-	      CYGACC_COMM_IF_PUTC (*xyz.__chan, (xyz.crc_mode ? 'C' : NAK));
+	      if (xyz.streaming)
+		{
+		  /* YMODEM-G cannot resend a block, the caller must abort */
+		  break;
+		}
+	      CYGACC_COMM_IF_PUTC (*xyz.__chan, xyzModem_START);
 	      xyz.total_retries++;
 	      ZM_DEBUG (zm_dprintf ("NAK (%d)\n", __LINE__));
 	    }
@@ -740,7 +758,8 @@ xyzModem_stream_close (int *err)
 {
   diag_printf
     ("xyzModem - %s mode, %d(SOH)/%d(STX)/%d(CAN) packets, %d retries\n",
-     xyz.crc_mode ? "CRC" : "Cksum", xyz.total_SOH, xyz.total_STX,
+     xyz.streaming ? "Streaming" : xyz.crc_mode ? "CRC" : "Cksum",
+     xyz.total_SOH, xyz.total_STX,
      xyz.total_CAN, xyz.total_retries);
   ZM_DEBUG (zm_flush ());
 }
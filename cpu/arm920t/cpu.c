@@ -32,6 +32,9 @@
 #include <common.h>
 #include <command.h>
 #include <asm/system.h>
+#ifdef CONFIG_SYS_S3C24X0_SERIAL_RXDMA
+#include <asm/arch/s3c24x0_cpu.h>
+#endif
 
 #ifdef CONFIG_AT91_LEGACY
 #warning Your board is using legacy AT91RM9200 SoC access. Please update!
@@ -48,6 +51,14 @@ int cleanup_before_linux (void)
 	 * we turn off caches etc ...
 	 */
 
+	/* the kernel resets the UART, get our last words out first */
+	serial_flush();
+
+#ifdef CONFIG_SYS_S3C24X0_SERIAL_RXDMA
+	/* the Rx ring DMA would keep writing into the kernel's memory */
+	s3c24x0_serial_rxdma_stop();
+#endif
+
 	disable_interrupts ();
 
 	/* turn off I/D-cache */
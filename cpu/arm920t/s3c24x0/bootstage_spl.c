@@ -0,0 +1,146 @@
+/*
+ * Boot stage time stamps for the S3C24x0 NAND SPL
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * The SPL starts PWM timer 4 free running with the same prescaler
+ * (16) and divider (1/2) timer_init() uses later, and keeps the tick
+ * count in a small block of SDRAM.  This file is linked into both the
+ * SPL (marking) and U-Boot (importing the stash).
+ */
+
+#include <common.h>
+#include <bootstage.h>
+#include <div64.h>
+#include <asm/io.h>
+#include <asm/arch/s3c24x0_cpu.h>
+
+#ifdef CONFIG_BOOTSTAGE_SPL
+
+#define SPL_STASH	((struct bootstage_spl_stash *)CONFIG_BOOTSTAGE_SPL_STASH)
+#define SPL_TIMER_LOAD	0xffff
+
+static inline ulong spl_read_timer(void)
+{
+	struct s3c24x0_timers *timers = s3c24x0_get_base_timers();
+
+	return readl(&timers->TCNTO4) & 0xffff;
+}
+
+/*
+ * Must be called at least once per timer period (0x10000 ticks, more
+ * than 40 ms even at 50 MHz PCLK) to catch every reload.
+ */
+void bootstage_spl_poll(void)
+{
+	struct bootstage_spl_stash *stash = SPL_STASH;
+	ulong now = spl_read_timer();
+
+	if (stash->last >= now)
+		stash->ticks += stash->last - now;
+	else
+		/* the counter reloaded: 0x10000 ticks per period */
+		stash->ticks += stash->last + SPL_TIMER_LOAD + 1 - now;
+	stash->last = now;
+}
+
+#ifdef CONFIG_NAND_SPL
+void bootstage_spl_mark(int id)
+{
+	struct bootstage_spl_stash *stash = SPL_STASH;
+
+	bootstage_spl_poll();
+	stash->time[id] = stash->ticks;
+	stash->valid |= 1 << id;
+}
+
+void bootstage_spl_start(void)
+{
+	struct s3c24x0_timers *timers = s3c24x0_get_base_timers();
+	struct bootstage_spl_stash *stash = SPL_STASH;
+	ulong tmr;
+
+	/* prescaler for Timer 4 is 16, as in timer_init() */
+	writel(0x0f00, &timers->TCFG0);
+	writel(SPL_TIMER_LOAD, &timers->TCNTB4);
+	/* auto load, manual update of Timer 4 */
+	tmr = (readl(&timers->TCON) & ~0x0700000) | 0x0600000;
+	writel(tmr, &timers->TCON);
+	/* auto load, start Timer 4 */
+	tmr = (tmr & ~0x0700000) | 0x0500000;
+	writel(tmr, &timers->TCON);
+
+	stash->magic = BOOTSTAGE_SPL_MAGIC;
+	stash->valid = 0;
+	stash->ticks = 0;
+	stash->last = SPL_TIMER_LOAD;
+
+	bootstage_spl_mark(BOOTSTAGE_SPL_START);
+}
+#else
+static const char * const spl_names[BOOTSTAGE_SPL_COUNT] = {
+	[BOOTSTAGE_SPL_START]		= "spl_start",
+	[BOOTSTAGE_SPL_UBOOT_LOADED]	= "spl_uboot_loaded",
+	[BOOTSTAGE_SPL_ENV_LOADED]	= "spl_env_loaded",
+	[BOOTSTAGE_SPL_JUMP]		= "spl_jump",
+};
+
+static ulong spl_ticks_to_us(ulong ticks, ulong hz)
+{
+	unsigned long long us = ticks * 1000000ULL;
+
+	do_div(us, hz);
+	return us;
+}
+
+/*
+ * Turn the SPL stash into boot stage records.  Has to run before the
+ * PLL is reprogrammed (first thing in board_init()), since the tick
+ * rate is derived from the PCLK the SPL ran with.  The time between
+ * here and timer_init() is not accounted for.
+ */
+void bootstage_spl_import(void)
+{
+	struct bootstage_spl_stash *stash = SPL_STASH;
+	ulong hz, now;
+	int i;
+
+	if (stash->magic != BOOTSTAGE_SPL_MAGIC)
+		return;
+	/* do not pick up a stale stash when started without the SPL */
+	stash->magic = 0;
+
+	bootstage_spl_poll();
+	hz = get_PCLK() / (2 * 16);
+
+	for (i = 0; i < BOOTSTAGE_SPL_COUNT; i++) {
+		if (stash->valid & (1 << i))
+			bootstage_add_record(spl_names[i], 0,
+				spl_ticks_to_us(stash->time[i], hz));
+	}
+
+	now = spl_ticks_to_us(stash->ticks, hz);
+	bootstage_add_record("board_init", 0, now);
+	bootstage_set_base(now);
+}
+#endif /* CONFIG_NAND_SPL */
+
+#endif /* CONFIG_BOOTSTAGE_SPL */
@@ -34,8 +34,21 @@
 
 #include <asm/io.h>
 #include <asm/arch/s3c24x0_cpu.h>
+#include <div64.h>
+
+/*
+ * Timer 4 runs free with the largest reload value, clocked at
+ * PCLK / (16 * 2): 1.5625 MHz (0.64 us per tick) at 50 MHz PCLK. It
+ * wraps every 65536 ticks (42 ms), more often than a CRC or an image
+ * decompression calls the timer. Timer 1, which has no output on the
+ * board, runs at PCLK / (256 * 16), exactly 1/128 of that rate, and
+ * wraps only every 5.4 s. get_ticks() takes the ticks from timer 4 and
+ * the number of timer 4 wraps from timer 1, so it has to be called
+ * once per 5 s rather than once per 42 ms.
+ */
+#define TIMER_LOAD_VAL	0xffff
+#define TIMER_RATIO	128	/* timer 4 ticks per timer 1 tick */
 
-int timer_load_val = 0;
 static ulong timer_clk;
 
 /* macro to read the 16 bit timer */
@@ -46,8 +59,51 @@ static inline ulong READ_TIMER(void)
 	return readl(&timers->TCNTO4) & 0xffff;
 }
 
-static ulong timestamp;
+/* the same for the slow timer 1 */
+static inline ulong READ_TIMER1(void)
+{
+	struct s3c24x0_timers *timers = s3c24x0_get_base_timers();
+
+	return readl(&timers->ch[1].TCNTO) & 0xffff;
+}
+
+static unsigned long long timestamp;
 static ulong lastdec;
+static ulong lastdec1;
+/* get_ticks() value at which get_timer() counted 0 ms */
+static unsigned long long timer_base;
+
+static inline unsigned long long ms_to_ticks(ulong ms)
+{
+	unsigned long long ticks = (unsigned long long)ms * timer_clk;
+
+	do_div(ticks, CONFIG_SYS_HZ);
+	return ticks;
+}
+
+static inline ulong ticks_to_ms(unsigned long long ticks)
+{
+	if (!timer_clk)
+		return 0;
+
+	ticks *= CONFIG_SYS_HZ;
+	do_div(ticks, timer_clk);
+	return ticks;
+}
+
+/* busy wait for at least the given number of ticks */
+static void wait_ticks_masked(unsigned long long tmo)
+{
+	unsigned long long start;
+
+	if (!timer_clk)
+		return;
+
+	/* the first tick may be almost over already, wait for one more */
+	start = get_ticks();
+	while (get_ticks() - start <= tmo)
+		/*NOP*/;
+}
 
 int timer_init(void)
 {
@@ -55,27 +111,26 @@ int timer_init(void)
 	ulong tmr;
 
 	/* use PWM Timer 4 because it has no output */
-	/* prescaler for Timer 4 is 16 */
-	writel(0x0f00, &timers->TCFG0);
-	if (timer_load_val == 0) {
-		/*
-		 * for 10 ms clock period @ PCLK with 4 bit divider = 1/2
-		 * (default) and prescaler = 16. Should be 10390
-		 * @33.25MHz and 15625 @ 50 MHz
-		 */
-		timer_load_val = get_PCLK() / (2 * 16 * 100);
-		timer_clk = get_PCLK() / (2 * 16);
-	}
-	/* load value for 10 ms timeout */
-	lastdec = timer_load_val;
-	writel(timer_load_val, &timers->TCNTB4);
-	/* auto load, manual update of Timer 4 */
-	tmr = (readl(&timers->TCON) & ~0x0700000) | 0x0600000;
+	/* prescaler for Timer 4 is 16, for Timer 1 256 */
+	writel(0x0fff, &timers->TCFG0);
+	/* 4 bit divider = 1/2 (default) for Timer 4, 1/16 for Timer 1 */
+	writel((readl(&timers->TCFG1) & ~0x0f00f0) | 0x000030,
+	       &timers->TCFG1);
+	timer_clk = get_PCLK() / (2 * 16);
+
+	lastdec = TIMER_LOAD_VAL;
+	lastdec1 = TIMER_LOAD_VAL;
+	writel(TIMER_LOAD_VAL, &timers->TCNTB4);
+	writel(TIMER_LOAD_VAL, &timers->ch[1].TCNTB);
+	writel(0, &timers->ch[1].TCMPB);
+	/* auto load, manual update of Timer 4 and Timer 1 */
+	tmr = (readl(&timers->TCON) & ~0x0700f00) | 0x0600a00;
 	writel(tmr, &timers->TCON);
-	/* auto load, start Timer 4 */
-	tmr = (tmr & ~0x0700000) | 0x0500000;
+	/* auto load, start Timer 4 and Timer 1 together */
+	tmr = (tmr & ~0x0700f00) | 0x0500900;
 	writel(tmr, &timers->TCON);
 	timestamp = 0;
+	timer_base = 0;
 
 	return (0);
 }
@@ -96,99 +151,117 @@ ulong get_timer(ulong base)
 
 void set_timer(ulong t)
 {
-	timestamp = t;
+	timer_base = get_ticks() - ms_to_ticks(t);
 }
 
 void __udelay (unsigned long usec)
 {
-	ulong tmo;
-	ulong start = get_ticks();
+	wait_ticks_masked(usec2ticks(usec));
+}
 
-	tmo = usec / 1000;
-	tmo *= (timer_load_val * 100);
-	tmo /= 1000;
+/*
+ * Sub-microsecond delays, rounded up to whole timer ticks.
+ */
+void ndelay(unsigned long nsec)
+{
+	unsigned long long tmo = (unsigned long long)nsec * timer_clk;
 
-	while ((ulong) (get_ticks() - start) < tmo)
-		/*NOP*/;
+	tmo += 1000000000 - 1;
+	do_div(tmo, 1000000000);
+	wait_ticks_masked(tmo);
 }
 
 void reset_timer_masked(void)
 {
-	/* reset time */
-	lastdec = READ_TIMER();
-	timestamp = 0;
+	/* reset time, get_ticks() keeps counting */
+	timer_base = get_ticks();
 }
 
 ulong get_timer_masked(void)
 {
-	ulong tmr = get_ticks();
-
-	return tmr / (timer_clk / CONFIG_SYS_HZ);
+	return ticks_to_ms(get_ticks() - timer_base);
 }
 
 void udelay_masked(unsigned long usec)
 {
-	ulong tmo;
-	ulong endtime;
-	signed long diff;
-
-	if (usec >= 1000) {
-		tmo = usec / 1000;
-		tmo *= (timer_load_val * 100);
-		tmo /= 1000;
-	} else {
-		tmo = usec * (timer_load_val * 100);
-		tmo /= (1000 * 1000);
-	}
-
-	endtime = get_ticks() + tmo;
-
-	do {
-		ulong now = get_ticks();
-		diff = endtime - now;
-	} while (diff >= 0);
+	wait_ticks_masked(usec2ticks(usec));
 }
 
 /*
- * This function is derived from PowerPC code (read timebase as long long).
- * On ARM it just returns the timer value.
+ * 64 bit free running tick count since timer_init(), get_tbclk() ticks
+ * per second.  Never reset, so differences can be used for benchmarks.
  */
 unsigned long long get_ticks(void)
 {
 	ulong now = READ_TIMER();
-
-	if (lastdec >= now) {
-		/* normal mode */
-		timestamp += lastdec - now;
-	} else {
-		/* we have an overflow ... */
-		timestamp += lastdec + timer_load_val - now;
-	}
+	ulong now1 = READ_TIMER1();
+	ulong ticks, est;
+
+	/* Timer 4 ticks since the last call, less any whole wraps */
+	ticks = (lastdec - now) & TIMER_LOAD_VAL;
+	/*
+	 * Timer 1 gives the same time within a tick of its own, 128 ticks
+	 * of Timer 4; add the wraps that bring us closest to it.
+	 */
+	est = ((lastdec1 - now1) & TIMER_LOAD_VAL) * TIMER_RATIO;
+	if (est + 0x8000 >= ticks)
+		ticks += (est + 0x8000 - ticks) & ~TIMER_LOAD_VAL;
+
+	timestamp += ticks;
 	lastdec = now;
+	lastdec1 = now1;
 
 	return timestamp;
 }
 
+/*
+ * Conversions between microseconds and get_ticks() units, rounding
+ * up so that delays are never too short.
+ */
+ulong usec2ticks(unsigned long usec)
+{
+	unsigned long long ticks = (unsigned long long)usec * timer_clk;
+
+	ticks += 1000000 - 1;
+	do_div(ticks, 1000000);
+	return ticks;
+}
+
+ulong ticks2usec(unsigned long ticks)
+{
+	unsigned long long usec = (unsigned long long)ticks * 1000000;
+
+	if (!timer_clk)
+		return 0;
+
+	do_div(usec, timer_clk);
+	return usec;
+}
+
+#ifdef CONFIG_BOOTSTAGE
+/*
+ * Microseconds since timer_init(), for the boot stage time stamps.
+ */
+ulong timer_get_boot_us(void)
+{
+	unsigned long long us;
+
+	if (!timer_clk)
+		return 0;
+
+	us = get_ticks() * 1000000ULL;
+	do_div(us, timer_clk);
+	return us;
+}
+#endif
+
 /*
  * This function is derived from PowerPC code (timebase clock frequency).
  * On ARM it returns the number of timer ticks per second.
  */
 ulong get_tbclk(void)
 {
-	ulong tbclk;
-
-#if defined(CONFIG_SMDK2400) || defined(CONFIG_TRAB)
-	tbclk = timer_load_val * 100;
-#elif defined(CONFIG_SBC2410X) || \
-      defined(CONFIG_SMDK2410) || \
-      defined(CONFIG_VCMA9) || \
-	  defined(CONFIG_E2440)
-	tbclk = CONFIG_SYS_HZ;
-#else
-#	error "tbclk not configured"
-#endif
-
-	return tbclk;
+	return timer_clk;
 }
 
 /*
@@ -203,6 +276,7 @@ void reset_cpu(ulong ignored)
 
 	disable_vfd();
 #endif
+	serial_flush();
 
 	watchdog = s3c24x0_get_base_watchdog();
 
@@ -122,6 +122,7 @@ static u32 roothub_portstatus(struct ohci *hc, int i)
 
 /* forward declaration */
 static int hc_interrupt(void);
+static int td_bulk_count(void *data, int len);
 static void td_submit_job(struct usb_device *dev, unsigned long pipe,
 			  void *buffer, int transfer_len,
 			  struct devrequest *setup, struct urb_priv *urb,
@@ -413,8 +414,7 @@ int sohci_submit_job(struct usb_device *dev, unsigned long pipe, void *buffer,
 	/* for the private part of the URB we need the number of TDs (size) */
 	switch (usb_pipetype(pipe)) {
 	case PIPE_BULK:
-		/* one TD for every 4096 Byte */
-		size = (transfer_len - 1) / 4096 + 1;
+		size = td_bulk_count(buffer, transfer_len);
 		break;
 	case PIPE_CONTROL:
 		/* 1 TD for setup, 1 for ACK and 1 for every 4096 B */
@@ -630,6 +630,25 @@ static struct ed *ep_add_ed(struct usb_device *usb_dev, unsigned long pipe)
  * TD handling functions
  *-------------------------------------------------------------------------*/
 
+/* a TD buffer may cross one 4 KiB page boundary, so it covers up to 8 KiB */
+static int td_max_len(void *data)
+{
+	return 8192 - ((unsigned long)data & 0xfff);
+}
+
+/* number of TDs td_submit_job() uses for a bulk transfer */
+static int td_bulk_count(void *data, int len)
+{
+	int cnt = 1;
+
+	while (len > td_max_len(data)) {
+		len -= td_max_len(data);
+		data += td_max_len(data);
+		cnt++;
+	}
+	return cnt;
+}
+
 /* enqueue next TD for this URB (OHCI spec 5.2.8.2) */
 
 static void td_fill(struct ohci *ohci, unsigned int info, void *data, int len,
@@ -714,11 +733,13 @@ static void td_submit_job(struct usb_device *dev, unsigned long pipe,
 	switch (usb_pipetype(pipe)) {
 	case PIPE_BULK:
 		info = usb_pipeout(pipe) ? TD_CC | TD_DP_OUT : TD_CC | TD_DP_IN;
-		while (data_len > 4096) {
+		while (data_len > td_max_len(data)) {
+			int len = td_max_len(data);
+
 			td_fill(ohci, info | (cnt ? TD_T_TOGGLE : toggle), data,
-				4096, dev, cnt, urb);
-			data += 4096;
-			data_len -= 4096;
+				len, dev, cnt, urb);
+			data += len;
+			data_len -= len;
 			cnt++;
 		}
 		info = usb_pipeout(pipe) ?
@@ -1313,7 +1334,6 @@ int submit_common_msg(struct usb_device *dev, unsigned long pipe, void *buffer,
 		return -1;
 	}
 
-	wait_ms(10);
 	/* ohci_dump_status(&gohci); */
 
 	/* allow more time for a BULK device to react - some are slow */
@@ -32,6 +32,7 @@
 #include <linux/list.h>
 #include <mmc.h>
 #include <div64.h>
+#include <sparse_format.h>
 
 static struct list_head mmc_devices;
 static int cur_dev_num = -1;
@@ -135,6 +136,75 @@ mmc_bwrite(int dev_num, ulong start, lbaint_t blkcnt, const void*src)
 	return blkcnt;
 }
 
+#ifdef CONFIG_SPARSE_IMAGE
+/* Blocks per write command, the S3C2440 SDI counts only 12 bits */
+#define MMC_SPARSE_MAX_BLKS	2048
+
+struct mmc_sparse {
+	struct mmc	*mmc;
+	ulong		blk;		/* block of the cursor */
+};
+
+static int mmc_sparse_write(struct sparse_storage *info, const void *buf,
+			    ulong len)
+{
+	struct mmc_sparse *ms = info->priv;
+	const uchar *p = buf;
+	lbaint_t cnt = len / ms->mmc->write_bl_len;
+
+	while (cnt) {
+		lbaint_t n = cnt < MMC_SPARSE_MAX_BLKS ?
+			     cnt : MMC_SPARSE_MAX_BLKS;
+
+		if (mmc_bwrite(ms->mmc->block_dev.dev, ms->blk, n, p) != n)
+			return -1;
+
+		ms->blk += n;
+		p += n * ms->mmc->write_bl_len;
+		cnt -= n;
+	}
+
+	return 0;
+}
+
+static int mmc_sparse_skip(struct sparse_storage *info, ulong len)
+{
+	struct mmc_sparse *ms = info->priv;
+
+	ms->blk += len / ms->mmc->write_bl_len;
+	return 0;
+}
+
+/*
+ * Write a sparse image (see include/sparse_format.h) starting at block
+ * 'start', 'len' bytes of it in memory. DONT_CARE chunks are not
+ * written at all and keep their old contents.
+ */
+int mmc_write_sparse(struct mmc *mmc, ulong start, const void *image,
+		     ulong len)
+{
+	struct mmc_sparse ms;
+	struct sparse_storage info;
+	u64 avail = mmc->capacity;
+
+	if ((u64)start * mmc->write_bl_len >= avail)
+		return -1;
+	avail -= (u64)start * mmc->write_bl_len;
+
+	ms.mmc = mmc;
+	ms.blk = start;
+
+	memset(&info, 0, sizeof(info));
+	info.priv = &ms;
+	info.size = avail > ~0UL ? ~0UL : (ulong)avail;
+	info.align = mmc->write_bl_len;
+	info.write = mmc_sparse_write;
+	info.skip = mmc_sparse_skip;
+
+	return flash_sparse(&info, image, len);
+}
+#endif
+
 int mmc_read_block(struct mmc *mmc, void *dst, uint blocknum)
 {
 	struct mmc_cmd cmd;
@@ -67,6 +67,7 @@
 #include <linux/mtd/mtd.h>
 #include <linux/mtd/nand.h>
 #include <linux/mtd/nand_ecc.h>
+#include <linux/mtd/nand_bch.h>
 
 #ifdef CONFIG_MTD_PARTITIONS
 #include <linux/mtd/partitions.h>
@@ -482,6 +483,12 @@ static int nand_block_checkbad(struct mtd_info *mtd, loff_t ofs, int getchip,
 	if (!chip->bbt)
 		return chip->block_bad(mtd, ofs, getchip);
 
+#ifdef CONFIG_NAND_BBT_LAZY
+	/* Memory based table, read the marker on first use */
+	if (!chip->bbt_td)
+		nand_resolve_bbt(mtd, ofs, getchip);
+#endif
+
 	/* Return info from the table */
 	return nand_isbad_bbt(mtd, ofs, allowbbt);
 }
@@ -595,6 +602,7 @@ static void nand_command(struct mtd_info *mtd, unsigned int command,
 	case NAND_CMD_ERASE1:
 	case NAND_CMD_ERASE2:
 	case NAND_CMD_SEQIN:
+	case NAND_CMD_PLANESEQIN:
 	case NAND_CMD_STATUS:
 		return;
 
@@ -690,6 +698,7 @@ static void nand_command_lp(struct mtd_info *mtd, unsigned int command,
 	case NAND_CMD_ERASE1:
 	case NAND_CMD_ERASE2:
 	case NAND_CMD_SEQIN:
+	case NAND_CMD_PLANESEQIN:
 	case NAND_CMD_RNDIN:
 	case NAND_CMD_STATUS:
 	case NAND_CMD_DEPLETE1:
@@ -888,6 +897,48 @@ static int nand_wait(struct mtd_info *mtd, struct nand_chip *this)
 }
 #endif
 
+#ifdef CONFIG_SYS_NAND_CACHEPRG
+/*
+ * During a cache program sequence the ready line only signals a free
+ * cache register, wait until the array is done as well.
+ */
+static void nand_wait_true_ready(struct mtd_info *mtd, struct nand_chip *chip)
+{
+	u32 timeo = (CONFIG_SYS_HZ * 20) / 1000;
+
+	chip->cmdfunc(mtd, NAND_CMD_STATUS, -1, -1);
+	reset_timer();
+
+	while (get_timer(0) < timeo) {
+		if (chip->read_byte(mtd) & NAND_STATUS_TRUE_READY)
+			break;
+	}
+}
+
+/*
+ * nand_do_write_ops() closes every cache sequence with 10h on the last
+ * page of a block, before a chip or plane switch can happen.  Should
+ * one still be open, wait for the array and check both pages it held.
+ */
+static int nand_cacheprg_end(struct mtd_info *mtd, struct nand_chip *chip)
+{
+	if (!chip->cacheprg)
+		return 0;
+
+	chip->cacheprg = 0;
+	nand_wait_true_ready(mtd, chip);
+	if (chip->read_byte(mtd) & (NAND_STATUS_FAIL | NAND_STATUS_FAIL_N1))
+		return -EIO;
+	return 0;
+}
+#else
+static inline int nand_cacheprg_end(struct mtd_info *mtd,
+				    struct nand_chip *chip)
+{
+	return 0;
+}
+#endif
+
 /**
  * nand_read_page_raw - [Intern] read raw page data without ecc
  * @mtd:	mtd info structure
@@ -1061,7 +1112,7 @@ static int nand_read_subpage(struct mtd_info *mtd, struct nand_chip *chip, uint3
 		int stat;
 
 		stat = chip->ecc.correct(mtd, p, &chip->buffers->ecccode[i], &chip->buffers->ecccalc[i]);
-		if (stat == -1)
+		if (stat < 0)
 			mtd->ecc_stats.failed++;
 		else
 			mtd->ecc_stats.corrected += stat;
@@ -1287,6 +1338,10 @@ static int nand_do_read_ops(struct mtd_info *mtd, loff_t from,
 	uint32_t readlen = ops->len;
 	uint32_t oobreadlen = ops->ooblen;
 	uint8_t *bufpoi, *oob, *buf;
+	int incache = 0;	/* in a cache read sequence */
+#ifdef CONFIG_SYS_NAND_READCACHE
+	int cacheread;
+#endif
 
 	stats = mtd->ecc_stats;
 
@@ -1301,12 +1356,28 @@ static int nand_do_read_ops(struct mtd_info *mtd, loff_t from,
 	buf = ops->datbuf;
 	oob = ops->oobbuf;
 
+#ifdef CONFIG_SYS_NAND_READCACHE
+	/*
+	 * Read ahead: the length tells whether more pages follow, so the
+	 * chip can load the next one while this one is transferred. Only
+	 * with ECC modes whose read_page issues no commands of its own.
+	 */
+	cacheread = NAND_HAS_CACHERD(chip) && !oob &&
+		    ops->mode != MTD_OOB_RAW &&
+		    chip->ecc.mode != NAND_ECC_HW_SYNDROME &&
+		    chip->ecc.mode != NAND_ECC_HW_OOB_FIRST;
+#endif
+
 	while(1) {
 		bytes = min(mtd->writesize - col, readlen);
 		aligned = (bytes == mtd->writesize);
 
-		/* Is the current page in the buffer ? */
-		if (realpage != chip->pagebuf || oob) {
+		/*
+		 * Is the current page in the buffer ? Not while in cache
+		 * read mode: the chip has loaded the page already and must
+		 * be read, or the following pages fall one behind.
+		 */
+		if (realpage != chip->pagebuf || oob || incache) {
 			bufpoi = aligned ? buf : chip->buffers->databuf;
 
 			if (likely(sndcmd)) {
@@ -1314,6 +1385,24 @@ static int nand_do_read_ops(struct mtd_info *mtd, loff_t from,
 				sndcmd = 0;
 			}
 
+#ifdef CONFIG_SYS_NAND_READCACHE
+			/*
+			 * 31h moves the page to the cache register and starts
+			 * loading the next one of the block, 3Fh ends that.
+			 */
+			if (cacheread && aligned &&
+			    readlen - bytes >= mtd->writesize &&
+			    ((page + 1) & blkcheck)) {
+				chip->cmdfunc(mtd, NAND_CMD_READCACHESEQ,
+					      -1, -1);
+				incache = 1;
+			} else if (incache) {
+				chip->cmdfunc(mtd, NAND_CMD_READCACHEEND,
+					      -1, -1);
+				incache = 0;
+			}
+#endif
+
 			/* Now read the page into the buffer */
 			if (unlikely(ops->mode == MTD_OOB_RAW))
 				ret = chip->ecc.read_page_raw(mtd, chip,
@@ -1391,8 +1480,18 @@ static int nand_do_read_ops(struct mtd_info *mtd, loff_t from,
 		 */
 		if (!NAND_CANAUTOINCR(chip) || !(page & blkcheck))
 			sndcmd = 1;
+#ifdef CONFIG_SYS_NAND_READCACHE
+		if (incache)
+			sndcmd = 0;
+#endif
 	}
 
+#ifdef CONFIG_SYS_NAND_READCACHE
+	/* leave cache read mode after an error */
+	if (incache)
+		chip->cmdfunc(mtd, NAND_CMD_READCACHEEND, -1, -1);
+#endif
+
 	ops->retlen = ops->len - (size_t) readlen;
 	if (oob)
 		ops->oobretlen = ops->ooblen - oobreadlen;
@@ -1893,13 +1992,22 @@ static int nand_write_page(struct mtd_info *mtd, struct nand_chip *chip,
 	else
 		chip->ecc.write_page(mtd, chip, buf);
 
+#if !defined(CONFIG_SYS_NAND_CACHEPRG) || defined(CONFIG_MTD_NAND_VERIFY_WRITE)
 	/*
-	 * Cached progamming disabled for now, Not sure if its worth the
-	 * trouble. The speed gain is not very impressive. (2.3->2.6Mib/s)
+	 * Cached programming is optional, and reading back for verification
+	 * would end the cache sequence after every page anyway.
 	 */
 	cached = 0;
+#endif
 
 	if (!cached || !(chip->options & NAND_CACHEPRG)) {
+		int fail = NAND_STATUS_FAIL;
+
+		/* The end of a cache sequence also reports the page before */
+		if (chip->cacheprg) {
+			fail |= NAND_STATUS_FAIL_N1;
+			chip->cacheprg = 0;
+		}
 
 		chip->cmdfunc(mtd, NAND_CMD_PAGEPROG, -1, -1);
 		status = chip->waitfunc(mtd, chip);
@@ -1907,15 +2015,29 @@ static int nand_write_page(struct mtd_info *mtd, struct nand_chip *chip,
 		 * See if operation failed and additional status checks are
 		 * available
 		 */
-		if ((status & NAND_STATUS_FAIL) && (chip->errstat))
+		if ((status & fail) && (chip->errstat))
 			status = chip->errstat(mtd, chip, FL_WRITING, status,
 					       page);
 
-		if (status & NAND_STATUS_FAIL)
+		if (status & fail)
 			return -EIO;
 	} else {
+		/*
+		 * The chip takes the next page while this one is programmed.
+		 * Ready means the cache is free again, the status reports
+		 * the previous page.
+		 */
 		chip->cmdfunc(mtd, NAND_CMD_CACHEDPROG, -1, -1);
 		status = chip->waitfunc(mtd, chip);
+
+#ifdef CONFIG_SYS_NAND_CACHEPRG
+		if (chip->cacheprg && (status & NAND_STATUS_FAIL_N1)) {
+			nand_wait_true_ready(mtd, chip);
+			chip->cacheprg = 0;
+			return -EIO;
+		}
+		chip->cacheprg = 1;
+#endif
 	}
 
 #ifdef CONFIG_MTD_NAND_VERIFY_WRITE
@@ -1979,6 +2101,60 @@ static uint8_t *nand_fill_oob(struct nand_chip *chip, uint8_t *oob,
 
 #define NOTALIGNED(x)	(x & (chip->subpagesize - 1)) != 0
 
+#ifdef CONFIG_SYS_NAND_MULTIPLANE
+/**
+ * nand_write_planes - [Internal] program two blocks in parallel
+ * @mtd:	MTD device structure
+ * @chip:	NAND chip descriptor
+ * @buf:	data for both blocks
+ * @page:	first page of the first block, which must be even
+ *
+ * Adjacent blocks lie in different planes. The data for a page of the
+ * first block is only latched (11h), the matching page of the second
+ * block follows and both are programmed together, so programming two
+ * blocks takes the time of one.
+ */
+static int nand_write_planes(struct mtd_info *mtd, struct nand_chip *chip,
+			     const uint8_t *buf, int page)
+{
+	int ppb = 1 << (chip->phys_erase_shift - chip->page_shift);
+	const uint8_t *buf2 = buf + mtd->erasesize;
+	int i, status;
+
+	for (i = 0; i < ppb; i++) {
+		chip->cmdfunc(mtd, NAND_CMD_SEQIN, 0x00, page + i);
+		chip->ecc.write_page(mtd, chip, buf);
+		/* the chip is busy for tDBSY only */
+		chip->cmdfunc(mtd, NAND_CMD_PLANEPROG, -1, -1);
+
+		chip->cmdfunc(mtd, NAND_CMD_PLANESEQIN, 0x00, page + ppb + i);
+		chip->ecc.write_page(mtd, chip, buf2);
+		chip->cmdfunc(mtd, NAND_CMD_PAGEPROG, -1, -1);
+		status = chip->waitfunc(mtd, chip);
+
+		if ((status & NAND_STATUS_FAIL) && (chip->errstat))
+			status = chip->errstat(mtd, chip, FL_WRITING, status,
+					       page + i);
+
+		if (status & NAND_STATUS_FAIL)
+			return -EIO;
+
+#ifdef CONFIG_MTD_NAND_VERIFY_WRITE
+		chip->cmdfunc(mtd, NAND_CMD_READ0, 0, page + i);
+		if (chip->verify_buf(mtd, buf, mtd->writesize))
+			return -EIO;
+		chip->cmdfunc(mtd, NAND_CMD_READ0, 0, page + ppb + i);
+		if (chip->verify_buf(mtd, buf2, mtd->writesize))
+			return -EIO;
+#endif
+		buf += mtd->writesize;
+		buf2 += mtd->writesize;
+	}
+
+	return 0;
+}
+#endif
+
 /**
  * nand_do_write_ops - [Internal] NAND write with ECC
  * @mtd:	MTD device structure
@@ -2038,24 +2214,46 @@ static int nand_do_write_ops(struct mtd_info *mtd, loff_t to,
 
 	while(1) {
 		int bytes = mtd->writesize;
-		int cached = writelen > bytes && page != blockmask;
+		int pages = 1;
+		/* the last page of a block ends a cache sequence */
+		int cached = writelen > bytes &&
+			     (page & blockmask) != blockmask;
 		uint8_t *wbuf = buf;
 
-		/* Partial page write ? */
-		if (unlikely(column || writelen < (mtd->writesize - 1))) {
-			cached = 0;
-			bytes = min_t(int, bytes - column, (int) writelen);
-			chip->pagebuf = -1;
-			memset(chip->buffers->databuf, 0xff, mtd->writesize);
-			memcpy(&chip->buffers->databuf[column], buf, bytes);
-			wbuf = chip->buffers->databuf;
-		}
+#ifdef CONFIG_SYS_NAND_MULTIPLANE
+		/* Two whole blocks, the first one even: both planes at once */
+		if (NAND_HAS_MULTIPLANE(chip) && !oob && !column &&
+		    ops->mode != MTD_OOB_RAW &&
+		    !(page & (2 * (blockmask + 1) - 1)) &&
+		    writelen >= 2 * mtd->erasesize) {
+			bytes = 2 * mtd->erasesize;
+			pages = 2 * (blockmask + 1);
+			ret = nand_cacheprg_end(mtd, chip);
+			if (!ret)
+				ret = nand_write_planes(mtd, chip, buf, page);
+		} else
+#endif
+		{
+			/* Partial page write ? */
+			if (unlikely(column ||
+				     writelen < (mtd->writesize - 1))) {
+				cached = 0;
+				bytes = min_t(int, bytes - column,
+					      (int) writelen);
+				chip->pagebuf = -1;
+				memset(chip->buffers->databuf, 0xff,
+				       mtd->writesize);
+				memcpy(&chip->buffers->databuf[column], buf,
+				       bytes);
+				wbuf = chip->buffers->databuf;
+			}
 
-		if (unlikely(oob))
-			oob = nand_fill_oob(chip, oob, ops);
+			if (unlikely(oob))
+				oob = nand_fill_oob(chip, oob, ops);
 
-		ret = chip->write_page(mtd, chip, wbuf, page, cached,
-				       (ops->mode == MTD_OOB_RAW));
+			ret = chip->write_page(mtd, chip, wbuf, page, cached,
+					       (ops->mode == MTD_OOB_RAW));
+		}
 		if (ret)
 			break;
 
@@ -2065,11 +2263,14 @@ static int nand_do_write_ops(struct mtd_info *mtd, loff_t to,
 
 		column = 0;
 		buf += bytes;
-		realpage++;
+		realpage += pages;
 
 		page = realpage & chip->pagemask;
 		/* Check, if we cross a chip boundary */
 		if (!page) {
+			ret = nand_cacheprg_end(mtd, chip);
+			if (ret)
+				break;
 			chipnr++;
 			chip->select_chip(mtd, -1);
 			chip->select_chip(mtd, chipnr);
@@ -2728,6 +2929,12 @@ static struct nand_flash_dev *nand_get_flash_type(struct mtd_info *mtd,
 	/* Get chip options, preserve non chip based options */
 	chip->options &= ~NAND_CHIPOPTIONS_MSK;
 	chip->options |= type->options & NAND_CHIPOPTIONS_MSK;
+	for (i = 0; nand_chip_options[i].mfr_id != 0x0; i++) {
+		if (nand_chip_options[i].mfr_id == *maf_id &&
+		    nand_chip_options[i].dev_id == dev_id)
+			chip->options |= nand_chip_options[i].options &
+					 NAND_CHIPOPTIONS_MSK;
+	}
 
 	/*
 	 * Set chip as a default. Board drivers can override it, if necessary
@@ -2836,9 +3043,10 @@ int nand_scan_tail(struct mtd_info *mtd)
 	chip->oob_poi = chip->buffers->databuf + mtd->writesize;
 
 	/*
-	 * If no default placement scheme is given, select an appropriate one
+	 * If no default placement scheme is given, select an appropriate one.
+	 * BCH builds its own from the ecc strength, see nand_bch_init().
 	 */
-	if (!chip->ecc.layout) {
+	if (!chip->ecc.layout && chip->ecc.mode != NAND_ECC_SOFT_BCH) {
 		switch (mtd->oobsize) {
 		case 8:
 			chip->ecc.layout = &nand_oob_8;
@@ -2939,6 +3147,33 @@ int nand_scan_tail(struct mtd_info *mtd)
 		chip->ecc.bytes = 3;
 		break;
 
+	case NAND_ECC_SOFT_BCH:
+		chip->ecc.calculate = nand_bch_calculate_ecc;
+		chip->ecc.correct = nand_bch_correct_data;
+		chip->ecc.read_page = nand_read_page_swecc;
+		chip->ecc.read_subpage = nand_read_subpage;
+		chip->ecc.write_page = nand_write_page_swecc;
+		chip->ecc.read_page_raw = nand_read_page_raw;
+		chip->ecc.write_page_raw = nand_write_page_raw;
+		chip->ecc.read_oob = nand_read_oob_std;
+		chip->ecc.write_oob = nand_write_oob_std;
+		/*
+		 * Board drivers pick the strength through ecc.bytes; the
+		 * default of 7 bytes per 512 corrects 4 bit errors.
+		 */
+		if (!chip->ecc.size)
+			chip->ecc.size = 512;
+		if (!chip->ecc.bytes)
+			chip->ecc.bytes = 7;
+		chip->ecc.priv = nand_bch_init(mtd, chip->ecc.size,
+					       chip->ecc.bytes,
+					       &chip->ecc.layout);
+		if (!chip->ecc.priv) {
+			printk(KERN_WARNING "BCH ECC initialization failed!\n");
+			BUG();
+		}
+		break;
+
 	case NAND_ECC_NONE:
 		printk(KERN_WARNING "NAND_ECC_NONE selected by board driver. "
 		       "This is not recommended !!\n");
@@ -42,6 +42,11 @@
  * 10b:		block is reserved (to protect the bbt area)
  * 11b:		block is factory marked bad
  *
+ * With CONFIG_NAND_BBT_LAZY a memory based table (no bbt on flash) is
+ * not built by scanning the whole device; all entries start out as 10b,
+ * which then means "not looked at yet", and are filled in by
+ * nand_resolve_bbt() the first time a block is checked.
+ *
  * Multichip devices like DOC store the bad block info per floor.
  *
  * Following assumptions are made:
@@ -987,6 +992,11 @@ int nand_scan_bbt(struct mtd_info *mtd, struct nand_bbt_descr *bd)
 	 * to build a memory based bad block table
 	 */
 	if (!td) {
+#ifdef CONFIG_NAND_BBT_LAZY
+		/* Every block unknown, see nand_resolve_bbt() */
+		memset(this->bbt, 0xaa, len);
+		return 0;
+#endif
 		if ((res = nand_memory_bbt(mtd, bd))) {
 			printk(KERN_ERR "nand_bbt: Can't scan flash and build the RAM-based BBT\n");
 			kfree(this->bbt);
@@ -1232,6 +1242,44 @@ int nand_isbad_bbt(struct mtd_info *mtd, loff_t offs, int allowbbt)
 	return 1;
 }
 
+#ifdef CONFIG_NAND_BBT_LAZY
+/**
+ * nand_resolve_bbt - [NAND Interface] Fill in an unknown table entry
+ * @mtd:	MTD device structure
+ * @offs:	offset in the device
+ * @getchip:	0, if the chip is already selected
+ *
+ * Reads the bad block marker of a block whose memory based table entry
+ * is still unknown and stores the result, so each block's OOB is read
+ * at most once. Only valid for tables without a flash based bbt, where
+ * 10b is not used for reserved blocks.
+ */
+void nand_resolve_bbt(struct mtd_info *mtd, loff_t offs, int getchip)
+{
+	struct nand_chip *this = mtd->priv;
+	struct nand_bbt_descr *bd = this->badblock_pattern;
+	int block, bad;
+
+	/* Get block number * 2 */
+	block = (int)(offs >> (this->bbt_erase_shift - 1));
+	if (((this->bbt[block >> 3] >> (block & 0x06)) & 0x03) != 0x02)
+		return;
+
+	offs = (loff_t)(block >> 1) << this->bbt_erase_shift;
+	bad = this->block_bad(mtd, offs, getchip);
+	if (!bad && bd && (bd->options & NAND_BBT_SCAN2NDPAGE))
+		bad = this->block_bad(mtd, offs + mtd->writesize, getchip);
+
+	this->bbt[block >> 3] &= ~(0x03 << (block & 0x06));
+	if (bad) {
+		this->bbt[block >> 3] |= 0x03 << (block & 0x06);
+		MTDDEBUG (MTD_DEBUG_LEVEL0, "Bad eraseblock %d at 0x%012llx\n",
+			  block >> 1, (unsigned long long)offs);
+		mtd->ecc_stats.badblocks++;
+	}
+}
+#endif
+
 /* XXX U-BOOT XXX */
 #if 0
 EXPORT_SYMBOL(nand_scan_bbt);
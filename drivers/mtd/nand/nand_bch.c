@@ -0,0 +1,261 @@
+/*
+ * This file provides ECC correction for more than 1 bit per block of data,
+ * using binary BCH codes. It relies on the generic BCH library
+ * lib_generic/bch.c.
+ *
+ * Taken from the Linux kernel, drivers/mtd/nand/nand_bch.c
+ *
+ * Copyright (C) 2011 Ivan Djelic <ivan.djelic@parrot.com>
+ *
+ * This file is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 or (at your option) any
+ * later version.
+ *
+ * This file is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this file; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+ */
+
+#include <common.h>
+#include <malloc.h>
+
+#include <asm/errno.h>
+#include <linux/mtd/mtd.h>
+#include <linux/mtd/nand.h>
+#include <linux/mtd/nand_bch.h>
+#include <linux/bch.h>
+
+/**
+ * struct nand_bch_control - private NAND BCH control structure
+ * @bch:	BCH control structure
+ * @ecclayout:	private ecc layout for this BCH configuration
+ * @errloc:	error location array
+ * @eccmask:	XOR ecc mask, allows erased pages to be decoded as valid
+ */
+struct nand_bch_control {
+	struct bch_control	*bch;
+	struct nand_ecclayout	ecclayout;
+	unsigned int		*errloc;
+	unsigned char		*eccmask;
+};
+
+/**
+ * nand_bch_calculate_ecc - [NAND Interface] Calculate ECC for data block
+ * @mtd:	MTD block structure
+ * @buf:	input buffer with raw data
+ * @code:	output buffer with ECC
+ */
+int nand_bch_calculate_ecc(struct mtd_info *mtd, const u_char *buf,
+			   u_char *code)
+{
+	const struct nand_chip *chip = mtd->priv;
+	struct nand_bch_control *nbc = chip->ecc.priv;
+	unsigned int i;
+
+	memset(code, 0, chip->ecc.bytes);
+	encode_bch(nbc->bch, buf, chip->ecc.size, code);
+
+	/* apply mask so that an erased page is a valid codeword */
+	for (i = 0; i < chip->ecc.bytes; i++)
+		code[i] ^= nbc->eccmask[i];
+
+	return 0;
+}
+
+/**
+ * nand_bch_correct_data - [NAND Interface] Detect and correct bit error(s)
+ * @mtd:	MTD block structure
+ * @buf:	raw data read from the chip
+ * @read_ecc:	ECC from the chip
+ * @calc_ecc:	the ECC calculated from raw data
+ *
+ * Detect and correct bit errors for a data block.  Returns the number of
+ * corrected bits or -EBADMSG.
+ */
+int nand_bch_correct_data(struct mtd_info *mtd, u_char *buf,
+			  u_char *read_ecc, u_char *calc_ecc)
+{
+	const struct nand_chip *chip = mtd->priv;
+	struct nand_bch_control *nbc = chip->ecc.priv;
+	unsigned int *errloc = nbc->errloc;
+	int i, count;
+
+	/* the mask is applied to both ecc codes, it cancels out */
+	count = decode_bch(nbc->bch, NULL, chip->ecc.size, read_ecc, calc_ecc,
+			   errloc);
+	if (count > 0) {
+		for (i = 0; i < count; i++) {
+			if (errloc[i] < (chip->ecc.size * 8))
+				/* error is located in data, correct it */
+				buf[errloc[i] >> 3] ^= (1 << (errloc[i] & 7));
+			/* else error in ecc, no action needed */
+
+			MTDDEBUG(MTD_DEBUG_LEVEL0, "%s: corrected bitflip %u\n",
+				 __func__, errloc[i]);
+		}
+	} else if (count < 0) {
+		printk(KERN_ERR "ecc unrecoverable error\n");
+		count = -EBADMSG;
+	}
+
+	return count;
+}
+
+/*
+ * Default layout: ecc bytes at the end of the spare area, leaving the
+ * bad block marker (byte 5 on small page, bytes 0-1 on large page
+ * devices) alone; everything else is free.
+ */
+static int nand_bch_build_layout(struct mtd_info *mtd,
+				 struct nand_ecclayout *layout,
+				 unsigned int total)
+{
+	struct nand_chip *chip = mtd->priv;
+	unsigned char used[NAND_MAX_OOBSIZE];
+	int i, pos, nfree;
+
+	if (mtd->oobsize > NAND_MAX_OOBSIZE ||
+	    total > ARRAY_SIZE(layout->eccpos))
+		return -EINVAL;
+
+	memset(used, 0, sizeof(used));
+	if (mtd->writesize > 512) {
+		used[0] = used[1] = 1;
+	} else {
+		used[chip->badblockpos] = 1;
+	}
+
+	layout->eccbytes = total;
+	pos = mtd->oobsize - 1;
+	for (i = total - 1; i >= 0; i--, pos--) {
+		while (pos >= 0 && used[pos])
+			pos--;
+		if (pos < 0)
+			return -EINVAL;
+		layout->eccpos[i] = pos;
+		used[pos] = 2;
+	}
+
+	nfree = 0;
+	for (pos = 0; pos < mtd->oobsize; pos++) {
+		if (used[pos])
+			continue;
+		if (nfree && layout->oobfree[nfree - 1].offset +
+		    layout->oobfree[nfree - 1].length == pos) {
+			layout->oobfree[nfree - 1].length++;
+			continue;
+		}
+		if (nfree == MTD_MAX_OOBFREE_ENTRIES)
+			break;
+		layout->oobfree[nfree].offset = pos;
+		layout->oobfree[nfree].length = 1;
+		nfree++;
+	}
+
+	return 0;
+}
+
+/**
+ * nand_bch_init - [NAND Interface] Initialize NAND BCH error correction
+ * @mtd:	MTD block structure
+ * @eccsize:	ecc block size in bytes
+ * @eccbytes:	ecc length in bytes
+ * @ecclayout:	output default layout
+ *
+ * Returns a new NAND BCH control structure, or NULL on error.
+ *
+ * The number of correctable bit errors follows from the parameters:
+ * t = (eccbytes * 8) / m with m = fls(1 + 8 * eccsize), e.g. 512 byte
+ * steps with 7 ecc bytes correct 4 bits, with 13 ecc bytes 8 bits.
+ * If *ecclayout is NULL a default layout is built.
+ */
+struct nand_bch_control *nand_bch_init(struct mtd_info *mtd,
+				       unsigned int eccsize,
+				       unsigned int eccbytes,
+				       struct nand_ecclayout **ecclayout)
+{
+	unsigned int m, t, i;
+	struct nand_bch_control *nbc = NULL;
+	unsigned char *erased_page;
+
+	if (!eccsize || !eccbytes) {
+		printk(KERN_WARNING "ecc parameters not supplied\n");
+		goto fail;
+	}
+
+	m = fls(1 + 8 * eccsize);
+	t = (eccbytes * 8) / m;
+
+	nbc = malloc(sizeof(*nbc));
+	if (!nbc)
+		goto fail;
+	memset(nbc, 0, sizeof(*nbc));
+
+	nbc->bch = init_bch(m, t, 0);
+	if (!nbc->bch)
+		goto fail;
+
+	/* verify that eccbytes has the expected value */
+	if (nbc->bch->ecc_bytes != eccbytes) {
+		printk(KERN_WARNING "invalid eccbytes %u, should be %u\n",
+		       eccbytes, nbc->bch->ecc_bytes);
+		goto fail;
+	}
+
+	if (!*ecclayout) {
+		if (nand_bch_build_layout(mtd, &nbc->ecclayout,
+					  (mtd->writesize / eccsize) *
+					  eccbytes)) {
+			printk(KERN_WARNING "no suitable oob scheme available "
+			       "for oobsize %d eccbytes %u\n", mtd->oobsize,
+			       eccbytes);
+			goto fail;
+		}
+		*ecclayout = &nbc->ecclayout;
+	}
+
+	nbc->eccmask = malloc(eccbytes);
+	nbc->errloc = malloc(t * sizeof(*nbc->errloc));
+	if (!nbc->eccmask || !nbc->errloc)
+		goto fail;
+
+	/*
+	 * compute and store the inverted ecc of an erased ecc block
+	 */
+	erased_page = malloc(eccsize);
+	if (!erased_page)
+		goto fail;
+
+	memset(erased_page, 0xff, eccsize);
+	memset(nbc->eccmask, 0, eccbytes);
+	encode_bch(nbc->bch, erased_page, eccsize, nbc->eccmask);
+	free(erased_page);
+
+	for (i = 0; i < eccbytes; i++)
+		nbc->eccmask[i] ^= 0xff;
+
+	return nbc;
+fail:
+	nand_bch_free(nbc);
+	return NULL;
+}
+
+/**
+ * nand_bch_free - [NAND Interface] Release NAND BCH ECC resources
+ * @nbc:	NAND BCH control structure
+ */
+void nand_bch_free(struct nand_bch_control *nbc)
+{
+	if (nbc) {
+		free_bch(nbc->bch);
+		free(nbc->errloc);
+		free(nbc->eccmask);
+		free(nbc);
+	}
+}
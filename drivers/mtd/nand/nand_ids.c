@@ -128,6 +128,18 @@ struct nand_flash_dev nand_flash_ids[] = {
 	{NULL,}
 };
 
+/*
+*	Per chip options
+*
+*	Capabilities whose command sequence differs between manufacturers,
+*	so they can not go into the device ID list above
+*/
+struct nand_chip_options nand_chip_options[] = {
+	{NAND_MFR_SAMSUNG, 0xda, NAND_MULTIPLANE | NAND_CACHERD},	/* K9F2G08 */
+	{NAND_MFR_SAMSUNG, 0xdc, NAND_MULTIPLANE | NAND_CACHERD},	/* K9F4G08 */
+	{0x0, 0x0, 0}
+};
+
 /*
 *	Manufacturer ID list
 */
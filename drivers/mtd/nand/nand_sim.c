@@ -0,0 +1,655 @@
+/*
+ * RAM backed NAND flash simulator
+ *
+ * Models a single 8 bit NAND chip at the command level, below the
+ * generic NAND code: page register, sequential and random data
+ * in/out, cache read, program (bits can only be cleared), cache and
+ * two-plane program, block erase, status, factory bad blocks, bit flip
+ * and program/erase failure injection.
+ * The flash array lives in RAM at CONFIG_SYS_NAND_BASE, pages stored
+ * with their OOB appended.
+ *
+ * Every operation is counted together with the time the real chip
+ * would need, so the efficiency of NAND users (nand_base, bbt, env,
+ * JFFS2, UBI, YAFFS2) can be measured without the hardware; see the
+ * "nandsim" command.
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+#include <common.h>
+#include <command.h>
+#include <malloc.h>
+#include <nand.h>
+#include <asm/errno.h>
+#include <linux/mtd/nand_bch.h>
+
+/* Samsung K9F5608, 32 MiB, 512 byte pages */
+#ifndef CONFIG_NAND_SIM_ID
+#define CONFIG_NAND_SIM_ID		{ 0xec, 0x75 }
+#endif
+
+/* Typical small page timing, in ns */
+#ifndef CONFIG_NAND_SIM_TIMING
+#define CONFIG_NAND_SIM_TIMING		{ 12000, 200000, 2000000, 50 }
+#endif
+
+#define NAND_SIM_MAX_FAIL	8
+
+#define NAND_SIM_STATUS	(NAND_STATUS_READY | NAND_STATUS_TRUE_READY | \
+			 NAND_STATUS_WP)
+
+struct nand_sim_timing {
+	ulong	t_r;			/* array to page register */
+	ulong	t_prog;			/* page program */
+	ulong	t_bers;			/* block erase */
+	ulong	t_rc;			/* one byte over the bus */
+};
+
+struct nand_sim_stats {
+	ulong	reads;			/* pages loaded into the register */
+	ulong	programs;
+	ulong	erases;
+	ulong	bytes_out;		/* bytes read over the bus */
+	ulong	bytes_in;		/* bytes written over the bus */
+	ulong	bitflips;		/* injected */
+	u64	busy_ns;		/* simulated chip busy time */
+	u64	bus_ns;			/* simulated bus transfer time */
+};
+
+static struct nand_sim {
+	struct nand_chip	*chip;
+	u_char			*array;		/* the flash contents */
+	int			ready;		/* array initialized */
+
+	/* command state */
+	int			cmd;		/* last command */
+	u_char			addr[5];	/* address cycles */
+	int			naddr;
+	int			area;		/* small page read pointer */
+	int			page;
+	int			loaded;		/* page register valid */
+	int			ptr;		/* page register index */
+	int			idx;		/* READID byte index */
+	u_char			status;
+	int			fail_n1;	/* cached page failed */
+	ulong			cache_ns;	/* cache program/read still busy */
+	int			rcache;		/* cache read in progress */
+
+	u_char			*reg;		/* page register */
+
+	/* injection */
+	ulong			bitflip_every;	/* flip a bit every n loads */
+	ulong			bitflip_seed;
+	ulong			fail[NAND_SIM_MAX_FAIL]; /* failing blocks */
+	int			nfail;
+	int			delay;		/* actually wait busy times */
+
+	struct nand_sim_timing	timing;
+	struct nand_sim_stats	stats;
+} sim = {
+	.timing = CONFIG_NAND_SIM_TIMING,
+};
+
+static const u_char nand_sim_id[] = CONFIG_NAND_SIM_ID;
+
+static inline int sim_page_size(struct mtd_info *mtd)
+{
+	return mtd->writesize + mtd->oobsize;
+}
+
+static inline u_char *sim_page(struct mtd_info *mtd, int page)
+{
+	return sim.array + (ulong)page * sim_page_size(mtd);
+}
+
+static void sim_busy(ulong ns)
+{
+	sim.stats.busy_ns += ns;
+	if (sim.delay)
+		udelay((ns + 999) / 1000);
+}
+
+/* The array is free only once a cache program has finished */
+static void sim_cache_wait(void)
+{
+	sim_busy(sim.cache_ns);
+	sim.cache_ns = 0;
+}
+
+/*
+ * Erase the whole array and apply the factory bad block markers. Done
+ * on first access, when nand_scan() has determined the geometry.
+ */
+static void sim_array_init(struct mtd_info *mtd)
+{
+#ifdef CONFIG_NAND_SIM_BADBLOCKS
+	static const ulong bad[] = CONFIG_NAND_SIM_BADBLOCKS;
+	int ppb = mtd->erasesize / mtd->writesize;
+	int i;
+#endif
+	struct nand_chip *chip = mtd->priv;
+	ulong pages = chip->chipsize >> chip->page_shift;
+
+#ifndef CONFIG_NAND_SIM_KEEP
+	memset(sim.array, 0xff, pages * sim_page_size(mtd));
+#endif
+
+#ifdef CONFIG_NAND_SIM_BADBLOCKS
+	for (i = 0; i < ARRAY_SIZE(bad); i++) {
+		if (bad[i] * ppb >= pages)
+			continue;
+		/* both the small and the large page marker position */
+		sim_page(mtd, bad[i] * ppb)[mtd->writesize] = 0;
+		sim_page(mtd, bad[i] * ppb)[mtd->writesize + 5] = 0;
+	}
+#endif
+
+	sim.ready = 1;
+}
+
+static int sim_failing(struct mtd_info *mtd, int page)
+{
+	ulong block = page / (mtd->erasesize / mtd->writesize);
+	int i;
+
+	for (i = 0; i < sim.nfail; i++)
+		if (sim.fail[i] == block)
+			return 1;
+
+	return 0;
+}
+
+/* Decode the collected address cycles */
+static void sim_decode(struct mtd_info *mtd, int cols, int *col, int *page)
+{
+	int i, n = 0;
+
+	*col = 0;
+	if (cols) {
+		*col = sim.addr[n++];
+		if (mtd->writesize > 512)
+			*col |= sim.addr[n++] << 8;
+	}
+
+	if (page) {
+		*page = 0;
+		for (i = 0; n < sim.naddr; i += 8)
+			*page |= sim.addr[n++] << i;
+	}
+}
+
+/*
+ * Load the addressed page into the page register, which takes ns on
+ * top of finishing a cache operation.
+ */
+static void sim_load(struct mtd_info *mtd, int page, ulong ns)
+{
+	struct nand_chip *chip = mtd->priv;
+	int bits = sim_page_size(mtd) * 8;
+	ulong bit;
+
+	sim.page = page;
+	if ((ulong)page < chip->chipsize >> chip->page_shift)
+		memcpy(sim.reg, sim_page(mtd, page), sim_page_size(mtd));
+	else
+		memset(sim.reg, 0xff, sim_page_size(mtd));
+	sim.loaded = 1;
+	sim.stats.reads++;
+	sim_cache_wait();
+	sim_busy(ns);
+
+	if (sim.bitflip_every && sim.stats.reads % sim.bitflip_every == 0) {
+		sim.bitflip_seed = sim.bitflip_seed * 1103515245 + 12345;
+		bit = (sim.bitflip_seed >> 8) % bits;
+		sim.reg[bit >> 3] ^= 1 << (bit & 7);
+		sim.stats.bitflips++;
+	}
+}
+
+static void sim_start_read(struct mtd_info *mtd)
+{
+	int col, page;
+
+	sim_decode(mtd, 1, &col, &page);
+	sim_load(mtd, page, sim.timing.t_r);
+	sim.ptr = sim.area + col;
+}
+
+/*
+ * PAGEPROG programs the page register, together with a page latched
+ * for the other plane by PLANEPROG before. CACHEDPROG returns at once
+ * and programs while the next page is transferred; its result shows
+ * up as FAIL_N1 with the next program command.
+ */
+static void sim_program(struct mtd_info *mtd, int cmd)
+{
+	struct nand_chip *chip = mtd->priv;
+	u_char *p = sim_page(mtd, sim.page);
+	int i, fail;
+
+	sim.stats.programs++;
+	sim_cache_wait();
+
+	fail = (ulong)sim.page >= chip->chipsize >> chip->page_shift ||
+	       sim_failing(mtd, sim.page);
+
+	/* a cache sequence has to end with 10h on the last page of a block */
+	if (cmd == NAND_CMD_CACHEDPROG &&
+	    !((sim.page + 1) & (mtd->erasesize / mtd->writesize - 1)))
+		fail = 1;
+
+	if (!fail) {
+		/* programming can only clear bits */
+		for (i = 0; i < sim_page_size(mtd); i++)
+			p[i] &= sim.reg[i];
+	}
+
+	switch (cmd) {
+	case NAND_CMD_PLANEPROG:
+		sim.status |= fail ? NAND_STATUS_FAIL : 0;
+		return;
+	case NAND_CMD_CACHEDPROG:
+		sim.status = NAND_SIM_STATUS |
+			     (sim.fail_n1 ? NAND_STATUS_FAIL_N1 : 0);
+		sim.fail_n1 = fail;
+		sim.cache_ns = sim.timing.t_prog;
+		return;
+	default:
+		sim.status |= (fail ? NAND_STATUS_FAIL : 0) |
+			      (sim.fail_n1 ? NAND_STATUS_FAIL_N1 : 0);
+		sim.fail_n1 = 0;
+		sim_busy(sim.timing.t_prog);
+		return;
+	}
+}
+
+static void sim_erase(struct mtd_info *mtd)
+{
+	int ppb = mtd->erasesize / mtd->writesize;
+	int col, page;
+
+	sim_decode(mtd, 0, &col, &page);
+	page &= ~(ppb - 1);
+
+	sim.stats.erases++;
+	sim_cache_wait();
+	sim_busy(sim.timing.t_bers);
+
+	if (sim_failing(mtd, page)) {
+		sim.status |= NAND_STATUS_FAIL;
+		return;
+	}
+
+	memset(sim_page(mtd, page), 0xff, ppb * sim_page_size(mtd));
+}
+
+/*
+ * 31h hands the loaded page to the cache register and loads the next
+ * one meanwhile; 3Fh hands over the last one without loading further.
+ */
+static void sim_read_cache(struct mtd_info *mtd, int cmd)
+{
+	if (sim.rcache)
+		sim_load(mtd, sim.page + 1, 0);
+
+	sim.ptr = 0;
+	sim.rcache = cmd == NAND_CMD_READCACHESEQ;
+	if (sim.rcache)
+		sim.cache_ns = sim.timing.t_r;
+}
+
+static void sim_command(struct mtd_info *mtd, int cmd)
+{
+	int col;
+
+	if (!sim.ready && cmd != NAND_CMD_RESET && cmd != NAND_CMD_READID)
+		sim_array_init(mtd);
+
+	switch (cmd) {
+	case NAND_CMD_READ0:
+	case NAND_CMD_READ1:
+	case NAND_CMD_READOOB:
+		sim.area = cmd == NAND_CMD_READ0 ? 0 :
+			   cmd == NAND_CMD_READ1 ? 256 : mtd->writesize;
+		sim.loaded = 0;
+		sim.rcache = 0;
+		break;
+	case NAND_CMD_READSTART:
+		sim_start_read(mtd);
+		break;
+	case NAND_CMD_RNDOUTSTART:
+		sim_decode(mtd, 1, &col, NULL);
+		sim.ptr = col;
+		break;
+	case NAND_CMD_READCACHESEQ:
+	case NAND_CMD_READCACHEEND:
+		sim_read_cache(mtd, cmd);
+		break;
+	case NAND_CMD_RNDOUT:
+	case NAND_CMD_RNDIN:
+		break;
+	case NAND_CMD_SEQIN:
+	case NAND_CMD_PLANESEQIN:
+		memset(sim.reg, 0xff, sim_page_size(mtd));
+		sim.loaded = 0;
+		if (sim.cmd != NAND_CMD_PLANEPROG)
+			sim.status = NAND_SIM_STATUS;
+		break;
+	case NAND_CMD_PAGEPROG:
+	case NAND_CMD_CACHEDPROG:
+	case NAND_CMD_PLANEPROG:
+		sim_program(mtd, cmd);
+		sim.area = 0;
+		break;
+	case NAND_CMD_ERASE2:
+		sim_erase(mtd);
+		break;
+	case NAND_CMD_ERASE1:
+	case NAND_CMD_READID:
+		sim.status = NAND_SIM_STATUS;
+		break;
+	case NAND_CMD_STATUS:
+	case NAND_CMD_STATUS_MULTI:
+		break;
+	case NAND_CMD_RESET:
+		sim.area = 0;
+		sim.loaded = 0;
+		sim.fail_n1 = 0;
+		sim.status = NAND_SIM_STATUS;
+		break;
+	default:
+		printf("nandsim: unsupported command 0x%02x\n", cmd);
+		break;
+	}
+
+	sim.cmd = cmd;
+	sim.naddr = 0;
+	sim.idx = 0;
+}
+
+/*
+ * Read and program commands without a confirm command take effect once
+ * the address cycles are followed by data or another command.
+ */
+static void sim_data_start(struct mtd_info *mtd)
+{
+	int col, page;
+
+	if (!sim.naddr)
+		return;
+
+	switch (sim.cmd) {
+	case NAND_CMD_READ0:
+	case NAND_CMD_READ1:
+	case NAND_CMD_READOOB:
+		/* small page chips start reading after the last cycle */
+		sim_start_read(mtd);
+		break;
+	case NAND_CMD_SEQIN:
+	case NAND_CMD_PLANESEQIN:
+		sim_decode(mtd, 1, &col, &page);
+		sim.page = page;
+		sim.ptr = sim.area + col;
+		break;
+	case NAND_CMD_RNDIN:
+		sim_decode(mtd, 1, &col, NULL);
+		sim.ptr = col;
+		break;
+	default:
+		return;
+	}
+	sim.naddr = 0;
+}
+
+static void nand_sim_cmd_ctrl(struct mtd_info *mtd, int dat, unsigned int ctrl)
+{
+	if (dat == NAND_CMD_NONE)
+		return;
+
+	if (ctrl & NAND_CLE) {
+		/* confirm commands use the address cycles themselves */
+		if (dat != NAND_CMD_READSTART && dat != NAND_CMD_RNDOUTSTART)
+			sim_data_start(mtd);
+		sim_command(mtd, dat);
+	} else if (ctrl & NAND_ALE) {
+		if (sim.naddr < sizeof(sim.addr))
+			sim.addr[sim.naddr++] = dat;
+	}
+}
+
+static int nand_sim_dev_ready(struct mtd_info *mtd)
+{
+	return 1;
+}
+
+static uint8_t nand_sim_read_byte(struct mtd_info *mtd);
+
+static void nand_sim_read_buf(struct mtd_info *mtd, u_char *buf, int len)
+{
+	int n;
+
+	sim_data_start(mtd);
+
+	if (sim.cmd == NAND_CMD_STATUS || sim.cmd == NAND_CMD_READID) {
+		while (len--)
+			*buf++ = nand_sim_read_byte(mtd);
+		return;
+	}
+
+	sim.stats.bytes_out += len;
+	sim.stats.bus_ns += (u64)len * sim.timing.t_rc;
+
+	/* the next page loads while this one goes out */
+	if (sim.cache_ns > len * sim.timing.t_rc)
+		sim.cache_ns -= len * sim.timing.t_rc;
+	else
+		sim.cache_ns = 0;
+
+	while (len) {
+		/* sequential read continues with the next page */
+		if (!sim.loaded || sim.ptr >= sim_page_size(mtd)) {
+			sim_load(mtd, sim.loaded ? sim.page + 1 : sim.page,
+				 sim.timing.t_r);
+			sim.ptr = sim.area == mtd->writesize ? sim.area : 0;
+		}
+
+		n = sim_page_size(mtd) - sim.ptr;
+		if (n > len)
+			n = len;
+		memcpy(buf, sim.reg + sim.ptr, n);
+		sim.ptr += n;
+		buf += n;
+		len -= n;
+	}
+}
+
+static uint8_t nand_sim_read_byte(struct mtd_info *mtd)
+{
+	u_char b;
+
+	sim_data_start(mtd);
+
+	switch (sim.cmd) {
+	case NAND_CMD_STATUS:
+		/*
+		 * While a cache program runs, ready only means a free cache
+		 * register.  Each poll waits one cycle for the array; once
+		 * it is done, FAIL reports the cached page.
+		 */
+		if (sim.cache_ns > sim.timing.t_rc) {
+			sim.cache_ns -= sim.timing.t_rc;
+			sim_busy(sim.timing.t_rc);
+			return sim.status & ~NAND_STATUS_TRUE_READY;
+		}
+		sim_cache_wait();
+		return sim.status | (sim.fail_n1 ? NAND_STATUS_FAIL : 0);
+	case NAND_CMD_READID:
+		if (sim.idx < sizeof(nand_sim_id))
+			return nand_sim_id[sim.idx++];
+		return 0;
+	}
+
+	nand_sim_read_buf(mtd, &b, 1);
+	return b;
+}
+
+static void nand_sim_write_buf(struct mtd_info *mtd, const u_char *buf,
+			       int len)
+{
+	int n;
+
+	sim_data_start(mtd);
+
+	sim.stats.bytes_in += len;
+	sim.stats.bus_ns += (u64)len * sim.timing.t_rc;
+
+	/* a cache program runs while the next page comes in */
+	if (sim.cache_ns > len * sim.timing.t_rc)
+		sim.cache_ns -= len * sim.timing.t_rc;
+	else
+		sim.cache_ns = 0;
+
+	n = sim_page_size(mtd) - sim.ptr;
+	if (n > len)
+		n = len;
+	if (n > 0) {
+		memcpy(sim.reg + sim.ptr, buf, n);
+		sim.ptr += n;
+	}
+}
+
+static int nand_sim_verify_buf(struct mtd_info *mtd, const u_char *buf,
+			       int len)
+{
+	u_char tmp[64];
+	int n;
+
+	while (len) {
+		n = len < sizeof(tmp) ? len : sizeof(tmp);
+		nand_sim_read_buf(mtd, tmp, n);
+		if (memcmp(tmp, buf, n))
+			return -EFAULT;
+		buf += n;
+		len -= n;
+	}
+
+	return 0;
+}
+
+static void nand_sim_select_chip(struct mtd_info *mtd, int chip)
+{
+}
+
+int board_nand_init(struct nand_chip *nand)
+{
+	/* the geometry is not known yet, size for the largest one */
+	if (!sim.reg)
+		sim.reg = malloc(NAND_MAX_PAGESIZE + NAND_MAX_OOBSIZE);
+	if (!sim.reg)
+		return -ENOMEM;
+
+	sim.chip = nand;
+	sim.array = (u_char *)nand->IO_ADDR_R;
+
+	nand->cmd_ctrl = nand_sim_cmd_ctrl;
+	nand->dev_ready = nand_sim_dev_ready;
+	nand->select_chip = nand_sim_select_chip;
+	nand->read_byte = nand_sim_read_byte;
+	nand->read_buf = nand_sim_read_buf;
+	nand->write_buf = nand_sim_write_buf;
+	nand->verify_buf = nand_sim_verify_buf;
+	nand->chip_delay = 0;
+
+#if defined(CONFIG_NAND_ECC_BCH)
+	nand->ecc.mode = NAND_ECC_SOFT_BCH;
+	nand->ecc.size = 512;
+	nand->ecc.bytes = NAND_BCH_ECCBYTES(CONFIG_NAND_BCH_T);
+#else
+	nand->ecc.mode = NAND_ECC_SOFT;
+#endif
+
+	return 0;
+}
+
+static void nand_sim_print_ns(const char *name, u64 ns)
+{
+	u64 us = ns;
+
+	do_div(us, 1000);
+	printf("  %-10s %llu us\n", name, us);
+}
+
+static int do_nandsim(cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
+{
+	ulong block;
+
+	if (argc < 2 || !strcmp(argv[1], "info")) {
+		printf("nandsim: %lu page reads, %lu programs, %lu erases, "
+		       "%lu bit flips injected\n", sim.stats.reads,
+		       sim.stats.programs, sim.stats.erases,
+		       sim.stats.bitflips);
+		printf("  %lu bytes out, %lu bytes in\n", sim.stats.bytes_out,
+		       sim.stats.bytes_in);
+		nand_sim_print_ns("chip busy", sim.stats.busy_ns);
+		nand_sim_print_ns("bus", sim.stats.bus_ns);
+		nand_sim_print_ns("total", sim.stats.busy_ns +
+				  sim.stats.bus_ns);
+		return 0;
+	}
+
+	if (!strcmp(argv[1], "reset")) {
+		memset(&sim.stats, 0, sizeof(sim.stats));
+		return 0;
+	}
+
+	if (argc < 3) {
+		cmd_usage(cmdtp);
+		return 1;
+	}
+
+	if (!strcmp(argv[1], "bitflip")) {
+		sim.bitflip_every = simple_strtoul(argv[2], NULL, 10);
+		sim.bitflip_seed = sim.bitflip_every;
+	} else if (!strcmp(argv[1], "fail")) {
+		block = simple_strtoul(argv[2], NULL, 16) / nand_info[0].erasesize;
+		if (sim.nfail == NAND_SIM_MAX_FAIL) {
+			puts("nandsim: too many failing blocks\n");
+			return 1;
+		}
+		sim.fail[sim.nfail++] = block;
+	} else if (!strcmp(argv[1], "delay")) {
+		sim.delay = simple_strtoul(argv[2], NULL, 10);
+	} else {
+		cmd_usage(cmdtp);
+		return 1;
+	}
+
+	return 0;
+}
+
+U_BOOT_CMD(
+	nandsim,	3,	0,	do_nandsim,
+	"NAND flash simulator",
+	"[info] - show operation counts and simulated flash time\n"
+	"nandsim reset - clear the statistics\n"
+	"nandsim bitflip n - flip one bit in every n-th page read (0: off)\n"
+	"nandsim fail off - let program and erase fail in block at 'off'\n"
+	"nandsim delay 0|1 - really wait the simulated busy times"
+);
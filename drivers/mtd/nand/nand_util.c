@@ -40,6 +40,10 @@
 #include <linux/mtd/mtd.h>
 #include <nand.h>
 #include <jffs2/jffs2.h>
+#include <sparse_format.h>
+#ifdef CONFIG_LZMA
+#include <lzma/LzmaTools.h>
+#endif
 
 typedef struct erase_info erase_info_t;
 typedef struct mtd_info	  mtd_info_t;
@@ -605,3 +609,447 @@ int nand_read_skip_bad(nand_info_t *nand, loff_t offset, size_t *length,
 
 	return 0;
 }
+
+#ifdef CONFIG_LZMA
+/**
+ * nand_read_lzma:
+ *
+ * Read an LZMA_Alone stream (as written by "lzma") from NAND flash and
+ * uncompress it while it is being read, one erase block at a time, so
+ * the compressed data is never staged in RAM. Bad blocks are skipped
+ * as with nand_read_skip_bad(). Reading stops at the end of the stream.
+ *
+ * @param nand		NAND device
+ * @param offset	offset in flash
+ * @param length	size of the area holding the stream, without bad blocks
+ * @param buffer	destination
+ * @param size		destination size; uncompressed length on return
+ * @return		0 in case of success
+ */
+int nand_read_lzma(nand_info_t *nand, loff_t offset, size_t length,
+		   u_char *buffer, size_t *size)
+{
+	LzmaStream s;
+	u_char *buf;
+	int rval = 0, res;
+
+	if ((offset + get_len_incl_bad(nand, offset, length)) > nand->size) {
+		printf("Attempt to read outside the flash area\n");
+		return -EINVAL;
+	}
+
+	buf = malloc(nand->erasesize);
+	if (!buf) {
+		printf("Out of memory\n");
+		return -ENOMEM;
+	}
+
+	lzmaStreamInit(&s, buffer, *size);
+	while (length > 0 && !s.finished) {
+		size_t block_offset = offset & (nand->erasesize - 1);
+		size_t read_length;
+
+		WATCHDOG_RESET();
+
+		if (nand_block_isbad(nand, offset & ~(nand->erasesize - 1))) {
+			printf("Skipping bad block 0x%08llx\n",
+			       offset & ~(nand->erasesize - 1));
+			offset += nand->erasesize - block_offset;
+			continue;
+		}
+
+		if (length < (nand->erasesize - block_offset))
+			read_length = length;
+		else
+			read_length = nand->erasesize - block_offset;
+
+		rval = nand_read(nand, offset, &read_length, buf);
+		if (rval && rval != -EUCLEAN) {
+			printf("NAND read from offset %llx failed %d\n",
+			       offset, rval);
+			break;
+		}
+		rval = 0;
+
+		res = lzmaStreamDecode(&s, buf, read_length);
+		if (res != SZ_OK) {
+			printf("LZMA: uncompress or overwrite error %d\n", res);
+			rval = -EINVAL;
+			break;
+		}
+
+		length -= read_length;
+		offset += read_length;
+	}
+
+	if (!rval && !s.finished) {
+		printf("LZMA: stream continues past the end of the area\n");
+		rval = -EINVAL;
+	}
+
+	*size = lzmaStreamOutLen(&s);
+	lzmaStreamEnd(&s);
+	free(buf);
+	return rval;
+}
+#endif /* CONFIG_LZMA */
+
+#ifdef CONFIG_SPARSE_IMAGE
+struct nand_sparse {
+	nand_info_t	*nand;
+	loff_t		phys;		/* flash offset of the cursor */
+	loff_t		end;		/* end of the target area */
+	loff_t		erased;		/* blocks below are erased */
+};
+
+/*
+ * Move the cursor out of bad blocks and erase the block it points into
+ * if that has not been done yet. Returns the bytes left in the block.
+ */
+static int nand_sparse_block(struct nand_sparse *ns, size_t *avail)
+{
+	nand_info_t *nand = ns->nand;
+	loff_t block;
+
+	for (;;) {
+		if (ns->phys >= ns->end) {
+			puts("Sparse image does not fit, too many bad blocks\n");
+			return -ENOSPC;
+		}
+
+		block = ns->phys & ~((loff_t)nand->erasesize - 1);
+		if (!nand_block_isbad(nand, block))
+			break;
+
+		printf("Skip bad block 0x%08llx\n", block);
+		ns->phys = block + nand->erasesize;
+	}
+
+	if (block >= ns->erased) {
+		erase_info_t erase;
+		int ret;
+
+		memset(&erase, 0, sizeof(erase));
+		erase.mtd = nand;
+		erase.addr = block;
+		erase.len = nand->erasesize;
+
+		ret = nand->erase(nand, &erase);
+		if (ret) {
+			printf("NAND erase at offset %llx failed %d\n",
+			       block, ret);
+			return ret;
+		}
+		ns->erased = block + nand->erasesize;
+	}
+
+	*avail = block + nand->erasesize - ns->phys;
+	return 0;
+}
+
+static int nand_sparse_write(struct sparse_storage *info, const void *buf,
+			     ulong len)
+{
+	struct nand_sparse *ns = info->priv;
+	const u_char *p = buf;
+	size_t avail, n;
+	int ret;
+
+	while (len) {
+		ret = nand_sparse_block(ns, &avail);
+		if (ret)
+			return ret;
+
+		n = len < avail ? len : avail;
+		ret = nand_write_skip_bad(ns->nand, ns->phys, &n, (u_char *)p);
+		if (ret)
+			return ret;
+
+		ns->phys += n;
+		p += n;
+		len -= n;
+	}
+
+	return 0;
+}
+
+static int nand_sparse_skip(struct sparse_storage *info, ulong len)
+{
+	struct nand_sparse *ns = info->priv;
+	size_t avail, n;
+	int ret;
+
+	while (len) {
+		ret = nand_sparse_block(ns, &avail);
+		if (ret)
+			return ret;
+
+		n = len < avail ? len : avail;
+		ns->phys += n;
+		len -= n;
+	}
+
+	return 0;
+}
+
+/**
+ * nand_write_sparse:
+ *
+ * Write a sparse image (see include/sparse_format.h) to NAND flash.
+ * Every block the image covers is erased just before it is first
+ * used; DONT_CARE chunks and FILL chunks of 0xff are only erased, not
+ * programmed. Bad blocks are skipped as with nand_write_skip_bad().
+ *
+ * @param nand		NAND device
+ * @param offset	offset in flash, block aligned
+ * @param length	size of the target area, including bad blocks
+ * @param image		sparse image in memory
+ * @param image_len	bytes of the image in memory
+ * @return		0 in case of success
+ */
+int nand_write_sparse(nand_info_t *nand, loff_t offset, size_t length,
+		      const void *image, size_t image_len)
+{
+	struct nand_sparse ns;
+	struct sparse_storage info;
+
+	if ((offset & (nand->erasesize - 1)) != 0) {
+		printf("Attempt to write sparse image to non block aligned "
+		       "offset\n");
+		return -EINVAL;
+	}
+
+	if (offset + length > nand->size)
+		length = nand->size - offset;
+
+	ns.nand = nand;
+	ns.phys = offset;
+	ns.end = offset + length;
+	ns.erased = offset;
+
+	memset(&info, 0, sizeof(info));
+	info.priv = &ns;
+	info.size = length;
+	info.align = nand->writesize;
+	info.fill_erased = 1;
+	info.write = nand_sparse_write;
+	info.skip = nand_sparse_skip;
+
+	return flash_sparse(&info, image, image_len);
+}
+#endif /* CONFIG_SPARSE_IMAGE */
+
+#ifdef CONFIG_CMD_NAND_TFTP
+/**
+ * nand_stream_open:
+ *
+ * Prepare to write a stream of data of unknown length to NAND flash,
+ * one erase block at a time, without staging the whole image in RAM.
+ * Bad blocks are skipped, blocks that fail to erase or program are
+ * marked bad and skipped as well.
+ *
+ * @param ns		stream state
+ * @param nand		NAND device
+ * @param offset	offset in flash, block aligned
+ * @param length	size of the target area, including bad blocks
+ * @return		0 in case of success
+ */
+int nand_stream_open(struct nand_stream *ns, nand_info_t *nand,
+		     loff_t offset, size_t length)
+{
+	if ((offset & (nand->erasesize - 1)) != 0) {
+		printf("Attempt to write to non block aligned offset\n");
+		return -EINVAL;
+	}
+
+	if (offset + length > nand->size)
+		length = nand->size - offset;
+
+	memset(ns, 0, sizeof(*ns));
+	ns->nand = nand;
+	ns->start = offset;
+	ns->end = offset + length;
+
+	/* one block being filled plus one network packet of slack */
+	ns->buf = malloc(2 * nand->erasesize);
+	if (!ns->buf) {
+		puts("NAND stream: out of memory\n");
+		return -ENOMEM;
+	}
+
+	nand_stream_reset(ns);
+	return 0;
+}
+
+/* Start over at the first block, e.g. when the sender restarts */
+void nand_stream_reset(struct nand_stream *ns)
+{
+	ns->off = ns->start;
+	ns->fill = 0;
+	ns->total = 0;
+	ns->crc = 0;
+}
+
+void nand_stream_close(struct nand_stream *ns)
+{
+	free(ns->buf);
+	ns->buf = NULL;
+}
+
+/* Erase the next good block and program len bytes of the buffer */
+static int nand_stream_block(struct nand_stream *ns, size_t len)
+{
+	nand_info_t *nand = ns->nand;
+	erase_info_t erase;
+	size_t n;
+	int ret;
+
+	for (;; ns->off += nand->erasesize) {
+		if (ns->off >= ns->end) {
+			puts("\nNAND stream: no space left in target area\n");
+			return -ENOSPC;
+		}
+
+		if (nand_block_isbad(nand, ns->off)) {
+			printf("\nSkip bad block 0x%08llx\n", ns->off);
+			continue;
+		}
+
+		memset(&erase, 0, sizeof(erase));
+		erase.mtd = nand;
+		erase.addr = ns->off;
+		erase.len = nand->erasesize;
+
+		ret = nand->erase(nand, &erase);
+		if (!ret) {
+			n = len;
+			ret = nand_write(nand, ns->off, &n, ns->buf);
+		}
+		if (!ret)
+			break;
+
+		printf("\nNAND stream: block 0x%08llx failed %d, marking bad\n",
+		       ns->off, ret);
+		nand->block_markbad(nand, ns->off);
+	}
+
+	ns->off += nand->erasesize;
+	return 0;
+}
+
+/**
+ * nand_stream_write:
+ *
+ * Append data to the stream. Data is only buffered here unless the
+ * buffer is full; nand_stream_flush() does the programming.
+ *
+ * @return		0 in case of success
+ */
+int nand_stream_write(struct nand_stream *ns, const u_char *buf, size_t len)
+{
+	size_t n;
+	int ret;
+
+	while (len) {
+		if (ns->fill == 2 * ns->nand->erasesize) {
+			ret = nand_stream_flush(ns, 0);
+			if (ret)
+				return ret;
+		}
+
+		n = 2 * ns->nand->erasesize - ns->fill;
+		if (n > len)
+			n = len;
+
+		memcpy(ns->buf + ns->fill, buf, n);
+		ns->crc = crc32(ns->crc, buf, n);
+		ns->fill += n;
+		ns->total += n;
+		buf += n;
+		len -= n;
+	}
+
+	return 0;
+}
+
+/**
+ * nand_stream_flush:
+ *
+ * Program all complete blocks in the buffer. With final set, the last
+ * partial block is padded with 0xff to a page boundary and programmed
+ * as well.
+ *
+ * @return		0 in case of success
+ */
+int nand_stream_flush(struct nand_stream *ns, int final)
+{
+	size_t erasesize = ns->nand->erasesize;
+	size_t len;
+	int ret;
+
+	while (ns->fill >= erasesize || (final && ns->fill)) {
+		len = erasesize;
+		if (ns->fill < len) {
+			len = ALIGN(ns->fill, ns->nand->writesize);
+			memset(ns->buf + ns->fill, 0xff, len - ns->fill);
+		}
+
+		ret = nand_stream_block(ns, len);
+		if (ret)
+			return ret;
+
+		ns->fill -= len < ns->fill ? len : ns->fill;
+		memmove(ns->buf, ns->buf + len, ns->fill);
+	}
+
+	return 0;
+}
+
+/**
+ * nand_stream_verify:
+ *
+ * Read back everything written to the stream and compare its CRC32
+ * with the one of the data that was handed in.
+ *
+ * @return		0 if the flash contents match
+ */
+int nand_stream_verify(struct nand_stream *ns)
+{
+	nand_info_t *nand = ns->nand;
+	loff_t off = ns->start;
+	size_t left = ns->total;
+	uint32_t crc = 0;
+	size_t n;
+	int ret;
+
+	while (left) {
+		if (off >= ns->end)
+			return -ENOSPC;
+
+		if (nand_block_isbad(nand, off)) {
+			off += nand->erasesize;
+			continue;
+		}
+
+		n = left < nand->erasesize ? left : nand->erasesize;
+		ret = nand_read(nand, off, &n, ns->buf);
+		if (ret && ret != -EUCLEAN) {
+			printf("NAND read from offset %llx failed %d\n",
+			       off, ret);
+			return ret;
+		}
+
+		crc = crc32(crc, ns->buf, n);
+		off += nand->erasesize;
+		left -= n;
+	}
+
+	if (crc != ns->crc) {
+		printf("NAND stream: CRC mismatch, wrote %08x, read %08x\n",
+		       ns->crc, crc);
+		return -EIO;
+	}
+
+	return 0;
+}
+#endif /* CONFIG_CMD_NAND_TFTP */
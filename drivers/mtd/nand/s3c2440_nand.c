@@ -21,6 +21,7 @@
 #include <common.h>
 
 #include <nand.h>
+#include <linux/mtd/nand_bch.h>
 #include <asm/arch/s3c24x0_cpu.h>
 #include <asm/io.h>
 
@@ -174,6 +175,10 @@ int board_nand_init(struct nand_chip *nand)
 	nand->ecc.mode = NAND_ECC_HW;
 	nand->ecc.size = CONFIG_SYS_NAND_ECCSIZE;
 	nand->ecc.bytes = CONFIG_SYS_NAND_ECCBYTES;
+#elif defined(CONFIG_NAND_ECC_BCH)
+	nand->ecc.mode = NAND_ECC_SOFT_BCH;
+	nand->ecc.size = 512;
+	nand->ecc.bytes = NAND_BCH_ECCBYTES(CONFIG_NAND_BCH_T);
 #else
 	nand->ecc.mode = NAND_ECC_NONE;	//NAND_ECC_SOFT;
 #endif
@@ -91,14 +91,181 @@ DECLARE_GLOBAL_DATA_PTR;
 static int hwflow;
 #endif
 
+/* UFSTAT: Tx FIFO full (64 byte FIFO on the S3C2440, 16 byte otherwise) */
+#ifdef CONFIG_S3C2440
+#define UFSTAT_TXFULL	(1 << 14)
+#else
+#define UFSTAT_TXFULL	(1 << 9)
+#endif
+
+#ifdef CONFIG_SYS_S3C24X0_SERIAL_TXBUF
+#define TXBUF_SIZE	CONFIG_SYS_S3C24X0_SERIAL_TXBUF
+#if TXBUF_SIZE & (TXBUF_SIZE - 1)
+#error "CONFIG_SYS_S3C24X0_SERIAL_TXBUF must be a power of two"
+#endif
+
+/*
+ * Software Tx ring in front of the FIFO, so printing does not wait for
+ * the line. It is drained whenever the driver is called, tstc() being
+ * polled while U-Boot waits for input.
+ */
+static struct {
+	char		buf[TXBUF_SIZE];
+	unsigned int	head;		/* free running, masked on access */
+	unsigned int	tail;
+} txbuf[3];
+#endif
+
+#ifdef CONFIG_SYS_S3C24X0_SERIAL_RXDMA
+#define RXDMA_SIZE	CONFIG_SYS_S3C24X0_SERIAL_RXDMA
+#if RXDMA_SIZE & (RXDMA_SIZE - 1) || RXDMA_SIZE >= (1 << 20)
+#error "CONFIG_SYS_S3C24X0_SERIAL_RXDMA must be a power of two below 1 MiB"
+#endif
+#ifndef CONFIG_S3C2440
+#error "CONFIG_SYS_S3C24X0_SERIAL_RXDMA is only supported on the S3C2440"
+#endif
+
+/*
+ * Rx ring for the console UART, filled by a DMA channel in auto reload
+ * mode: received bytes keep landing in memory while a loader is busy
+ * writing flash or checking a packet, instead of overrunning the FIFO.
+ * The write position is the channel's current destination address.
+ * There is no MMU, hence no data cache to keep coherent.
+ */
+static volatile unsigned char rxbuf[RXDMA_SIZE] __attribute__((aligned(4)));
+static unsigned int rxtail;
+static int rxdma_dev = -1;
+
+/* DMA channel, its request source and the UCON Rx mode for UART0..2 */
+static const unsigned char rxdma_chan[3] = { 0, 1, 3 };
+static const unsigned char rxdma_src[3] = { 1, 1, 0 };
+static const unsigned char rxdma_mode[3] = { 2, 3, 2 };
+
+static struct s3c24x0_dma *serial_rxdma(const int dev_index)
+{
+	return &s3c24x0_get_base_dmas()->dma[rxdma_chan[dev_index]];
+}
+
+/* Stop the Rx DMA, the kernel must not find it writing into memory */
+void s3c24x0_serial_rxdma_stop(void)
+{
+	struct s3c24x0_dma *dma;
+	struct s3c24x0_uart *uart;
+
+	if (rxdma_dev < 0)
+		return;
+
+	dma = serial_rxdma(rxdma_dev);
+	uart = s3c24x0_get_base_uart(rxdma_dev);
+
+	/* back to polled receive first, then stop the channel */
+	writel((readl(&uart->UCON) & ~0x3) | 0x1, &uart->UCON);
+	writel(0x4, &dma->DMASKTRIG);
+	while (readl(&dma->DMASKTRIG) & 0x2)
+		/* wait for the channel to turn off */ ;
+
+	rxdma_dev = -1;
+}
+
+static void serial_rxdma_start(const int dev_index)
+{
+	struct s3c24x0_dma *dma = serial_rxdma(dev_index);
+	struct s3c24x0_uart *uart = s3c24x0_get_base_uart(dev_index);
+
+	s3c24x0_serial_rxdma_stop();
+
+	writel((ulong)&uart->URXH, &dma->DISRC);
+	writel(0x3, &dma->DISRCC);		/* APB, fixed address */
+	writel((ulong)rxbuf, &dma->DIDST);
+	writel(0x0, &dma->DIDSTC);		/* AHB, incrementing */
+	/* handshake, single unit, single service, hw request, auto reload */
+	writel((1 << 31) | (rxdma_src[dev_index] << 24) | (1 << 23) |
+	       RXDMA_SIZE, &dma->DCON);
+	writel(0x2, &dma->DMASKTRIG);		/* channel on */
+
+	rxtail = 0;
+	rxdma_dev = dev_index;
+
+	/* the Rx FIFO trigger level is 1 byte, request DMA for each one */
+	writel((readl(&uart->UCON) & ~0x3) | rxdma_mode[dev_index],
+	       &uart->UCON);
+}
+
+/* ring index the DMA writes next */
+static unsigned int serial_rxdma_head(const int dev_index)
+{
+	ulong pos = readl(&serial_rxdma(dev_index)->DCDST) - (ulong)rxbuf;
+
+	/* DCDST sits at the end of the ring until the reload */
+	return pos <= RXDMA_SIZE ? pos % RXDMA_SIZE : rxtail;
+}
+#endif
+
+/* room in the Tx FIFO and, with hardware flow control, CTS up */
+static int serial_tx_ready(struct s3c24x0_uart *uart)
+{
+	if (readl(&uart->UFSTAT) & UFSTAT_TXFULL)
+		return 0;
+#ifdef CONFIG_HWFLOW
+	if (hwflow && !(readl(&uart->UMSTAT) & 0x1))
+		return 0;
+#endif
+	return 1;
+}
+
+#ifdef CONFIG_SYS_S3C24X0_SERIAL_TXBUF
+static void serial_tx_drain(struct s3c24x0_uart *uart, const int dev_index)
+{
+	unsigned int tail = txbuf[dev_index].tail;
+
+	while (tail != txbuf[dev_index].head && serial_tx_ready(uart))
+		writeb(txbuf[dev_index].buf[tail++ % TXBUF_SIZE], &uart->UTXH);
+	txbuf[dev_index].tail = tail;
+}
+
+/* Wait until everything queued has left the UART */
+void s3c24x0_serial_flush(void)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(txbuf); i++) {
+		struct s3c24x0_uart *uart = s3c24x0_get_base_uart(i);
+
+		if (txbuf[i].head == txbuf[i].tail)
+			continue;
+		while (txbuf[i].head != txbuf[i].tail)
+			serial_tx_drain(uart, i);
+		while (!(readl(&uart->UTRSTAT) & 0x4))
+			/* wait for the transmitter to be empty */ ;
+	}
+}
+
+void serial_flush(void)
+{
+	s3c24x0_serial_flush();
+}
+#else
+static inline void serial_tx_drain(struct s3c24x0_uart *uart,
+				   const int dev_index)
+{
+}
+#endif
+
 void _serial_setbrg(const int dev_index)
 {
 	struct s3c24x0_uart *uart = s3c24x0_get_base_uart(dev_index);
 	unsigned int reg = 0;
 	int i;
 
-	/* value is calculated so : (int)(PCLK/16./baudrate) -1 */
-	reg = get_PCLK() / (16 * gd->baudrate) - 1;
+#ifdef CONFIG_SYS_S3C24X0_SERIAL_TXBUF
+	s3c24x0_serial_flush();
+#endif
+
+	/*
+	 * value is calculated so : (int)(PCLK/16./baudrate + 0.5) - 1,
+	 * rounded: truncating is off by 5% at 230400 with PCLK 50 MHz
+	 */
+	reg = (get_PCLK() + 8 * gd->baudrate) / (16 * gd->baudrate) - 1;
 
 	writel(reg, &uart->UBRDIV);
 	for (i = 0; i < 100; i++)
@@ -153,6 +320,11 @@ static int serial_init_dev(const int dev_index)
 #endif
 	_serial_setbrg(dev_index);
 
+#ifdef CONFIG_SYS_S3C24X0_SERIAL_RXDMA
+	if (dev_index == UART_NR)
+		serial_rxdma_start(dev_index);
+#endif
+
 	return (0);
 }
 
@@ -175,8 +347,23 @@ int _serial_getc(const int dev_index)
 {
 	struct s3c24x0_uart *uart = s3c24x0_get_base_uart(dev_index);
 
+#ifdef CONFIG_SYS_S3C24X0_SERIAL_RXDMA
+	if (dev_index == rxdma_dev) {
+		int c;
+
+		while (serial_rxdma_head(dev_index) == rxtail)
+			/* wait for the DMA to bring a character */
+			serial_tx_drain(uart, dev_index);
+
+		c = rxbuf[rxtail];
+		rxtail = (rxtail + 1) % RXDMA_SIZE;
+		return c;
+	}
+#endif
+
 	while (!(readl(&uart->UTRSTAT) & 0x1))
-		/* wait for character to arrive */ ;
+		/* wait for character to arrive */
+		serial_tx_drain(uart, dev_index);
 
 	return readb(&uart->URXH) & 0xff;
 }
@@ -236,15 +423,19 @@ void _serial_putc(const char c, const int dev_index)
 		return;
 #endif
 
-	while (!(readl(&uart->UTRSTAT) & 0x2))
-		/* wait for room in the tx FIFO */ ;
+#ifdef CONFIG_SYS_S3C24X0_SERIAL_TXBUF
+	while (txbuf[dev_index].head - txbuf[dev_index].tail >= TXBUF_SIZE)
+		/* wait for room in the ring */
+		serial_tx_drain(uart, dev_index);
 
-#ifdef CONFIG_HWFLOW
-	while (hwflow && !(readl(&uart->UMSTAT) & 0x1))
-		/* Wait for CTS up */ ;
-#endif
+	txbuf[dev_index].buf[txbuf[dev_index].head++ % TXBUF_SIZE] = c;
+	serial_tx_drain(uart, dev_index);
+#else
+	while (!serial_tx_ready(uart))
+		/* wait for room in the tx FIFO and CTS up */ ;
 
 	writeb(c, &uart->UTXH);
+#endif
 
 	/* If \n, also do \r */
 	if (c == '\n')
@@ -271,6 +462,13 @@ int _serial_tstc(const int dev_index)
 {
 	struct s3c24x0_uart *uart = s3c24x0_get_base_uart(dev_index);
 
+	serial_tx_drain(uart, dev_index);
+
+#ifdef CONFIG_SYS_S3C24X0_SERIAL_RXDMA
+	if (dev_index == rxdma_dev)
+		return serial_rxdma_head(dev_index) != rxtail;
+#endif
+
 	return readl(&uart->UTRSTAT) & 0x1;
 }
 
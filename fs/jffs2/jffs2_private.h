@@ -90,7 +90,7 @@ static inline int
 data_crc(struct jffs2_raw_inode *node)
 {
 	if (node->data_crc != crc32_no_comp(0, (unsigned char *)
-					    ((int) &node->node_crc + sizeof (node->node_crc)),
+					    ((ulong) &node->node_crc + sizeof (node->node_crc)),
 					     node->csize)) {
 		return 0;
 	} else {
@@ -16,6 +16,7 @@
 /* XXX U-BOOT XXX */
 #include <common.h>
 #include "asm/errno.h"
+#include <malloc.h>
 
 const char *yaffs_mtdif2_c_version =
     "$Id: yaffs_mtdif2.c,v 1.17 2007/02/14 01:09:06 wookey Exp $";
@@ -23,6 +24,7 @@ const char *yaffs_mtdif2_c_version =
 #include "yportenv.h"
 
 
+#include "yaffs_mtdif.h"
 #include "yaffs_mtdif2.h"
 
 #include "linux/mtd/mtd.h"
@@ -31,6 +33,101 @@ const char *yaffs_mtdif2_c_version =
 
 #include "yaffs_packedtags2.h"
 
+#if (LINUX_VERSION_CODE > KERNEL_VERSION(2,6,17))
+/*
+ * Bulk tag reads: mounting without a checkpoint reads the tags of every
+ * chunk, one OOB read command per chunk. While enabled, the OOB of a
+ * whole erase block is read in one go and the tags are served from that.
+ */
+static struct {
+	yaffs_Device *dev;
+	int block;		/* block held in buf, -1 if none */
+	int stride;		/* free OOB bytes per chunk */
+	__u8 *buf;
+} tagCache = { NULL, -1, 0, NULL };
+
+static void nandmtd2_InvalidateTags(yaffs_Device * dev, int blockNo)
+{
+	if (tagCache.dev == dev &&
+	    (blockNo < 0 || tagCache.block == blockNo))
+		tagCache.block = -1;
+}
+
+int nandmtd2_BulkTags(yaffs_Device * dev, int enable)
+{
+	struct mtd_info *mtd = (struct mtd_info *)(dev->genericDevice);
+
+	if (tagCache.buf) {
+		YFREE(tagCache.buf);
+		tagCache.buf = NULL;
+	}
+	tagCache.dev = NULL;
+	tagCache.block = -1;
+
+	if (!enable)
+		return 0;
+
+	/* tags straddling two pages can't be read per block */
+	tagCache.stride = mtd->ecclayout->oobavail;
+	if (tagCache.stride < sizeof(yaffs_PackedTags2))
+		return 0;
+
+	tagCache.buf = YMALLOC(tagCache.stride * dev->nChunksPerBlock);
+	if (!tagCache.buf)
+		return 0;
+
+	tagCache.dev = dev;
+	return 1;
+}
+
+static int nandmtd2_ReadCachedTags(yaffs_Device * dev, int chunkInNAND,
+				   yaffs_ExtendedTags * tags)
+{
+	struct mtd_info *mtd = (struct mtd_info *)(dev->genericDevice);
+	int blockNo = chunkInNAND / dev->nChunksPerBlock;
+	yaffs_PackedTags2 pt;
+
+	if (tagCache.block != blockNo) {
+		struct mtd_oob_ops ops;
+		loff_t addr = ((loff_t) blockNo) * dev->nChunksPerBlock *
+			dev->nDataBytesPerChunk;
+
+		/*
+		 * Block queries and the checkpoint search only look at the
+		 * first chunk of each block, the scan starts at the last one.
+		 */
+		if (chunkInNAND % dev->nChunksPerBlock == 0)
+			return 0;
+
+		ops.mode = MTD_OOB_AUTO;
+		ops.ooblen = tagCache.stride * dev->nChunksPerBlock;
+		ops.len = 0;
+		ops.ooboffs = 0;
+		ops.datbuf = NULL;
+		ops.oobbuf = tagCache.buf;
+		if (mtd->read_oob(mtd, addr, &ops))
+			return 0;
+		tagCache.block = blockNo;
+	}
+
+	memcpy(&pt, tagCache.buf +
+	       (chunkInNAND % dev->nChunksPerBlock) * tagCache.stride,
+	       sizeof(pt));
+	yaffs_UnpackTags2(tags, &pt);
+
+	return 1;
+}
+#else
+static void nandmtd2_InvalidateTags(yaffs_Device * dev, int blockNo)
+{
+}
+
+int nandmtd2_BulkTags(yaffs_Device * dev, int enable)
+{
+	return 0;
+}
+#endif
+
 int nandmtd2_WriteChunkWithTagsToNAND(yaffs_Device * dev, int chunkInNAND,
 				      const __u8 * data,
 				      const yaffs_ExtendedTags * tags)
@@ -52,6 +149,8 @@ int nandmtd2_WriteChunkWithTagsToNAND(yaffs_Device * dev, int chunkInNAND,
 	   ("nandmtd2_WriteChunkWithTagsToNAND chunk %d data %p tags %p"
 	    TENDSTR), chunkInNAND, data, tags));
 
+	nandmtd2_InvalidateTags(dev, chunkInNAND / dev->nChunksPerBlock);
+
 #if (LINUX_VERSION_CODE > KERNEL_VERSION(2,6,17))
 	if (tags)
 		yaffs_PackTags2(&pt, tags);
@@ -121,6 +220,10 @@ int nandmtd2_ReadChunkWithTagsFromNAND(yaffs_Device * dev, int chunkInNAND,
 	    TENDSTR), chunkInNAND, data, tags));
 
 #if (LINUX_VERSION_CODE > KERNEL_VERSION(2,6,17))
+	if (!data && tags && tagCache.dev == dev &&
+	    nandmtd2_ReadCachedTags(dev, chunkInNAND, tags))
+		return YAFFS_OK;
+
 	if (data && !tags)
 		retval = mtd->read(mtd, addr, dev->nDataBytesPerChunk,
 				&dummy, data);
@@ -179,6 +282,8 @@ int nandmtd2_MarkNANDBlockBad(struct yaffs_DeviceStruct *dev, int blockNo)
 	T(YAFFS_TRACE_MTD,
 	  (TSTR("nandmtd2_MarkNANDBlockBad %d" TENDSTR), blockNo));
 
+	nandmtd2_InvalidateTags(dev, blockNo);
+
 	retval =
 	    mtd->block_markbad(mtd,
 			       blockNo * dev->nChunksPerBlock *
@@ -233,3 +338,10 @@ int nandmtd2_QueryNANDBlock(struct yaffs_DeviceStruct *dev, int blockNo,
 	else
 		return YAFFS_FAIL;
 }
+
+int nandmtd2_EraseBlockInNAND(yaffs_Device * dev, int blockNumber)
+{
+	nandmtd2_InvalidateTags(dev, blockNumber);
+
+	return nandmtd_EraseBlockInNAND(dev, blockNumber);
+}
@@ -25,5 +25,7 @@ int nandmtd2_ReadChunkWithTagsFromNAND(yaffs_Device * dev, int chunkInNAND,
 int nandmtd2_MarkNANDBlockBad(struct yaffs_DeviceStruct *dev, int blockNo);
 int nandmtd2_QueryNANDBlock(struct yaffs_DeviceStruct *dev, int blockNo,
 			    yaffs_BlockState * state, int *sequenceNumber);
+int nandmtd2_EraseBlockInNAND(yaffs_Device * dev, int blockNumber);
+int nandmtd2_BulkTags(yaffs_Device * dev, int enable);
 
 #endif
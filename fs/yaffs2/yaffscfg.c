@@ -117,8 +117,15 @@ int yaffs_StartUp(void)
 	struct mtd_info *mtd = &nand_info[0];
 	int yaffsVersion = 2;
 	int nBlocks;
+	yaffs_Device *flashDev;
 
-	yaffs_Device *flashDev = calloc(1, sizeof(yaffs_Device));
+	/* the device and its checkpoint state live across mounts */
+	if (yaffsfs_config[0].dev)
+		return 0;
+
+	flashDev = calloc(1, sizeof(yaffs_Device));
+	if (!flashDev)
+		return -1;
 	yaffsfs_config[0].dev = flashDev;
 
 	/* store the mtd device for later use */
@@ -173,6 +180,7 @@ int yaffs_StartUp(void)
 		flashDev->readChunkWithTagsFromNAND = nandmtd2_ReadChunkWithTagsFromNAND;
 		flashDev->markNANDBlockBad = nandmtd2_MarkNANDBlockBad;
 		flashDev->queryNANDBlock = nandmtd2_QueryNANDBlock;
+		flashDev->eraseBlockInNAND = nandmtd2_EraseBlockInNAND;
 		flashDev->spareBuffer = YMALLOC(mtd->oobsize);
 		flashDev->isYaffs2 = 1;
 #if (LINUX_VERSION_CODE > KERNEL_VERSION(2,6,17))
@@ -192,6 +200,7 @@ int yaffs_StartUp(void)
 	{
 		flashDev->writeChunkToNAND = nandmtd_WriteChunkToNAND;
 		flashDev->readChunkFromNAND = nandmtd_ReadChunkFromNAND;
+		flashDev->eraseBlockInNAND = nandmtd_EraseBlockInNAND;
 		flashDev->isYaffs2 = 0;
 		nBlocks = mtd->size / (YAFFS_CHUNKS_PER_BLOCK * YAFFS_BYTES_PER_CHUNK);
 		flashDev->startBlock = 320;
@@ -201,7 +210,6 @@ int yaffs_StartUp(void)
 	}
 
 	/* ... and common functions */
-	flashDev->eraseBlockInNAND = nandmtd_EraseBlockInNAND;
 	flashDev->initialiseNAND = nandmtd_InitialiseNAND;
 
 	yaffs_initialise(yaffsfs_config);
@@ -267,14 +275,66 @@ void read_a_file(char *fn)
 
 void cmd_yaffs_mount(char *mp)
 {
-	yaffs_StartUp();
-	int retval = yaffs_mount(mp);
-	if( retval != -1)
+	yaffs_Device *dev;
+	ulong start;
+	int retval;
+
+	if (yaffs_StartUp()) {
+		printf("Error mounting %s: out of memory\n", mp);
+		return;
+	}
+	dev = yaffsfs_config[0].dev;
+
+	start = get_timer(0);
+	nandmtd2_BulkTags(dev, dev->isYaffs2);
+	retval = yaffs_mount(mp);
+	nandmtd2_BulkTags(dev, 0);
+	start = get_timer(start);
+
+	if( retval != -1) {
 		isMounted = 1;
-	else
+		printf("Mounted %s in %lu ms (%s)\n", mp,
+		       start * 1000 / CONFIG_SYS_HZ,
+		       dev->isCheckpointed ? "checkpoint" : "full scan");
+	} else
 		printf("Error mounting %s, return value: %d\n", mp, yaffsfs_GetError());
 }
 
+/*
+ * Leave a checkpoint behind after every change: the board is usually
+ * reset rather than unmounted, and without one the next mount has to
+ * scan the tags of every chunk.
+ */
+static void checkpoint(void)
+{
+	yaffs_Device *dev = yaffsfs_config[0].dev;
+
+	if (!isMounted || !dev->isYaffs2)
+		return;
+
+	yaffs_FlushEntireDeviceCache(dev);
+	yaffs_CheckpointSave(dev);
+}
+
+/*
+ * Forget the device without writing anything to the chip, as a reset
+ * does: the next mount starts again from what is on the chip. The old
+ * device is not freed. For test/nand_test.
+ */
+void cmd_yaffs_drop(void)
+{
+	yaffsfs_config[0].dev = NULL;
+	isMounted = 0;
+}
+
+/* Whether the device was mounted from, or has since saved, a checkpoint */
+int cmd_yaffs_checkpointed(void)
+{
+	yaffs_Device *dev = yaffsfs_config[0].dev;
+
+	return isMounted && dev->isCheckpointed;
+}
+
 static void checkMount(void)
 {
 	if( !isMounted )
@@ -288,12 +348,15 @@ void cmd_yaffs_umount(char *mp)
 	checkMount();
 	if( yaffs_unmount(mp) == -1)
 		printf("Error umounting %s, return value: %d\n", mp, yaffsfs_GetError());
+	else
+		isMounted = 0;
 }
 
 void cmd_yaffs_write_file(char *yaffsName,char bval,int sizeOfFile)
 {
 	checkMount();
 	make_a_file(yaffsName,bval,sizeOfFile);
+	checkpoint();
 }
 
 
@@ -342,6 +405,7 @@ void cmd_yaffs_mwrite_file(char *fn, char *addr, int size)
 	yaffs_write(outh,addr,size);
 
 	yaffs_close(outh);
+	checkpoint();
 }
 
 
@@ -387,6 +451,8 @@ void cmd_yaffs_mkdir(const char *dir)
 
 	if ( retval < 0)
 		printf("yaffs_mkdir returning error: %d\n", retval);
+	else
+		checkpoint();
 }
 
 void cmd_yaffs_rmdir(const char *dir)
@@ -397,6 +463,8 @@ void cmd_yaffs_rmdir(const char *dir)
 
 	if ( retval < 0)
 		printf("yaffs_rmdir returning error: %d\n", retval);
+	else
+		checkpoint();
 }
 
 void cmd_yaffs_rm(const char *path)
@@ -407,6 +475,8 @@ void cmd_yaffs_rm(const char *path)
 
 	if ( retval < 0)
 		printf("yaffs_unlink returning error: %d\n", retval);
+	else
+		checkpoint();
 }
 
 void cmd_yaffs_mv(const char *oldPath, const char *newPath)
@@ -417,4 +487,6 @@ void cmd_yaffs_mv(const char *oldPath, const char *newPath)
 
 	if ( retval < 0)
 		printf("yaffs_unlink returning error: %d\n", retval);
+	else
+		checkpoint();
 }
@@ -27,3 +27,7 @@
 #else
 	#error Please define the s3c24x0 cpu type
 #endif
+
+/* drivers/serial/serial_s3c24x0.c */
+void s3c24x0_serial_flush(void);
+void s3c24x0_serial_rxdma_stop(void);
@@ -205,6 +205,20 @@ struct tag_memclk {
 	u32 fmemclk;
 };
 
+/* U-Boot boot stage time stamps, see include/bootstage.h */
+#define ATAG_BOOTSTAGE	0x41000403
+
+struct tag_bootstage_rec {
+	u32 time_us;		/* microseconds since the first stage */
+	u32 addr;		/* optional address, 0 if unused */
+	char name[16];		/* NUL terminated unless all 16 are used */
+};
+
+struct tag_bootstage {
+	u32 count;
+	struct tag_bootstage_rec rec[1];	/* count entries */
+};
+
 struct tag {
 	struct tag_header hdr;
 	union {
@@ -227,6 +241,11 @@ struct tag {
 		 * DC21285 specific
 		 */
 		struct tag_memclk	memclk;
+
+		/*
+		 * U-Boot boot stage time stamps
+		 */
+		struct tag_bootstage	bootstage;
 	} u;
 };
 
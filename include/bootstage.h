@@ -0,0 +1,110 @@
+/*
+ * Boot stage time stamps
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * Boot stage time stamps.
+ *
+ * bootstage_mark() records the current time under a name; the table
+ * can be printed with the "bootstage" command and is handed to Linux
+ * in an ATAG_BOOTSTAGE node.  All times are microseconds since the
+ * first recorded stage (the NAND SPL start when CONFIG_BOOTSTAGE_SPL
+ * is set, otherwise timer_init()).
+ */
+#ifndef _BOOTSTAGE_H_
+#define _BOOTSTAGE_H_
+
+#ifndef CONFIG_BOOTSTAGE_MAX
+#define CONFIG_BOOTSTAGE_MAX	32
+#endif
+
+#define BOOTSTAGE_NAME_LEN	16
+
+struct bootstage_record {
+	const char	*name;
+	ulong		addr;		/* optional, e.g. an init function */
+	ulong		time_us;
+};
+
+/*
+ * Stages recorded by the NAND SPL.  The SPL has neither malloc nor
+ * room for strings, so it only stores raw timer ticks in a small
+ * block at CONFIG_BOOTSTAGE_SPL_STASH which U-Boot converts early
+ * in board_init(), while the PLL still runs at the SPL setting.
+ */
+enum bootstage_spl_id {
+	BOOTSTAGE_SPL_START,
+	BOOTSTAGE_SPL_UBOOT_LOADED,
+	BOOTSTAGE_SPL_ENV_LOADED,
+	BOOTSTAGE_SPL_JUMP,
+
+	BOOTSTAGE_SPL_COUNT
+};
+
+#define BOOTSTAGE_SPL_MAGIC	0x42535450	/* "BSTP" */
+
+struct bootstage_spl_stash {
+	uint32_t	magic;
+	uint32_t	valid;			/* bit n set: time[n] recorded */
+	uint32_t	last;			/* last timer count seen */
+	uint32_t	ticks;			/* ticks accumulated so far */
+	uint32_t	time[BOOTSTAGE_SPL_COUNT];
+};
+
+#ifdef CONFIG_BOOTSTAGE
+
+ulong bootstage_mark(const char *name);
+ulong bootstage_mark_addr(const char *name, ulong addr);
+ulong bootstage_add_record(const char *name, ulong addr, ulong time_us);
+void bootstage_set_base(ulong time_us);
+const struct bootstage_record *bootstage_get_records(int *count);
+void bootstage_report(void);
+
+/* supplied by the CPU timer code, microseconds since timer_init() */
+ulong timer_get_boot_us(void);
+
+#else
+
+static inline ulong bootstage_mark(const char *name)
+{
+	return 0;
+}
+
+static inline ulong bootstage_mark_addr(const char *name, ulong addr)
+{
+	return 0;
+}
+
+#endif /* CONFIG_BOOTSTAGE */
+
+#ifdef CONFIG_BOOTSTAGE_SPL
+void bootstage_spl_start(void);
+void bootstage_spl_mark(int id);
+void bootstage_spl_poll(void);
+void bootstage_spl_import(void);
+#else
+#define bootstage_spl_start()
+#define bootstage_spl_mark(id)
+#define bootstage_spl_poll()
+#define bootstage_spl_import()
+#endif
+
+#endif /* _BOOTSTAGE_H_ */
@@ -477,6 +477,7 @@ void	serial_putc_raw(const char);
 void	serial_puts   (const char *);
 int	serial_getc   (void);
 int	serial_tstc   (void);
+void	serial_flush  (void);
 
 void	_serial_setbrg (const int);
 void	_serial_putc   (const char, const int);
@@ -634,6 +635,7 @@ static inline IPaddr_t getenv_IPaddr (char *var)
 
 /* lib_generic/time.c */
 void	udelay        (unsigned long);
+void	ndelay        (unsigned long);
 
 /* lib_generic/vsprintf.c */
 ulong	simple_strtoul(const char *cp,char **endp,unsigned int base);
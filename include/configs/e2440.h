@@ -85,9 +85,12 @@
  */
 #define CONFIG_S3C24X0_SERIAL
 #define CONFIG_SERIAL1          1	/* we use SERIAL 1 on e2440 */
+#define CONFIG_SYS_S3C24X0_SERIAL_TXBUF	2048	/* don't wait for the line */
+#define CONFIG_SYS_S3C24X0_SERIAL_RXDMA	16384	/* DMA fed Rx ring */
 #define CONFIG_BAUDRATE		115200
 /* valid baudrates */
-#define CONFIG_SYS_BAUDRATE_TABLE	{ 9600, 19200, 38400, 57600, 115200 }
+#define CONFIG_SYS_BAUDRATE_TABLE	{ 9600, 19200, 38400, 57600, 115200, \
+					  230400, 460800 }
 
 /*
  * MMC support
@@ -104,13 +107,46 @@
 #define CONFIG_SYS_MAX_NAND_DEVICE		1	/* Max number of NAND devices */
 #define CONFIG_SYS_NAND_BASE 	0x4e000010
 
+#define CONFIG_NAND_BBT_LAZY		/* read bad block markers on demand */
+#define CONFIG_SPARSE_IMAGE		/* nand/mmc write.sparse */
+#define CONFIG_CMD_NAND_TFTP		/* nand tftp, no RAM staging */
+
+/* the K9F1208 has no cache program/read nor a known two-plane sequence */
+//#define CONFIG_SYS_NAND_CACHEPRG
+//#define CONFIG_SYS_NAND_MULTIPLANE
+//#define CONFIG_SYS_NAND_READCACHE
 //#define CONFIG_S3C2440_NAND_HWECC
+/*
+ * Software BCH, t bit errors per 512 bytes.  Changes the OOB layout,
+ * so the flash has to be rewritten when switching.
+ */
+//#define CONFIG_NAND_ECC_BCH
+//#define CONFIG_BCH
+//#define CONFIG_NAND_BCH_T		4
 
 #ifdef CONFIG_S3C2440_NAND_HWECC
 #define CONFIG_SYS_NAND_ECCSIZE 	256		//??
 #define CONFIG_SYS_NAND_ECCBYTES    3		//??
 #endif
 
+/*
+ * LZMA compressed kernels; 16-bit probabilities fit the 16KB D-cache better
+ */
+#define CONFIG_LZMA
+#define CONFIG_LZMA_PROB16
+
+/*
+ * Word-at-a-time match copies in inflate_fast() (gzip images)
+ */
+#define CONFIG_ZLIB_WORD_COPY
+
+/*
+ * Use the word oriented hash block functions (FIT image verification)
+ */
+#define CONFIG_SHA1_FAST
+#define CONFIG_SHA256_FAST
+#define CONFIG_MD5_FAST
+
 /************************************************************
  * RTC
  ************************************************************/
@@ -154,6 +190,12 @@
 #define	CONFIG_SYS_MAXARGS		16		/* max number of command args	*/
 #define CONFIG_SYS_BARGSIZE		CONFIG_SYS_CBSIZE	/* Boot Argument Buffer Size	*/
 
+//#define CONFIG_SYS_HUSH_PARSER
+#ifdef CONFIG_SYS_HUSH_PARSER
+#  define CONFIG_SYS_PROMPT_HUSH_PS2	"> "
+#  define CONFIG_SYS_HUSH_PARSE_CACHE	8	/* parsed scripts kept	*/
+#endif
+
 #define CONFIG_SYS_MEMTEST_START	0x30000000	/* memtest works on	*/
 #define CONFIG_SYS_MEMTEST_END		0x33F00000	/* 63 MB in DRAM	*/
 
@@ -223,14 +265,24 @@
 #define CONFIG_SETUP_MEMORY_TAGS
 #define CONFIG_BOOTARGS     "console=ttySAC0,115200n8 root=/dev/nfs rw nfsroot=172.16.17.152:/nfsboot ip=dhcp rdinit=/linuxrc"
 
+/*
+ * Boot time stamps; the SPL keeps its ticks just below the ECC scratch area
+ */
+#define CONFIG_BOOTSTAGE
+#define CONFIG_BOOTSTAGE_SPL
+#define CONFIG_BOOTSTAGE_SPL_STASH		(CONFIG_SYS_SDRAM_BASE + 0xf000)
+
 /*
  * U-BOOT commands
  */
 #define CONFIG_CMD_LOADB
+#define CONFIG_CMD_MBENCH
 #define CONFIG_CMD_MEMORY
 #define CONFIG_CMD_SAVEENV
 
 #define CONFIG_CMD_RUN
+#define CONFIG_CMD_BOOTSTAGE
+#define CONFIG_CMD_TIME
 
 #define CONFIG_CMD_NFS
 #define CONFIG_CMD_PING
@@ -249,6 +301,13 @@
 #  define CONFIG_DOS_PARTITION
 #endif
 
+//#define CONFIG_CMD_USB
+#ifdef CONFIG_CMD_USB
+#  define CONFIG_USB_OHCI
+#  define CONFIG_USB_STORAGE
+#  define CONFIG_SYS_USB_MAX_XFER_BLK	256	/* 128 KiB per READ(10) */
+#endif
+
 #ifdef CONFIG_CMD_UBI
 #  define CONFIG_CMD_MTDPARTS
 #  define CONFIG_MTD_DEVICE
@@ -79,6 +79,12 @@ void ft_pci_setup(void *blob, bd_t *bd);
 void set_working_fdt_addr(void *addr);
 int fdt_resize(void *blob);
 
+#ifdef CONFIG_OF_LIBFDT_INDEX
+void fdt_index_blob(void *blob);
+#else
+static inline void fdt_index_blob(void *blob) {}
+#endif
+
 int fdt_fixup_nor_flash_size(void *blob, int cs, u32 size);
 
 #endif /* ifdef CONFIG_OF_LIBFDT */
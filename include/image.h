@@ -48,6 +48,11 @@
 #include <asm/u-boot.h>
 #include <command.h>
 
+/* Largest image bootm (or nand read.lzma) will uncompress */
+#ifndef CONFIG_SYS_BOOTM_LEN
+#define CONFIG_SYS_BOOTM_LEN	0x800000	/* use 8MByte as default max gunzip size */
+#endif
+
 #endif /* USE_HOSTCC */
 
 #if defined(CONFIG_FIT)
@@ -609,6 +614,9 @@ int fit_image_hash_get_algo (const void *fit, int noffset, char **algo);
 int fit_image_hash_get_value (const void *fit, int noffset, uint8_t **value,
 				int *value_len);
 
+int calculate_hash (const void *data, int data_len, const char *algo,
+			uint8_t *value, int *value_len);
+
 int fit_set_timestamp (void *fit, int noffset, time_t timestamp);
 int fit_set_hashes (void *fit);
 int fit_image_set_hashes (void *fit, int image_noffset);
@@ -713,6 +713,59 @@ int fdt_node_check_compatible(const void *fdt, int nodeoffset,
 int fdt_node_offset_by_compatible(const void *fdt, int startoffset,
 				  const char *compatible);
 
+/**********************************************************************/
+/* Lookup index                                                       */
+/**********************************************************************/
+
+/**
+ * fdt_index_size - buffer size needed to index a device tree
+ * @fdt: pointer to the device tree blob
+ *
+ * Leave some room on top if nodes will be added later; an index that
+ * outgrows its buffer is no longer used.
+ *
+ * returns:
+ *	buffer size in bytes, on success
+ *	-FDT_ERR_BADMAGIC,
+ *	-FDT_ERR_BADVERSION,
+ *	-FDT_ERR_BADSTATE,
+ *	-FDT_ERR_BADSTRUCTURE,
+ *	-FDT_ERR_TRUNCATED, standard meanings
+ */
+int fdt_index_size(const void *fdt);
+
+/**
+ * fdt_index_attach - index a device tree for faster lookups
+ * @fdt: pointer to the device tree blob
+ * @buf: buffer for the index, kept until fdt_index_detach()
+ * @bufsize: size of buf, see fdt_index_size()
+ *
+ * fdt_index_attach() walks the tree once and records every node, so
+ * that fdt_subnode_offset(), fdt_path_offset(),
+ * fdt_node_offset_by_phandle() and fdt_node_offset_by_compatible() on
+ * this blob no longer scan the whole tree. Only one blob is indexed at
+ * a time, attaching another one replaces the index. The read-write
+ * functions keep the index up to date; it is ignored for any other
+ * blob and rebuilt if the tree at fdt was replaced behind its back.
+ *
+ * returns:
+ *	0, on success
+ *	-FDT_ERR_NOSPACE, bufsize is too small for the tree
+ *	-FDT_ERR_BADMAGIC,
+ *	-FDT_ERR_BADVERSION,
+ *	-FDT_ERR_BADSTATE,
+ *	-FDT_ERR_BADSTRUCTURE,
+ *	-FDT_ERR_TRUNCATED, standard meanings
+ */
+int fdt_index_attach(const void *fdt, void *buf, int bufsize);
+
+/**
+ * fdt_index_detach - stop using the lookup index
+ *
+ * The buffer passed to fdt_index_attach() may be freed afterwards.
+ */
+void fdt_index_detach(void);
+
 /**********************************************************************/
 /* Write-in-place functions                                           */
 /**********************************************************************/
@@ -0,0 +1,83 @@
+/*
+ * Binary BCH encoder/decoder
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * The interface follows the Linux BCH library (lib/bch.c, Copyright (C)
+ * 2011 Parrot S.A., author Ivan Djelic <ivan.djelic@parrot.com>), so
+ * that drivers/mtd/nand/nand_bch.c can be used as it is; the encoder
+ * and decoder in lib_generic/bch.c are a separate implementation.
+ */
+#ifndef _LINUX_BCH_H
+#define _LINUX_BCH_H
+
+/**
+ * struct bch_control - BCH control structure
+ * @m:		Galois field order, codewords are at most 2^m-1 bits
+ * @n:		maximum codeword length in bits (2^m-1)
+ * @t:		number of correctable bit errors
+ * @ecc_bits:	number of ecc bits (degree of the generator polynomial)
+ * @ecc_bytes:	number of ecc bytes, DIV_ROUND_UP(m*t, 8)
+ * @ecc_words:	number of 32 bit words holding the ecc bits
+ * @a_pow_tab:	Galois field power table, alpha^i
+ * @a_log_tab:	Galois field log table
+ * @mod_tab:	remainder table for byte-wise encoding
+ * @ecc_buf:	encoder/decoder scratch, ecc_words
+ * @syn:	2t syndromes
+ * @elp:	error locator polynomial work area, 3 * (2t + 1) entries
+ */
+struct bch_control {
+	unsigned int	m;
+	unsigned int	n;
+	unsigned int	t;
+	unsigned int	ecc_bits;
+	unsigned int	ecc_bytes;
+	unsigned int	ecc_words;
+	uint16_t	*a_pow_tab;
+	uint16_t	*a_log_tab;
+	uint32_t	*mod_tab;
+	uint32_t	*ecc_buf;
+	unsigned int	*syn;
+	unsigned int	*elp;
+};
+
+struct bch_control *init_bch(int m, int t, unsigned int prim_poly);
+void free_bch(struct bch_control *bch);
+
+/*
+ * Update ecc (ecc_bytes, must be zeroed by the caller for a new
+ * codeword) with len bytes of data.
+ */
+void encode_bch(struct bch_control *bch, const uint8_t *data,
+		unsigned int len, uint8_t *ecc);
+
+/*
+ * Locate the bit errors of a codeword.  calc_ecc may be NULL, it is
+ * then computed from data.  Returns the number of errors, stored in
+ * errloc[] as bit numbers (byte = errloc / 8, bit = errloc % 8, where
+ * errloc >= 8 * len points into the ecc bytes), or -EBADMSG if the
+ * codeword can not be corrected.
+ */
+int decode_bch(struct bch_control *bch, const uint8_t *data,
+	       unsigned int len, const uint8_t *recv_ecc,
+	       const uint8_t *calc_ecc, unsigned int *errloc);
+
+#endif /* _LINUX_BCH_H */
@@ -4,8 +4,6 @@
 #define __user
 #define __iomem
 
-#define ndelay(x)	udelay(1)
-
 #define printk	printf
 
 #define KERN_EMERG
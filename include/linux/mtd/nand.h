@@ -91,6 +91,10 @@ extern void nand_wait_ready(struct mtd_info *mtd);
 #define NAND_CMD_READSTART	0x30
 #define NAND_CMD_RNDOUTSTART	0xE0
 #define NAND_CMD_CACHEDPROG	0x15
+#define NAND_CMD_PLANEPROG	0x11
+#define NAND_CMD_PLANESEQIN	0x81
+#define NAND_CMD_READCACHESEQ	0x31
+#define NAND_CMD_READCACHEEND	0x3f
 
 /* Extended commands for AG-AND device */
 /*
@@ -129,6 +133,7 @@ typedef enum {
 	NAND_ECC_HW,
 	NAND_ECC_HW_SYNDROME,
 	NAND_ECC_HW_OOB_FIRST,
+	NAND_ECC_SOFT_BCH,
 } nand_ecc_modes_t;
 
 /*
@@ -174,6 +179,12 @@ typedef enum {
 #define NAND_NO_READRDY		0x00000100
 /* Chip does not allow subpage writes */
 #define NAND_NO_SUBPAGE_WRITE	0x00000200
+/* Chip programs a page in each of two adjacent blocks at once,
+ * Samsung style: 80h-data-11h, 81h-data-10h */
+#define NAND_MULTIPLANE		0x00000400
+/* Chip loads the next page while the current one is read out
+ * (31h, last page 3Fh) */
+#define NAND_CACHERD		0x00000800
 
 
 /* Options valid for Samsung large page devices */
@@ -185,6 +196,8 @@ typedef enum {
 #define NAND_MUST_PAD(chip) (!(chip->options & NAND_NO_PADDING))
 #define NAND_HAS_CACHEPROG(chip) ((chip->options & NAND_CACHEPRG))
 #define NAND_HAS_COPYBACK(chip) ((chip->options & NAND_COPYBACK))
+#define NAND_HAS_MULTIPLANE(chip) ((chip->options & NAND_MULTIPLANE))
+#define NAND_HAS_CACHERD(chip) ((chip->options & NAND_CACHERD))
 /* Large page NAND with SOFT_ECC should support subpage reads */
 #define NAND_SUBPAGE_READ(chip) ((chip->ecc.mode == NAND_ECC_SOFT) \
 					&& (chip->page_shift > 9))
@@ -250,6 +263,7 @@ struct nand_hw_control {
  * @write_page:	function to write a page according to the ecc generator requirements
  * @read_oob:	function to read chip OOB data
  * @write_oob:	function to write chip OOB data
+ * @priv:	pointer to private ecc control data
  */
 struct nand_ecc_ctrl {
 	nand_ecc_modes_t	mode;
@@ -290,6 +304,7 @@ struct nand_ecc_ctrl {
 	int			(*write_oob)(struct mtd_info *mtd,
 					     struct nand_chip *chip,
 					     int page);
+	void			*priv;
 };
 
 /**
@@ -364,6 +379,7 @@ struct nand_buffers {
  * @errstat:		[OPTIONAL] hardware specific function to perform additional error status checks
  *			(determine if errors are correctable)
  * @write_page:		[REPLACEABLE] High-level page write function
+ * @cacheprg:		[INTERN] a cache program sequence is in progress
  */
 
 struct nand_chip {
@@ -405,6 +421,7 @@ struct nand_chip {
 	int		badblockpos;
 
 	int 		state;
+	int		cacheprg;
 
 	uint8_t		*oob_poi;
 	struct nand_hw_control  *controller;
@@ -470,13 +487,27 @@ struct nand_manufacturers {
 	char * name;
 };
 
+/**
+ * struct nand_chip_options - Options of a particular chip
+ * @mfr_id:	manufacturer ID code
+ * @dev_id:	device ID code
+ * @options:	added to the options from nand_flash_ids
+ */
+struct nand_chip_options {
+	int mfr_id;
+	int dev_id;
+	unsigned long options;
+};
+
 extern struct nand_flash_dev nand_flash_ids[];
 extern struct nand_manufacturers nand_manuf_ids[];
+extern struct nand_chip_options nand_chip_options[];
 
 extern int nand_scan_bbt(struct mtd_info *mtd, struct nand_bbt_descr *bd);
 extern int nand_update_bbt(struct mtd_info *mtd, loff_t offs);
 extern int nand_default_bbt(struct mtd_info *mtd);
 extern int nand_isbad_bbt(struct mtd_info *mtd, loff_t offs, int allowbbt);
+extern void nand_resolve_bbt(struct mtd_info *mtd, loff_t offs, int getchip);
 extern int nand_erase_nand(struct mtd_info *mtd, struct erase_info *instr,
 			   int allowbbt);
 extern int nand_do_read(struct mtd_info *mtd, loff_t from, size_t len,
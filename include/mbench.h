@@ -0,0 +1,44 @@
+/*
+ * Memory bandwidth and latency benchmark
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * The same code runs as the "mbench" command and as tools/mbench on
+ * the build host, so board numbers can be put next to host numbers.
+ * The caller supplies the clock.
+ */
+#ifndef _MBENCH_H_
+#define _MBENCH_H_
+
+/* Stride of the latency test, the ARM920T cache line size */
+#define MBENCH_STRIDE	32
+
+/* monotonic time in nanoseconds, provided by the caller */
+unsigned long long mbench_time_ns(void);
+
+/*
+ * Run all tests on size bytes at buf (copy uses both halves), each
+ * test repeated loops times, and print the results. Returns 0, or 1
+ * if the user interrupted the run.
+ */
+int mbench(void *buf, unsigned long size, unsigned int loops);
+
+#endif /* _MBENCH_H_ */
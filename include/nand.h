@@ -114,6 +114,29 @@ int nand_read_skip_bad(nand_info_t *nand, loff_t offset, size_t *length,
 int nand_write_skip_bad(nand_info_t *nand, loff_t offset, size_t *length,
 			u_char *buffer);
 int nand_erase_opts(nand_info_t *meminfo, const nand_erase_options_t *opts);
+int nand_write_sparse(nand_info_t *nand, loff_t offset, size_t length,
+		      const void *image, size_t image_len);
+int nand_read_lzma(nand_info_t *nand, loff_t offset, size_t length,
+		   u_char *buffer, size_t *size);
+
+struct nand_stream {
+	nand_info_t	*nand;
+	loff_t		start;		/* first block of the target area */
+	loff_t		end;		/* end of the target area */
+	loff_t		off;		/* next block to program */
+	u_char		*buf;		/* two erase blocks */
+	size_t		fill;		/* bytes buffered */
+	size_t		total;		/* bytes accepted so far */
+	uint32_t	crc;		/* CRC32 of those bytes */
+};
+
+int nand_stream_open(struct nand_stream *ns, nand_info_t *nand,
+		     loff_t offset, size_t length);
+void nand_stream_reset(struct nand_stream *ns);
+int nand_stream_write(struct nand_stream *ns, const u_char *buf, size_t len);
+int nand_stream_flush(struct nand_stream *ns, int final);
+int nand_stream_verify(struct nand_stream *ns);
+void nand_stream_close(struct nand_stream *ns);
 
 #define NAND_LOCK_STATUS_TIGHT	0x01
 #define NAND_LOCK_STATUS_LOCK	0x02
@@ -381,6 +381,23 @@ extern IPaddr_t	NetNtpServerIP;			/* the ip address to NTP	*/
 extern int NetTimeOffset;			/* offset time from UTC		*/
 #endif
 
+#if defined(CONFIG_CMD_NAND_TFTP)
+/*
+ * Destination for TFTP data other than load_addr. store() is called
+ * with every new data block, in order, before it is acknowledged;
+ * flush() right after the acknowledgement. Non-zero returns abort the
+ * transfer.
+ */
+struct tftp_sink {
+	int	(*store)(void *priv, ulong offset, const uchar *src,
+			 unsigned len);
+	int	(*flush)(void *priv);
+	void	*priv;
+};
+
+extern struct tftp_sink *TftpSink;
+#endif
+
 /* Initialize the network adapter */
 extern int	NetLoop(proto_t);
 
@@ -0,0 +1,86 @@
+/*
+ * Sparse flash image format
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * A sparse image describes a flash image as a sequence of chunks, each
+ * covering a whole number of blocks of the expanded image:
+ *
+ *   RAW	the blocks follow the chunk header
+ *   FILL	every 32 bit word of the blocks has the same value, only
+ *		that value follows the chunk header
+ *   DONT_CARE	the blocks are not written at all (erased on NAND)
+ *
+ * All fields are little endian. The header checksum is the CRC32 of
+ * everything following the header, so a damaged download is rejected
+ * before anything is written. tools/mksparse creates such images.
+ */
+#ifndef _SPARSE_FORMAT_H_
+#define _SPARSE_FORMAT_H_
+
+#define SPARSE_HEADER_MAGIC	0x53505355	/* "USPS" */
+#define SPARSE_MAJOR_VERSION	1
+
+struct sparse_header {
+	uint32_t	magic;		/* SPARSE_HEADER_MAGIC */
+	uint16_t	major_version;	/* SPARSE_MAJOR_VERSION */
+	uint16_t	minor_version;
+	uint16_t	file_hdr_sz;	/* sizeof(struct sparse_header) */
+	uint16_t	chunk_hdr_sz;	/* sizeof(struct sparse_chunk) */
+	uint32_t	blk_sz;		/* block size, multiple of 512 */
+	uint32_t	total_blks;	/* blocks in the expanded image */
+	uint32_t	total_chunks;
+	uint32_t	image_checksum;	/* CRC32 of all chunks */
+};
+
+#define SPARSE_CHUNK_RAW	0xcac1
+#define SPARSE_CHUNK_FILL	0xcac2
+#define SPARSE_CHUNK_DONT_CARE	0xcac3
+
+struct sparse_chunk {
+	uint16_t	chunk_type;	/* SPARSE_CHUNK_* */
+	uint16_t	reserved;
+	uint32_t	chunk_sz;	/* blocks in the expanded image */
+	uint32_t	total_sz;	/* bytes in the sparse image, incl. header */
+};
+
+#ifndef USE_HOSTCC
+/*
+ * Storage backend for flash_sparse(). Chunks are handed over in image
+ * order, so a backend only has to keep a cursor.
+ */
+struct sparse_storage {
+	void	*priv;
+	ulong	size;		/* bytes available */
+	ulong	align;		/* write unit, blk_sz must be a multiple */
+	int	fill_erased;	/* skip() leaves 0xff, FILL 0xffffffff == skip */
+	/* write len bytes at the cursor and advance it */
+	int	(*write)(struct sparse_storage *info, const void *buf,
+			 ulong len);
+	/* advance the cursor by len bytes without writing */
+	int	(*skip)(struct sparse_storage *info, ulong len);
+};
+
+int is_sparse_image(const void *image);
+int flash_sparse(struct sparse_storage *info, const void *image, ulong len);
+#endif
+
+#endif /* _SPARSE_FORMAT_H_ */
@@ -62,6 +62,8 @@
 #define xyzModem_ymodem 2
 /* Don't define this until the protocol support is in place */
 /*#define xyzModem_zmodem 3 */
+/* Y-modem without per block ACK, needs an error free line */
+#define xyzModem_ymodem_g 4
 
 #define xyzModem_access   -1
 #define xyzModem_noZmodem -2
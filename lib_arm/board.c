@@ -46,6 +46,7 @@
 #include <version.h>
 #include <net.h>
 #include <serial.h>
+#include <bootstage.h>
 #include <nand.h>
 #include <onenand_uboot.h>
 #include <mmc.h>
@@ -293,6 +294,7 @@ void start_armboot (void)
 		if ((*init_fnc_ptr)() != 0) {
 			hang ();
 		}
+		bootstage_mark_addr ("init", (ulong)*init_fnc_ptr);
 	}
 
 	/* armboot_start is defined in the board-specific linker script */
@@ -336,6 +338,7 @@ void start_armboot (void)
 #if defined(CONFIG_CMD_NAND)
 	puts ("NAND:  ");
 	nand_init();		/* go init the NAND */
+	bootstage_mark ("nand_init");
 #endif
 
 #if defined(CONFIG_CMD_ONENAND)
@@ -349,6 +352,7 @@ void start_armboot (void)
 
 	/* initialize environment */
 	env_relocate ();
+	bootstage_mark ("env_relocate");
 
 #ifdef CONFIG_VFD
 	/* must do this after the framebuffer is allocated */
@@ -372,6 +376,7 @@ void start_armboot (void)
 #endif
 
 	console_init_r ();	/* fully init console as a device */
+	bootstage_mark ("console_init_r");
 
 #if defined(CONFIG_ARCH_MISC_INIT)
 	/* miscellaneous arch dependent initialisations */
@@ -436,7 +441,9 @@ extern void davinci_eth_set_mac_addr (const u_int8_t *addr);
 	debug ("Reset Ethernet PHY\n");
 	reset_phy();
 #endif
+	bootstage_mark ("eth_initialize");
 #endif
+	bootstage_mark ("main_loop");
 	/* main_loop() can return to retry autoboot, if so just run it again. */
 	for (;;) {
 		main_loop ();
@@ -448,5 +455,6 @@ extern void davinci_eth_set_mac_addr (const u_int8_t *addr);
 void hang (void)
 {
 	puts ("### ERROR ### Please RESET the board ###\n");
+	serial_flush();
 	for (;;);
 }
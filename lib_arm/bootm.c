@@ -26,6 +26,7 @@
 #include <image.h>
 #include <u-boot/zlib.h>
 #include <asm/byteorder.h>
+#include <bootstage.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -34,6 +35,7 @@ DECLARE_GLOBAL_DATA_PTR;
     defined (CONFIG_INITRD_TAG) || \
     defined (CONFIG_SERIAL_TAG) || \
     defined (CONFIG_REVISION_TAG) || \
+    defined (CONFIG_BOOTSTAGE) || \
     defined (CONFIG_VFD) || \
     defined (CONFIG_LCD)
 static void setup_start_tag (bd_t *bd);
@@ -53,6 +55,10 @@ static void setup_end_tag (bd_t *bd);
 static void setup_videolfb_tag (gd_t *gd);
 # endif
 
+# ifdef CONFIG_BOOTSTAGE
+static void setup_bootstage_tag (void);
+# endif
+
 static struct tag *params;
 #endif /* CONFIG_SETUP_MEMORY_TAGS || CONFIG_CMDLINE_TAG || CONFIG_INITRD_TAG */
 
@@ -79,6 +85,7 @@ int do_bootm_linux(int flag, int argc, char *argv[], bootm_headers_t *images)
 	}
 
 	show_boot_progress (15);
+	bootstage_mark ("start_kernel");
 
 	debug ("## Transferring control to Linux (at address %08lx) ...\n",
 	       (ulong) theKernel);
@@ -88,6 +95,7 @@ int do_bootm_linux(int flag, int argc, char *argv[], bootm_headers_t *images)
     defined (CONFIG_INITRD_TAG) || \
     defined (CONFIG_SERIAL_TAG) || \
     defined (CONFIG_REVISION_TAG) || \
+    defined (CONFIG_BOOTSTAGE) || \
     defined (CONFIG_LCD) || \
     defined (CONFIG_VFD)
 	setup_start_tag (bd);
@@ -109,6 +117,9 @@ int do_bootm_linux(int flag, int argc, char *argv[], bootm_headers_t *images)
 #endif
 #if defined (CONFIG_VFD) || defined (CONFIG_LCD)
 	setup_videolfb_tag ((gd_t *) gd);
+#endif
+#ifdef CONFIG_BOOTSTAGE
+	setup_bootstage_tag ();
 #endif
 	setup_end_tag (bd);
 #endif
@@ -137,6 +148,7 @@ int do_bootm_linux(int flag, int argc, char *argv[], bootm_headers_t *images)
     defined (CONFIG_INITRD_TAG) || \
     defined (CONFIG_SERIAL_TAG) || \
     defined (CONFIG_REVISION_TAG) || \
+    defined (CONFIG_BOOTSTAGE) || \
     defined (CONFIG_LCD) || \
     defined (CONFIG_VFD)
 static void setup_start_tag (bd_t *bd)
@@ -238,6 +250,34 @@ static void setup_videolfb_tag (gd_t *gd)
 }
 #endif /* CONFIG_VFD || CONFIG_LCD */
 
+#ifdef CONFIG_BOOTSTAGE
+static void setup_bootstage_tag (void)
+{
+	const struct bootstage_record *rec;
+	struct tag_bootstage_rec *out;
+	int i, count;
+
+	/* an ATAG_BOOTSTAGE node hands the boot time stamps to Linux */
+	rec = bootstage_get_records (&count);
+	if (!count)
+		return;
+
+	params->hdr.tag = ATAG_BOOTSTAGE;
+	params->hdr.size = (sizeof (struct tag_header) + sizeof (u32) +
+			    count * sizeof (struct tag_bootstage_rec)) >> 2;
+
+	params->u.bootstage.count = count;
+	out = params->u.bootstage.rec;
+	for (i = 0; i < count; i++, rec++, out++) {
+		out->time_us = rec->time_us;
+		out->addr = rec->addr;
+		strncpy (out->name, rec->name, sizeof (out->name));
+	}
+
+	params = tag_next (params);
+}
+#endif /* CONFIG_BOOTSTAGE */
+
 #ifdef CONFIG_SERIAL_TAG
 void setup_serial_tag (struct tag **tmp)
 {
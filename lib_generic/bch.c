@@ -0,0 +1,452 @@
+/*
+ * Binary BCH encoder/decoder
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * A t-error correcting binary BCH code over GF(2^m), used as NAND ECC.
+ *
+ * Bit order: data bytes are fed MSB first, the first data bit being the
+ * highest degree term of the codeword polynomial, followed by the ecc
+ * bits.  Codes are shortened to the actual data length, the Chien
+ * search only visits existing bit positions.
+ *
+ * Encoding is a byte-wise LFSR with a 256 entry remainder table.
+ * Decoding first compares the ecc of the received data with the stored
+ * one, so an error free read costs no more than a write.  Only when they
+ * differ the syndromes are evaluated from the remainder, the error
+ * locator polynomial is found with Berlekamp-Massey and its roots with
+ * a table driven Chien search.
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <asm/errno.h>
+#include <linux/bch.h>
+
+#define BCH_MIN_M	5
+#define BCH_MAX_M	15
+
+/* primitive polynomials for m = 5 .. 15 */
+static const unsigned int prim_poly_tab[] = {
+	0x25, 0x43, 0x83, 0x11d, 0x211, 0x409, 0x805, 0x1053, 0x201b,
+	0x402b, 0x8003,
+};
+
+static inline unsigned int gf_mod(struct bch_control *bch, unsigned int v)
+{
+	while (v >= bch->n)
+		v -= bch->n;
+	return v;
+}
+
+static inline unsigned int gf_mul(struct bch_control *bch, unsigned int a,
+				  unsigned int b)
+{
+	if (!a || !b)
+		return 0;
+	return bch->a_pow_tab[gf_mod(bch, bch->a_log_tab[a] +
+				     bch->a_log_tab[b])];
+}
+
+static inline unsigned int gf_div(struct bch_control *bch, unsigned int a,
+				  unsigned int b)
+{
+	if (!a)
+		return 0;
+	return bch->a_pow_tab[gf_mod(bch, bch->a_log_tab[a] + bch->n -
+				     bch->a_log_tab[b])];
+}
+
+static int build_gf_tables(struct bch_control *bch, unsigned int poly)
+{
+	unsigned int i, x = 1;
+	const unsigned int k = 1 << bch->m;
+
+	for (i = 0; i < bch->n; i++) {
+		bch->a_pow_tab[i] = x;
+		bch->a_log_tab[x] = i;
+		/* not primitive if alpha^i returns to 1 too early */
+		if (i && x == 1)
+			return -EINVAL;
+		x <<= 1;
+		if (x & k)
+			x ^= poly;
+	}
+	bch->a_pow_tab[bch->n] = 1;
+	bch->a_log_tab[0] = 0;
+
+	return 0;
+}
+
+/* feed one bit into a left aligned ecc_words wide LFSR */
+static void lfsr_bit(struct bch_control *bch, uint32_t *r,
+		     const uint32_t *genpoly, unsigned int bit)
+{
+	unsigned int i, fb = (r[0] >> 31) ^ bit;
+
+	for (i = 0; i < bch->ecc_words - 1; i++)
+		r[i] = (r[i] << 1) | (r[i + 1] >> 31);
+	r[i] <<= 1;
+
+	if (fb)
+		for (i = 0; i < bch->ecc_words; i++)
+			r[i] ^= genpoly[i];
+}
+
+/*
+ * Build the generator polynomial, the product of the minimal polynomials
+ * of alpha^1 .. alpha^2t, and the byte-wise remainder table.
+ */
+static int build_generator(struct bch_control *bch)
+{
+	const unsigned int n = bch->n;
+	unsigned int *g, *roots;
+	uint32_t *genpoly;
+	unsigned int i, j, r, deg = 0;
+	int ret = -ENOMEM;
+
+	g = malloc((bch->m * bch->t + 1) * sizeof(*g));
+	roots = malloc((n + 1) * sizeof(*roots));
+	genpoly = malloc(bch->ecc_words * sizeof(*genpoly));
+	if (!g || !roots || !genpoly)
+		goto out;
+
+	/* collect the cyclotomic cosets of alpha^1, alpha^3 ... */
+	memset(roots, 0, (n + 1) * sizeof(*roots));
+	for (i = 0; i < bch->t; i++) {
+		for (j = 0, r = 2 * i + 1; j < bch->m; j++) {
+			roots[r] = 1;
+			r = gf_mod(bch, 2 * r);
+		}
+	}
+
+	/* g(x) = prod (x + alpha^r) over all roots */
+	g[0] = 1;
+	for (r = 0; r < n; r++) {
+		if (!roots[r])
+			continue;
+		g[deg + 1] = 1;
+		for (j = deg; j > 0; j--)
+			g[j] = gf_mul(bch, g[j], bch->a_pow_tab[r]) ^ g[j - 1];
+		g[0] = gf_mul(bch, g[0], bch->a_pow_tab[r]);
+		deg++;
+	}
+	bch->ecc_bits = deg;
+
+	/* all coefficients are binary now, left align g minus x^deg */
+	memset(genpoly, 0, bch->ecc_words * sizeof(*genpoly));
+	for (j = 0; j < deg; j++)
+		if (g[deg - 1 - j])
+			genpoly[j / 32] |= 1u << (31 - (j % 32));
+
+	for (i = 0; i < 256; i++) {
+		uint32_t *tab = &bch->mod_tab[i * bch->ecc_words];
+
+		memset(tab, 0, bch->ecc_words * sizeof(*tab));
+		for (j = 0; j < 8; j++)
+			lfsr_bit(bch, tab, genpoly, (i >> (7 - j)) & 1);
+	}
+	ret = 0;
+out:
+	free(genpoly);
+	free(roots);
+	free(g);
+	return ret;
+}
+
+/**
+ * init_bch - initialize a BCH encoder/decoder
+ * @m:		Galois field order, 5 <= m <= 15
+ * @t:		maximum number of correctable bit errors
+ * @prim_poly:	primitive polynomial of GF(2^m), or 0 for the default
+ */
+struct bch_control *init_bch(int m, int t, unsigned int prim_poly)
+{
+	struct bch_control *bch;
+
+	if (m < BCH_MIN_M || m > BCH_MAX_M || t < 1 || m * t < 8 ||
+	    m * t >= (1 << m))
+		return NULL;
+
+	if (!prim_poly)
+		prim_poly = prim_poly_tab[m - BCH_MIN_M];
+
+	bch = malloc(sizeof(*bch));
+	if (!bch)
+		return NULL;
+	memset(bch, 0, sizeof(*bch));
+
+	bch->m = m;
+	bch->t = t;
+	bch->n = (1 << m) - 1;
+	bch->ecc_bytes = (m * t + 7) / 8;
+	bch->ecc_words = (m * t + 31) / 32;
+	bch->a_pow_tab = malloc((bch->n + 1) * sizeof(uint16_t));
+	bch->a_log_tab = malloc((bch->n + 1) * sizeof(uint16_t));
+	bch->mod_tab = malloc(256 * bch->ecc_words * sizeof(uint32_t));
+	bch->ecc_buf = malloc(bch->ecc_words * sizeof(uint32_t));
+	bch->syn = malloc(2 * t * sizeof(unsigned int));
+	bch->elp = malloc(3 * (2 * t + 1) * sizeof(unsigned int));
+
+	if (!bch->a_pow_tab || !bch->a_log_tab || !bch->mod_tab ||
+	    !bch->ecc_buf || !bch->syn || !bch->elp)
+		goto fail;
+
+	if (build_gf_tables(bch, prim_poly) || build_generator(bch))
+		goto fail;
+
+	return bch;
+
+fail:
+	free_bch(bch);
+	return NULL;
+}
+
+void free_bch(struct bch_control *bch)
+{
+	if (!bch)
+		return;
+
+	free(bch->elp);
+	free(bch->syn);
+	free(bch->ecc_buf);
+	free(bch->mod_tab);
+	free(bch->a_log_tab);
+	free(bch->a_pow_tab);
+	free(bch);
+}
+
+static void load_ecc(struct bch_control *bch, uint32_t *r, const uint8_t *ecc)
+{
+	unsigned int i;
+
+	memset(r, 0, bch->ecc_words * sizeof(*r));
+	for (i = 0; i < bch->ecc_bytes; i++)
+		r[i / 4] |= (uint32_t)ecc[i] << (24 - 8 * (i % 4));
+}
+
+static void store_ecc(struct bch_control *bch, uint8_t *ecc, const uint32_t *r)
+{
+	unsigned int i;
+
+	for (i = 0; i < bch->ecc_bytes; i++)
+		ecc[i] = r[i / 4] >> (24 - 8 * (i % 4));
+}
+
+void encode_bch(struct bch_control *bch, const uint8_t *data,
+		unsigned int len, uint8_t *ecc)
+{
+	const unsigned int words = bch->ecc_words;
+	uint32_t *r = bch->ecc_buf;
+	const uint32_t *tab;
+	unsigned int i;
+
+	load_ecc(bch, r, ecc);
+
+	switch (words) {
+	case 2:
+		/* t <= 4 for 512 byte steps: keep the LFSR in registers */
+		{
+			uint32_t r0 = r[0], r1 = r[1];
+
+			while (len--) {
+				tab = &bch->mod_tab[((r0 >> 24) ^ *data++) * 2];
+				r0 = ((r0 << 8) | (r1 >> 24)) ^ tab[0];
+				r1 = (r1 << 8) ^ tab[1];
+			}
+			r[0] = r0;
+			r[1] = r1;
+		}
+		break;
+	case 4:
+		{
+			uint32_t r0 = r[0], r1 = r[1], r2 = r[2], r3 = r[3];
+
+			while (len--) {
+				tab = &bch->mod_tab[((r0 >> 24) ^ *data++) * 4];
+				r0 = ((r0 << 8) | (r1 >> 24)) ^ tab[0];
+				r1 = ((r1 << 8) | (r2 >> 24)) ^ tab[1];
+				r2 = ((r2 << 8) | (r3 >> 24)) ^ tab[2];
+				r3 = (r3 << 8) ^ tab[3];
+			}
+			r[0] = r0;
+			r[1] = r1;
+			r[2] = r2;
+			r[3] = r3;
+		}
+		break;
+	default:
+		while (len--) {
+			tab = &bch->mod_tab[((r[0] >> 24) ^ *data++) * words];
+			for (i = 0; i < words - 1; i++)
+				r[i] = ((r[i] << 8) | (r[i + 1] >> 24)) ^ tab[i];
+			r[i] = (r[i] << 8) ^ tab[i];
+		}
+		break;
+	}
+
+	store_ecc(bch, ecc, r);
+}
+
+/*
+ * Syndromes S(1) .. S(2t) of the remainder r(x); only the odd ones are
+ * evaluated, S(2j) = S(j)^2.
+ */
+static void compute_syndromes(struct bch_control *bch, const uint32_t *r,
+			      unsigned int *syn)
+{
+	const unsigned int t2 = 2 * bch->t;
+	unsigned int i, j, deg;
+
+	memset(syn, 0, t2 * sizeof(*syn));
+
+	for (i = 0; i < bch->ecc_bits; i++) {
+		if (!(r[i / 32] & (1u << (31 - (i % 32)))))
+			continue;
+		deg = bch->ecc_bits - 1 - i;
+		for (j = 0; j < t2; j += 2)
+			syn[j] ^= bch->a_pow_tab[(deg * (j + 1)) % bch->n];
+	}
+
+	for (j = 1; j < t2; j += 2)
+		syn[j] = gf_mul(bch, syn[j / 2], syn[j / 2]);
+}
+
+/*
+ * Berlekamp-Massey: find the error locator polynomial sigma(x) (in
+ * bch->elp) from the syndromes, returns its degree.
+ */
+static int compute_elp(struct bch_control *bch, const unsigned int *syn)
+{
+	const unsigned int t2 = 2 * bch->t;
+	unsigned int *c = bch->elp;
+	unsigned int *b = c + t2 + 1;
+	unsigned int *tmp = b + t2 + 1;
+	unsigned int d, bd = 1, coef;
+	unsigned int i, k, shift = 1;
+	int l = 0;
+
+	memset(c, 0, (t2 + 1) * sizeof(*c));
+	memset(b, 0, (t2 + 1) * sizeof(*b));
+	c[0] = b[0] = 1;
+
+	for (k = 0; k < t2; k++) {
+		d = syn[k];
+		for (i = 1; i <= l; i++)
+			d ^= gf_mul(bch, c[i], syn[k - i]);
+
+		if (!d) {
+			shift++;
+			continue;
+		}
+
+		coef = gf_div(bch, d, bd);
+		if (2 * l <= k) {
+			memcpy(tmp, c, (t2 + 1) * sizeof(*c));
+			for (i = 0; i + shift <= t2; i++)
+				c[i + shift] ^= gf_mul(bch, coef, b[i]);
+			l = k + 1 - l;
+			memcpy(b, tmp, (t2 + 1) * sizeof(*b));
+			bd = d;
+			shift = 1;
+		} else {
+			for (i = 0; i + shift <= t2; i++)
+				c[i + shift] ^= gf_mul(bch, coef, b[i]);
+			shift++;
+		}
+	}
+
+	return l;
+}
+
+int decode_bch(struct bch_control *bch, const uint8_t *data,
+	       unsigned int len, const uint8_t *recv_ecc,
+	       const uint8_t *calc_ecc, unsigned int *errloc)
+{
+	const unsigned int nbits = 8 * len + bch->ecc_bits;
+	unsigned int *syn = bch->syn;
+	unsigned int *sigma = bch->elp;
+	uint32_t r[BCH_MAX_M * 2];	/* room for t up to 64 */
+	unsigned int i, deg, sum, nroots = 0;
+	unsigned int *reg;
+	int l;
+
+	if (nbits > bch->n || bch->ecc_words > ARRAY_SIZE(r))
+		return -EINVAL;
+
+	if (!calc_ecc) {
+		uint8_t *ecc = (uint8_t *)r;
+
+		memset(ecc, 0, bch->ecc_bytes);
+		encode_bch(bch, data, len, ecc);
+		load_ecc(bch, bch->ecc_buf, ecc);
+	} else {
+		load_ecc(bch, bch->ecc_buf, calc_ecc);
+	}
+
+	/* remainder of the received codeword, without the padding bits */
+	load_ecc(bch, r, recv_ecc);
+	sum = 0;
+	for (i = 0; i < bch->ecc_words; i++) {
+		r[i] ^= bch->ecc_buf[i];
+		if ((i + 1) * 32 > bch->ecc_bits) {
+			unsigned int keep = bch->ecc_bits > i * 32 ?
+				bch->ecc_bits - i * 32 : 0;
+
+			if (keep < 32)
+				r[i] &= keep ? ~0u << (32 - keep) : 0;
+		}
+		sum |= r[i];
+	}
+	if (!sum)
+		return 0;
+
+	compute_syndromes(bch, r, syn);
+	l = compute_elp(bch, syn);
+	if (l > bch->t)
+		return -EBADMSG;
+
+	/*
+	 * Chien search: the error positions are the degrees d with
+	 * sigma(alpha^-d) = 0.  reg[i] holds log(sigma[i]) - i * d.
+	 */
+	reg = sigma + 2 * bch->t + 1;
+	for (i = 1; i <= l; i++)
+		reg[i] = sigma[i] ? bch->a_log_tab[sigma[i]] : bch->n;
+
+	for (deg = 0; deg < nbits && nroots < l; deg++) {
+		sum = 1;
+		for (i = 1; i <= l; i++) {
+			if (reg[i] == bch->n)
+				continue;
+			sum ^= bch->a_pow_tab[reg[i]];
+			reg[i] = reg[i] >= i ? reg[i] - i : reg[i] + bch->n - i;
+		}
+		if (!sum) {
+			/* bit number in data + ecc, LSB first within bytes */
+			unsigned int pos = nbits - 1 - deg;
+
+			errloc[nroots++] = (pos & ~7) | (7 - (pos & 7));
+		}
+	}
+
+	return nroots == l ? l : -EBADMSG;
+}
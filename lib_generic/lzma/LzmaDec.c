@@ -47,6 +47,18 @@
   i -= 0x40; }
 #endif
 
+/*
+ * Literals always take exactly eight bits, so the two literal loops in
+ * LzmaDec_DecodeReal() are unrolled; they are the hottest code when
+ * decoding a kernel image.
+ */
+#define NORMAL_LITER_DEC GET_BIT(prob + symbol, symbol)
+#define MATCHED_LITER_DEC \
+  matchByte <<= 1; \
+  bit = (matchByte & offs); \
+  probLit = prob + offs + bit + symbol; \
+  GET_BIT2(probLit, symbol, offs &= ~bit, offs &= bit)
+
 #define NORMALIZE_CHECK if (range < kTopValue) { if (buf >= bufLimit) return DUMMY_ERROR; range <<= 8; code = (code << 8) | (*buf++); }
 
 #define IF_BIT_0_CHECK(p) ttt = *(p); NORMALIZE_CHECK; bound = (range >> kNumBitModelTotalBits) * ttt; if (code < bound)
@@ -181,33 +193,50 @@ static int MY_FAST_CALL LzmaDec_DecodeReal(CLzmaDec *p, SizeT limit, const Byte
       if (state < kNumLitStates)
       {
         symbol = 1;
-
-        WATCHDOG_RESET();
-
-        do { GET_BIT(prob + symbol, symbol) } while (symbol < 0x100);
+#ifdef _LZMA_SIZE_OPT
+        do { NORMAL_LITER_DEC } while (symbol < 0x100);
+#else
+        NORMAL_LITER_DEC
+        NORMAL_LITER_DEC
+        NORMAL_LITER_DEC
+        NORMAL_LITER_DEC
+        NORMAL_LITER_DEC
+        NORMAL_LITER_DEC
+        NORMAL_LITER_DEC
+        NORMAL_LITER_DEC
+#endif
       }
       else
       {
         unsigned matchByte = p->dic[(dicPos - rep0) + ((dicPos < rep0) ? dicBufSize : 0)];
         unsigned offs = 0x100;
+        unsigned bit;
+        CLzmaProb *probLit;
         symbol = 1;
-
-        WATCHDOG_RESET();
-
+#ifdef _LZMA_SIZE_OPT
         do
         {
-          unsigned bit;
-          CLzmaProb *probLit;
-          matchByte <<= 1;
-          bit = (matchByte & offs);
-          probLit = prob + offs + bit + symbol;
-          GET_BIT2(probLit, symbol, offs &= ~bit, offs &= bit)
+          MATCHED_LITER_DEC
         }
         while (symbol < 0x100);
+#else
+        MATCHED_LITER_DEC
+        MATCHED_LITER_DEC
+        MATCHED_LITER_DEC
+        MATCHED_LITER_DEC
+        MATCHED_LITER_DEC
+        MATCHED_LITER_DEC
+        MATCHED_LITER_DEC
+        MATCHED_LITER_DEC
+#endif
       }
       dic[dicPos++] = (Byte)symbol;
       processedPos++;
 
+      /* kick the watchdog every 4 KiB rather than on every literal */
+      if ((processedPos & 0xfff) == 0)
+        WATCHDOG_RESET();
+
       state = kLiteralNextStates[state];
       /* if (state < 4) state = 0; else if (state < 10) state -= 3; else state -= 6; */
       continue;
@@ -327,9 +356,6 @@ static int MY_FAST_CALL LzmaDec_DecodeReal(CLzmaDec *p, SizeT limit, const Byte
             {
               UInt32 mask = 1;
               unsigned i = 1;
-
-              WATCHDOG_RESET();
-
               do
               {
                 GET_BIT2(prob + i, i, ; , distance |= mask);
@@ -341,9 +367,6 @@ static int MY_FAST_CALL LzmaDec_DecodeReal(CLzmaDec *p, SizeT limit, const Byte
           else
           {
             numDirectBits -= kNumAlignBits;
-
-            WATCHDOG_RESET();
-
             do
             {
               NORMALIZE
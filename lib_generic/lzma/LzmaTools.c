@@ -107,8 +107,24 @@ int lzmaBuffToBuffDecompress (unsigned char *outStream, SizeT *uncompressedSize,
         }
     }
 
+    /*
+     * *uncompressedSize is the room at outStream. A stream which says
+     * it is larger does not fit; one of unknown size is decoded up to
+     * the room and must reach its end marker within it.
+     */
+    if (outSizeFull > *uncompressedSize) {
+        if (outSize != 0xFFFFFFFF || outSizeHigh != 0xFFFFFFFF) {
+            debug ("LZMA: %lu bytes do not fit into %lu.\n",
+                   (ulong)outSizeFull, (ulong)*uncompressedSize);
+            *uncompressedSize = 0;
+            return SZ_ERROR_OUTPUT_EOF;
+        }
+        outSizeFull = *uncompressedSize;
+    }
+
     debug ("LZMA: Uncompresed size............ 0x%lx\n", outSizeFull);
     debug ("LZMA: Compresed size.............. 0x%lx\n", compressedSize);
+    debug ("LZMA: Decoder heap usage.......... 0x%lx\n", lzmaMemUsage(inStream));
 
     g_Alloc.Alloc = SzAlloc;
     g_Alloc.Free = SzFree;
@@ -123,11 +139,157 @@ int lzmaBuffToBuffDecompress (unsigned char *outStream, SizeT *uncompressedSize,
         inStream + LZMA_DATA_OFFSET, &compressedSize,
         inStream, LZMA_PROPS_SIZE, LZMA_FINISH_ANY, &state, &g_Alloc);
     *uncompressedSize = outProcessed;
+    if (res == SZ_OK && state == LZMA_STATUS_NOT_FINISHED &&
+        outProcessed == outSizeFull && outSize == 0xFFFFFFFF &&
+        outSizeHigh == 0xFFFFFFFF)
+        res = SZ_ERROR_OUTPUT_EOF;
     if (res != SZ_OK)  {
+        if (res == SZ_ERROR_MEM)
+            printf ("LZMA: need %lu bytes of malloc space\n",
+                    (ulong)lzmaMemUsage(inStream));
         return res;
     }
 
     return res;
 }
 
+/*
+ * Heap needed to decode a stream with the given properties: the
+ * probability model of LZMA_BASE_SIZE + (LZMA_LIT_SIZE << (lc + lp))
+ * entries. No dictionary is allocated, the destination buffer is used.
+ */
+SizeT lzmaMemUsage (const unsigned char *props)
+{
+    CLzmaProps p;
+
+    if (LzmaProps_Decode(&p, props, LZMA_PROPS_SIZE) != SZ_OK)
+        return 0;
+
+    return ((SizeT)1846 + ((SizeT)768 << (p.lc + p.lp))) * sizeof(CLzmaProb);
+}
+
+int lzmaStreamInit (LzmaStream *s, unsigned char *outStream, SizeT outSize)
+{
+    memset(s, 0, sizeof(*s));
+    LzmaDec_Construct(&s->dec);
+    s->alloc.Alloc = SzAlloc;
+    s->alloc.Free = SzFree;
+    s->outStream = outStream;
+    s->outSize = outSize;
+    s->unpackSize = (SizeT)-1;
+
+    return SZ_OK;
+}
+
+/* Called once the 13 byte LZMA_Alone header has been collected */
+static int lzmaStreamStart (LzmaStream *s)
+{
+    UInt32 outSize = 0, outSizeHigh = 0;
+    int i, res;
+
+    for (i = 0; i < 4; i++) {
+        outSize |= (UInt32)s->hdr[LZMA_SIZE_OFFSET + i] << (i * 8);
+        outSizeHigh |= (UInt32)s->hdr[LZMA_SIZE_OFFSET + 4 + i] << (i * 8);
+    }
+
+    if (outSize == 0xFFFFFFFF && outSizeHigh == 0xFFFFFFFF) {
+        /* unknown size, the stream must carry an end marker */
+        s->unpackSize = (SizeT)-1;
+    } else if (outSizeHigh != 0) {
+        debug ("LZMA: 64bit support not enabled.\n");
+        return SZ_ERROR_DATA;
+    } else if (outSize > s->outSize) {
+        return SZ_ERROR_OUTPUT_EOF;
+    } else {
+        s->unpackSize = outSize;
+    }
+
+    debug ("LZMA: Decoder heap usage.......... 0x%lx\n", lzmaMemUsage(s->hdr));
+
+    res = LzmaDec_AllocateProbs(&s->dec, s->hdr, LZMA_PROPS_SIZE, &s->alloc);
+    if (res != SZ_OK) {
+        if (res == SZ_ERROR_MEM)
+            printf ("LZMA: need %lu bytes of malloc space\n",
+                    (ulong)lzmaMemUsage(s->hdr));
+        return res;
+    }
+
+    s->dec.dic = s->outStream;
+    s->dec.dicBufSize = s->outSize;
+    LzmaDec_Init(&s->dec);
+
+    return SZ_OK;
+}
+
+/*
+ * Feed the next 'length' bytes of the stream. Returns SZ_OK while more
+ * input is wanted or once the stream is complete (s->finished is set).
+ */
+int lzmaStreamDecode (LzmaStream *s, const unsigned char *inStream,
+                      SizeT length)
+{
+    ELzmaStatus status;
+    SizeT inLen, dicLimit;
+    int res;
+
+    if (s->finished)
+        return SZ_OK;
+
+    if (s->hdrLen < LZMA_DATA_OFFSET) {
+        unsigned n = LZMA_DATA_OFFSET - s->hdrLen;
+
+        if (n > length)
+            n = length;
+        memcpy(s->hdr + s->hdrLen, inStream, n);
+        s->hdrLen += n;
+        inStream += n;
+        length -= n;
+        if (s->hdrLen < LZMA_DATA_OFFSET)
+            return SZ_OK;
+
+        res = lzmaStreamStart(s);
+        if (res != SZ_OK)
+            return res;
+    }
+
+    if (length == 0)
+        return SZ_OK;
+
+    dicLimit = (s->unpackSize == (SizeT)-1) ? s->outSize : s->unpackSize;
+    inLen = length;
+
+    WATCHDOG_RESET();
+
+    /*
+     * Without a size in the header the end marker is mandatory; when the
+     * destination is full, LZMA_FINISH_END makes the decoder look for it
+     * (possibly across chunks) instead of stopping short of it.
+     */
+    res = LzmaDec_DecodeToDic(&s->dec, dicLimit, inStream, &inLen,
+                              s->unpackSize == (SizeT)-1 ?
+                              LZMA_FINISH_END : LZMA_FINISH_ANY, &status);
+    if (res != SZ_OK)
+        return res;
+
+    if (status == LZMA_STATUS_FINISHED_WITH_MARK ||
+        (s->unpackSize != (SizeT)-1 && s->dec.dicPos == s->unpackSize))
+        s->finished = 1;
+    else if (s->dec.dicPos == s->outSize &&
+             status != LZMA_STATUS_NEEDS_MORE_INPUT)
+        return SZ_ERROR_OUTPUT_EOF;
+
+    return SZ_OK;
+}
+
+/* Number of bytes written to the destination so far */
+SizeT lzmaStreamOutLen (LzmaStream *s)
+{
+    return s->hdrLen < LZMA_DATA_OFFSET ? 0 : s->dec.dicPos;
+}
+
+void lzmaStreamEnd (LzmaStream *s)
+{
+    LzmaDec_FreeProbs(&s->dec, &s->alloc);
+}
+
 #endif
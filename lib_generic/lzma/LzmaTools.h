@@ -29,7 +29,39 @@
 #define __LZMA_TOOL_H__
 
 #include <lzma/LzmaTypes.h>
+#include <lzma/LzmaDec.h>
 
+/*
+ * *uncompressedSize is the room at outStream on entry and the number of
+ * bytes decoded on return; a stream larger than the room is refused
+ * with SZ_ERROR_OUTPUT_EOF.
+ */
 extern int lzmaBuffToBuffDecompress (unsigned char *outStream, SizeT *uncompressedSize,
 			      unsigned char *inStream,  SizeT  length);
+
+/*
+ * Streaming decompression: compressed data is fed in arbitrary chunks
+ * (e.g. as it is read from NAND or MMC) and decoded straight into the
+ * final destination, which doubles as the LZMA dictionary. Only the
+ * probability tables are allocated, see lzmaMemUsage().
+ */
+typedef struct {
+	CLzmaDec	dec;
+	ISzAlloc	alloc;
+	unsigned char	*outStream;
+	SizeT		outSize;	/* destination buffer size */
+	SizeT		unpackSize;	/* from the header, or -1 if unknown */
+	unsigned	hdrLen;		/* header bytes collected so far */
+	unsigned char	hdr[LZMA_PROPS_SIZE + 8];
+	int		finished;
+} LzmaStream;
+
+extern int lzmaStreamInit (LzmaStream *s, unsigned char *outStream,
+			   SizeT outSize);
+extern int lzmaStreamDecode (LzmaStream *s, const unsigned char *inStream,
+			     SizeT length);
+extern SizeT lzmaStreamOutLen (LzmaStream *s);
+extern void lzmaStreamEnd (LzmaStream *s);
+
+extern SizeT lzmaMemUsage (const unsigned char *props);
 #endif
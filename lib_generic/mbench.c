@@ -0,0 +1,307 @@
+/*
+ * Memory bandwidth and latency benchmark, see include/mbench.h
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+#ifdef USE_HOSTCC
+#include <stdint.h>
+#include <stdio.h>
+#else
+#include <common.h>
+#include <div64.h>
+#endif
+#include <mbench.h>
+
+/*
+ * All kernels move len bytes, len being a multiple of 64. The byte and
+ * word kernels are unrolled to 8 accesses per iteration like the burst
+ * kernels, so the only difference is the access width. On ARM the burst
+ * kernels use ldm/stm of 8 registers (r8 is gd, so it is left out);
+ * elsewhere they are plain C the compiler may vectorize.
+ */
+static unsigned long read8(void *dst, void *src, unsigned long len)
+{
+	volatile uint8_t *p = dst;
+	unsigned long sum = 0;
+
+	for (; len; len -= 8, p += 8)
+		sum += p[0] + p[1] + p[2] + p[3] + p[4] + p[5] + p[6] + p[7];
+	return sum;
+}
+
+static unsigned long read32(void *dst, void *src, unsigned long len)
+{
+	volatile uint32_t *p = dst;
+	unsigned long sum = 0;
+
+	for (; len; len -= 32, p += 8)
+		sum += p[0] + p[1] + p[2] + p[3] + p[4] + p[5] + p[6] + p[7];
+	return sum;
+}
+
+static unsigned long read_burst(void *dst, void *src, unsigned long len)
+{
+#ifdef __arm__
+	__asm__ __volatile__(
+		"1:	ldmia	%0!, {r3-r7, r9, r10, ip}\n"
+		"	ldmia	%0!, {r3-r7, r9, r10, ip}\n"
+		"	subs	%1, %1, #64\n"
+		"	bhi	1b\n"
+		: "+r" (dst), "+r" (len)
+		:
+		: "r3", "r4", "r5", "r6", "r7", "r9", "r10", "ip", "cc",
+		  "memory");
+	return 0;
+#else
+	uint32_t *p = dst;
+	unsigned long sum = 0;
+
+	for (; len; len -= 32, p += 8)
+		sum += p[0] + p[1] + p[2] + p[3] + p[4] + p[5] + p[6] + p[7];
+	return sum;
+#endif
+}
+
+static unsigned long write8(void *dst, void *src, unsigned long len)
+{
+	volatile uint8_t *p = dst;
+
+	for (; len; len -= 8, p += 8) {
+		p[0] = 0x55; p[1] = 0xaa; p[2] = 0x55; p[3] = 0xaa;
+		p[4] = 0x55; p[5] = 0xaa; p[6] = 0x55; p[7] = 0xaa;
+	}
+	return 0;
+}
+
+static unsigned long write32(void *dst, void *src, unsigned long len)
+{
+	volatile uint32_t *p = dst;
+
+	for (; len; len -= 32, p += 8) {
+		p[0] = 0x55aa55aa; p[1] = 0xaa55aa55;
+		p[2] = 0x55aa55aa; p[3] = 0xaa55aa55;
+		p[4] = 0x55aa55aa; p[5] = 0xaa55aa55;
+		p[6] = 0x55aa55aa; p[7] = 0xaa55aa55;
+	}
+	return 0;
+}
+
+static unsigned long write_burst(void *dst, void *src, unsigned long len)
+{
+#ifdef __arm__
+	__asm__ __volatile__(
+		"	mov	r3, %2\n"
+		"	mvn	r4, %2\n"
+		"	mov	r5, r3\n"
+		"	mov	r6, r4\n"
+		"	mov	r7, r3\n"
+		"	mov	r9, r4\n"
+		"	mov	r10, r3\n"
+		"	mov	ip, r4\n"
+		"1:	stmia	%0!, {r3-r7, r9, r10, ip}\n"
+		"	stmia	%0!, {r3-r7, r9, r10, ip}\n"
+		"	subs	%1, %1, #64\n"
+		"	bhi	1b\n"
+		: "+r" (dst), "+r" (len)
+		: "r" (0x55aa55aa)
+		: "r3", "r4", "r5", "r6", "r7", "r9", "r10", "ip", "cc",
+		  "memory");
+#else
+	uint32_t *p = dst;
+
+	for (; len; len -= 32, p += 8) {
+		p[0] = 0x55aa55aa; p[1] = 0xaa55aa55;
+		p[2] = 0x55aa55aa; p[3] = 0xaa55aa55;
+		p[4] = 0x55aa55aa; p[5] = 0xaa55aa55;
+		p[6] = 0x55aa55aa; p[7] = 0xaa55aa55;
+	}
+#endif
+	return 0;
+}
+
+static unsigned long copy8(void *dst, void *src, unsigned long len)
+{
+	volatile uint8_t *d = dst, *s = src;
+
+	for (; len; len -= 8, d += 8, s += 8) {
+		d[0] = s[0]; d[1] = s[1]; d[2] = s[2]; d[3] = s[3];
+		d[4] = s[4]; d[5] = s[5]; d[6] = s[6]; d[7] = s[7];
+	}
+	return 0;
+}
+
+static unsigned long copy32(void *dst, void *src, unsigned long len)
+{
+	volatile uint32_t *d = dst, *s = src;
+
+	for (; len; len -= 32, d += 8, s += 8) {
+		d[0] = s[0]; d[1] = s[1]; d[2] = s[2]; d[3] = s[3];
+		d[4] = s[4]; d[5] = s[5]; d[6] = s[6]; d[7] = s[7];
+	}
+	return 0;
+}
+
+static unsigned long copy_burst(void *dst, void *src, unsigned long len)
+{
+#ifdef __arm__
+	__asm__ __volatile__(
+		"1:	ldmia	%1!, {r3-r7, r9, r10, ip}\n"
+		"	stmia	%0!, {r3-r7, r9, r10, ip}\n"
+		"	ldmia	%1!, {r3-r7, r9, r10, ip}\n"
+		"	stmia	%0!, {r3-r7, r9, r10, ip}\n"
+		"	subs	%2, %2, #64\n"
+		"	bhi	1b\n"
+		: "+r" (dst), "+r" (src), "+r" (len)
+		:
+		: "r3", "r4", "r5", "r6", "r7", "r9", "r10", "ip", "cc",
+		  "memory");
+#else
+	uint32_t *d = dst, *s = src;
+
+	for (; len; len -= 32, d += 8, s += 8) {
+		d[0] = s[0]; d[1] = s[1]; d[2] = s[2]; d[3] = s[3];
+		d[4] = s[4]; d[5] = s[5]; d[6] = s[6]; d[7] = s[7];
+	}
+#endif
+	return 0;
+}
+
+static const struct {
+	const char	*name;
+	unsigned long	(*fn)(void *dst, void *src, unsigned long len);
+	int		copy;
+} mbench_tests[] = {
+	{ "read   8 bit",	read8,		0 },
+	{ "read  32 bit",	read32,		0 },
+	{ "read  burst",	read_burst,	0 },
+	{ "write  8 bit",	write8,		0 },
+	{ "write 32 bit",	write32,	0 },
+	{ "write burst",	write_burst,	0 },
+	{ "copy   8 bit",	copy8,		1 },
+	{ "copy  32 bit",	copy32,		1 },
+	{ "copy  burst",	copy_burst,	1 },
+};
+
+/* n / d for any d; precise enough for a report */
+static unsigned long long mbench_div(unsigned long long n,
+				     unsigned long long d)
+{
+	while (d >> 32) {
+		n >>= 1;
+		d >>= 1;
+	}
+	if (!d)
+		return 0;
+#ifdef USE_HOSTCC
+	return n / d;
+#else
+	do_div(n, (uint32_t)d);
+	return n;
+#endif
+}
+
+/*
+ * Link the MBENCH_STRIDE slots of buf into one random cycle (Sattolo's
+ * shuffle), so that following it defeats both caches and prefetch and
+ * every load waits for the previous one. Returns the number of slots.
+ */
+static unsigned long chase_setup(void *buf, unsigned long size)
+{
+	unsigned long n = size / MBENCH_STRIDE;
+	uint32_t seed = 0x12345678;
+	unsigned long i, j, t;
+
+#define SLOT(i)	(*(unsigned long *)((char *)buf + (i) * MBENCH_STRIDE))
+	for (i = 0; i < n; i++)
+		SLOT(i) = i;
+	for (i = n - 1; i > 0; i--) {
+		seed = seed * 1103515245 + 12345;
+		j = (seed >> 8) % i;
+		t = SLOT(i);
+		SLOT(i) = SLOT(j);
+		SLOT(j) = t;
+	}
+	for (i = 0; i < n; i++)
+		SLOT(i) = (unsigned long)buf + SLOT(i) * MBENCH_STRIDE;
+#undef SLOT
+
+	return n;
+}
+
+static unsigned long chase(void *buf, unsigned long steps)
+{
+	void **p = buf;
+
+	for (; steps >= 4; steps -= 4)
+		p = *(void **)*(void **)*(void **)*p;
+	while (steps--)
+		p = *p;
+	return (unsigned long)p;
+}
+
+int mbench(void *buf, unsigned long size, unsigned int loops)
+{
+	volatile unsigned long sink;
+	unsigned long long start, ns, bytes;
+	unsigned long half, steps, rate;
+	unsigned int i, l;
+
+	size &= ~127UL;
+	half = size / 2;
+	if (!half || !loops) {
+		printf("mbench: need at least 128 bytes and one loop\n");
+		return 1;
+	}
+
+	for (i = 0; i < sizeof(mbench_tests) / sizeof(mbench_tests[0]); i++) {
+		unsigned long len = mbench_tests[i].copy ? half : size;
+
+		start = mbench_time_ns();
+		for (l = 0; l < loops; l++)
+			sink = mbench_tests[i].fn(buf, (char *)buf + half, len);
+		ns = mbench_time_ns() - start;
+
+		/* MB/s with one decimal: bytes / ns * 1000 * 10 */
+		bytes = (unsigned long long)len * loops;
+		rate = mbench_div(bytes * 10000, ns);
+		printf("%-12s %7lu.%lu MB/s\n", mbench_tests[i].name,
+		       rate / 10, rate % 10);
+#ifndef USE_HOSTCC
+		if (ctrlc()) {
+			puts("\nAbort\n");
+			return 1;
+		}
+#endif
+	}
+
+	steps = chase_setup(buf, size);
+	start = mbench_time_ns();
+	for (l = 0; l < loops; l++)
+		sink = chase(buf, steps);
+	ns = mbench_time_ns() - start;
+
+	/* ns per load with one decimal */
+	rate = mbench_div(ns * 10, (unsigned long long)steps * loops);
+	printf("%-12s %7lu.%lu ns (random, %lu x %d bytes)\n", "latency",
+	       rate / 10, rate % 10, steps, MBENCH_STRIDE);
+
+	(void)sink;
+	return 0;
+}
@@ -51,6 +51,20 @@ byteReverse(unsigned char *buf, unsigned longs)
 	} while (--longs);
 }
 
+#ifdef CONFIG_MD5_FAST
+/*
+ * MD5Transform() converts each input word itself, so message blocks can
+ * be hashed straight from the caller's buffer and never need reversing.
+ */
+#define byteReverseIn(buf, longs)	do { } while (0)
+#define MD5_IN(in, i)			le32_to_cpu((in)[i])
+#define MD5_PUT_IN(x)			cpu_to_le32(x)
+#else
+#define byteReverseIn(buf, longs)	byteReverse(buf, longs)
+#define MD5_IN(in, i)			((in)[i])
+#define MD5_PUT_IN(x)			(x)
+#endif
+
 /*
  * Start MD5 accumulation.  Set bit count to 0 and buffer to mysterious
  * initialization constants.
@@ -96,16 +110,25 @@ MD5Update(struct MD5Context *ctx, unsigned char const *buf, unsigned len)
 			return;
 		}
 		memmove(p, buf, t);
-		byteReverse(ctx->in, 16);
+		byteReverseIn(ctx->in, 16);
 		MD5Transform(ctx->buf, (__u32 *) ctx->in);
 		buf += t;
 		len -= t;
 	}
 	/* Process data in 64-byte chunks */
 
+#ifdef CONFIG_MD5_FAST
+	if (((unsigned long)buf & 3) == 0) {
+		while (len >= 64) {
+			MD5Transform(ctx->buf, (__u32 const *) buf);
+			buf += 64;
+			len -= 64;
+		}
+	}
+#endif
 	while (len >= 64) {
 		memmove(ctx->in, buf, 64);
-		byteReverse(ctx->in, 16);
+		byteReverseIn(ctx->in, 16);
 		MD5Transform(ctx->buf, (__u32 *) ctx->in);
 		buf += 64;
 		len -= 64;
@@ -141,7 +164,7 @@ MD5Final(unsigned char digest[16], struct MD5Context *ctx)
 	if (count < 8) {
 		/* Two lots of padding:  Pad the first block to 64 bytes */
 		memset(p, 0, count);
-		byteReverse(ctx->in, 16);
+		byteReverseIn(ctx->in, 16);
 		MD5Transform(ctx->buf, (__u32 *) ctx->in);
 
 		/* Now fill the next block with 56 bytes */
@@ -150,11 +173,11 @@ MD5Final(unsigned char digest[16], struct MD5Context *ctx)
 		/* Pad block to 56 bytes */
 		memset(p, 0, count - 8);
 	}
-	byteReverse(ctx->in, 14);
+	byteReverseIn(ctx->in, 14);
 
 	/* Append length in bits and transform */
-	((__u32 *) ctx->in)[14] = ctx->bits[0];
-	((__u32 *) ctx->in)[15] = ctx->bits[1];
+	((__u32 *) ctx->in)[14] = MD5_PUT_IN(ctx->bits[0]);
+	((__u32 *) ctx->in)[15] = MD5_PUT_IN(ctx->bits[1]);
 
 	MD5Transform(ctx->buf, (__u32 *) ctx->in);
 	byteReverse((unsigned char *) ctx->buf, 4);
@@ -189,73 +212,73 @@ MD5Transform(__u32 buf[4], __u32 const in[16])
 	c = buf[2];
 	d = buf[3];
 
-	MD5STEP(F1, a, b, c, d, in[0] + 0xd76aa478, 7);
-	MD5STEP(F1, d, a, b, c, in[1] + 0xe8c7b756, 12);
-	MD5STEP(F1, c, d, a, b, in[2] + 0x242070db, 17);
-	MD5STEP(F1, b, c, d, a, in[3] + 0xc1bdceee, 22);
-	MD5STEP(F1, a, b, c, d, in[4] + 0xf57c0faf, 7);
-	MD5STEP(F1, d, a, b, c, in[5] + 0x4787c62a, 12);
-	MD5STEP(F1, c, d, a, b, in[6] + 0xa8304613, 17);
-	MD5STEP(F1, b, c, d, a, in[7] + 0xfd469501, 22);
-	MD5STEP(F1, a, b, c, d, in[8] + 0x698098d8, 7);
-	MD5STEP(F1, d, a, b, c, in[9] + 0x8b44f7af, 12);
-	MD5STEP(F1, c, d, a, b, in[10] + 0xffff5bb1, 17);
-	MD5STEP(F1, b, c, d, a, in[11] + 0x895cd7be, 22);
-	MD5STEP(F1, a, b, c, d, in[12] + 0x6b901122, 7);
-	MD5STEP(F1, d, a, b, c, in[13] + 0xfd987193, 12);
-	MD5STEP(F1, c, d, a, b, in[14] + 0xa679438e, 17);
-	MD5STEP(F1, b, c, d, a, in[15] + 0x49b40821, 22);
-
-	MD5STEP(F2, a, b, c, d, in[1] + 0xf61e2562, 5);
-	MD5STEP(F2, d, a, b, c, in[6] + 0xc040b340, 9);
-	MD5STEP(F2, c, d, a, b, in[11] + 0x265e5a51, 14);
-	MD5STEP(F2, b, c, d, a, in[0] + 0xe9b6c7aa, 20);
-	MD5STEP(F2, a, b, c, d, in[5] + 0xd62f105d, 5);
-	MD5STEP(F2, d, a, b, c, in[10] + 0x02441453, 9);
-	MD5STEP(F2, c, d, a, b, in[15] + 0xd8a1e681, 14);
-	MD5STEP(F2, b, c, d, a, in[4] + 0xe7d3fbc8, 20);
-	MD5STEP(F2, a, b, c, d, in[9] + 0x21e1cde6, 5);
-	MD5STEP(F2, d, a, b, c, in[14] + 0xc33707d6, 9);
-	MD5STEP(F2, c, d, a, b, in[3] + 0xf4d50d87, 14);
-	MD5STEP(F2, b, c, d, a, in[8] + 0x455a14ed, 20);
-	MD5STEP(F2, a, b, c, d, in[13] + 0xa9e3e905, 5);
-	MD5STEP(F2, d, a, b, c, in[2] + 0xfcefa3f8, 9);
-	MD5STEP(F2, c, d, a, b, in[7] + 0x676f02d9, 14);
-	MD5STEP(F2, b, c, d, a, in[12] + 0x8d2a4c8a, 20);
-
-	MD5STEP(F3, a, b, c, d, in[5] + 0xfffa3942, 4);
-	MD5STEP(F3, d, a, b, c, in[8] + 0x8771f681, 11);
-	MD5STEP(F3, c, d, a, b, in[11] + 0x6d9d6122, 16);
-	MD5STEP(F3, b, c, d, a, in[14] + 0xfde5380c, 23);
-	MD5STEP(F3, a, b, c, d, in[1] + 0xa4beea44, 4);
-	MD5STEP(F3, d, a, b, c, in[4] + 0x4bdecfa9, 11);
-	MD5STEP(F3, c, d, a, b, in[7] + 0xf6bb4b60, 16);
-	MD5STEP(F3, b, c, d, a, in[10] + 0xbebfbc70, 23);
-	MD5STEP(F3, a, b, c, d, in[13] + 0x289b7ec6, 4);
-	MD5STEP(F3, d, a, b, c, in[0] + 0xeaa127fa, 11);
-	MD5STEP(F3, c, d, a, b, in[3] + 0xd4ef3085, 16);
-	MD5STEP(F3, b, c, d, a, in[6] + 0x04881d05, 23);
-	MD5STEP(F3, a, b, c, d, in[9] + 0xd9d4d039, 4);
-	MD5STEP(F3, d, a, b, c, in[12] + 0xe6db99e5, 11);
-	MD5STEP(F3, c, d, a, b, in[15] + 0x1fa27cf8, 16);
-	MD5STEP(F3, b, c, d, a, in[2] + 0xc4ac5665, 23);
-
-	MD5STEP(F4, a, b, c, d, in[0] + 0xf4292244, 6);
-	MD5STEP(F4, d, a, b, c, in[7] + 0x432aff97, 10);
-	MD5STEP(F4, c, d, a, b, in[14] + 0xab9423a7, 15);
-	MD5STEP(F4, b, c, d, a, in[5] + 0xfc93a039, 21);
-	MD5STEP(F4, a, b, c, d, in[12] + 0x655b59c3, 6);
-	MD5STEP(F4, d, a, b, c, in[3] + 0x8f0ccc92, 10);
-	MD5STEP(F4, c, d, a, b, in[10] + 0xffeff47d, 15);
-	MD5STEP(F4, b, c, d, a, in[1] + 0x85845dd1, 21);
-	MD5STEP(F4, a, b, c, d, in[8] + 0x6fa87e4f, 6);
-	MD5STEP(F4, d, a, b, c, in[15] + 0xfe2ce6e0, 10);
-	MD5STEP(F4, c, d, a, b, in[6] + 0xa3014314, 15);
-	MD5STEP(F4, b, c, d, a, in[13] + 0x4e0811a1, 21);
-	MD5STEP(F4, a, b, c, d, in[4] + 0xf7537e82, 6);
-	MD5STEP(F4, d, a, b, c, in[11] + 0xbd3af235, 10);
-	MD5STEP(F4, c, d, a, b, in[2] + 0x2ad7d2bb, 15);
-	MD5STEP(F4, b, c, d, a, in[9] + 0xeb86d391, 21);
+	MD5STEP(F1, a, b, c, d, MD5_IN(in, 0) + 0xd76aa478, 7);
+	MD5STEP(F1, d, a, b, c, MD5_IN(in, 1) + 0xe8c7b756, 12);
+	MD5STEP(F1, c, d, a, b, MD5_IN(in, 2) + 0x242070db, 17);
+	MD5STEP(F1, b, c, d, a, MD5_IN(in, 3) + 0xc1bdceee, 22);
+	MD5STEP(F1, a, b, c, d, MD5_IN(in, 4) + 0xf57c0faf, 7);
+	MD5STEP(F1, d, a, b, c, MD5_IN(in, 5) + 0x4787c62a, 12);
+	MD5STEP(F1, c, d, a, b, MD5_IN(in, 6) + 0xa8304613, 17);
+	MD5STEP(F1, b, c, d, a, MD5_IN(in, 7) + 0xfd469501, 22);
+	MD5STEP(F1, a, b, c, d, MD5_IN(in, 8) + 0x698098d8, 7);
+	MD5STEP(F1, d, a, b, c, MD5_IN(in, 9) + 0x8b44f7af, 12);
+	MD5STEP(F1, c, d, a, b, MD5_IN(in, 10) + 0xffff5bb1, 17);
+	MD5STEP(F1, b, c, d, a, MD5_IN(in, 11) + 0x895cd7be, 22);
+	MD5STEP(F1, a, b, c, d, MD5_IN(in, 12) + 0x6b901122, 7);
+	MD5STEP(F1, d, a, b, c, MD5_IN(in, 13) + 0xfd987193, 12);
+	MD5STEP(F1, c, d, a, b, MD5_IN(in, 14) + 0xa679438e, 17);
+	MD5STEP(F1, b, c, d, a, MD5_IN(in, 15) + 0x49b40821, 22);
+
+	MD5STEP(F2, a, b, c, d, MD5_IN(in, 1) + 0xf61e2562, 5);
+	MD5STEP(F2, d, a, b, c, MD5_IN(in, 6) + 0xc040b340, 9);
+	MD5STEP(F2, c, d, a, b, MD5_IN(in, 11) + 0x265e5a51, 14);
+	MD5STEP(F2, b, c, d, a, MD5_IN(in, 0) + 0xe9b6c7aa, 20);
+	MD5STEP(F2, a, b, c, d, MD5_IN(in, 5) + 0xd62f105d, 5);
+	MD5STEP(F2, d, a, b, c, MD5_IN(in, 10) + 0x02441453, 9);
+	MD5STEP(F2, c, d, a, b, MD5_IN(in, 15) + 0xd8a1e681, 14);
+	MD5STEP(F2, b, c, d, a, MD5_IN(in, 4) + 0xe7d3fbc8, 20);
+	MD5STEP(F2, a, b, c, d, MD5_IN(in, 9) + 0x21e1cde6, 5);
+	MD5STEP(F2, d, a, b, c, MD5_IN(in, 14) + 0xc33707d6, 9);
+	MD5STEP(F2, c, d, a, b, MD5_IN(in, 3) + 0xf4d50d87, 14);
+	MD5STEP(F2, b, c, d, a, MD5_IN(in, 8) + 0x455a14ed, 20);
+	MD5STEP(F2, a, b, c, d, MD5_IN(in, 13) + 0xa9e3e905, 5);
+	MD5STEP(F2, d, a, b, c, MD5_IN(in, 2) + 0xfcefa3f8, 9);
+	MD5STEP(F2, c, d, a, b, MD5_IN(in, 7) + 0x676f02d9, 14);
+	MD5STEP(F2, b, c, d, a, MD5_IN(in, 12) + 0x8d2a4c8a, 20);
+
+	MD5STEP(F3, a, b, c, d, MD5_IN(in, 5) + 0xfffa3942, 4);
+	MD5STEP(F3, d, a, b, c, MD5_IN(in, 8) + 0x8771f681, 11);
+	MD5STEP(F3, c, d, a, b, MD5_IN(in, 11) + 0x6d9d6122, 16);
+	MD5STEP(F3, b, c, d, a, MD5_IN(in, 14) + 0xfde5380c, 23);
+	MD5STEP(F3, a, b, c, d, MD5_IN(in, 1) + 0xa4beea44, 4);
+	MD5STEP(F3, d, a, b, c, MD5_IN(in, 4) + 0x4bdecfa9, 11);
+	MD5STEP(F3, c, d, a, b, MD5_IN(in, 7) + 0xf6bb4b60, 16);
+	MD5STEP(F3, b, c, d, a, MD5_IN(in, 10) + 0xbebfbc70, 23);
+	MD5STEP(F3, a, b, c, d, MD5_IN(in, 13) + 0x289b7ec6, 4);
+	MD5STEP(F3, d, a, b, c, MD5_IN(in, 0) + 0xeaa127fa, 11);
+	MD5STEP(F3, c, d, a, b, MD5_IN(in, 3) + 0xd4ef3085, 16);
+	MD5STEP(F3, b, c, d, a, MD5_IN(in, 6) + 0x04881d05, 23);
+	MD5STEP(F3, a, b, c, d, MD5_IN(in, 9) + 0xd9d4d039, 4);
+	MD5STEP(F3, d, a, b, c, MD5_IN(in, 12) + 0xe6db99e5, 11);
+	MD5STEP(F3, c, d, a, b, MD5_IN(in, 15) + 0x1fa27cf8, 16);
+	MD5STEP(F3, b, c, d, a, MD5_IN(in, 2) + 0xc4ac5665, 23);
+
+	MD5STEP(F4, a, b, c, d, MD5_IN(in, 0) + 0xf4292244, 6);
+	MD5STEP(F4, d, a, b, c, MD5_IN(in, 7) + 0x432aff97, 10);
+	MD5STEP(F4, c, d, a, b, MD5_IN(in, 14) + 0xab9423a7, 15);
+	MD5STEP(F4, b, c, d, a, MD5_IN(in, 5) + 0xfc93a039, 21);
+	MD5STEP(F4, a, b, c, d, MD5_IN(in, 12) + 0x655b59c3, 6);
+	MD5STEP(F4, d, a, b, c, MD5_IN(in, 3) + 0x8f0ccc92, 10);
+	MD5STEP(F4, c, d, a, b, MD5_IN(in, 10) + 0xffeff47d, 15);
+	MD5STEP(F4, b, c, d, a, MD5_IN(in, 1) + 0x85845dd1, 21);
+	MD5STEP(F4, a, b, c, d, MD5_IN(in, 8) + 0x6fa87e4f, 6);
+	MD5STEP(F4, d, a, b, c, MD5_IN(in, 15) + 0xfe2ce6e0, 10);
+	MD5STEP(F4, c, d, a, b, MD5_IN(in, 6) + 0xa3014314, 15);
+	MD5STEP(F4, b, c, d, a, MD5_IN(in, 13) + 0x4e0811a1, 21);
+	MD5STEP(F4, a, b, c, d, MD5_IN(in, 4) + 0xf7537e82, 6);
+	MD5STEP(F4, d, a, b, c, MD5_IN(in, 11) + 0xbd3af235, 10);
+	MD5STEP(F4, c, d, a, b, MD5_IN(in, 2) + 0x2ad7d2bb, 15);
+	MD5STEP(F4, b, c, d, a, MD5_IN(in, 9) + 0xeb86d391, 21);
 
 	buf[0] += a;
 	buf[1] += b;
@@ -41,3 +41,13 @@ void udelay(unsigned long usec)
 		usec -= kv;
 	} while(usec);
 }
+
+/*
+ * Timers without sub-microsecond resolution round up to udelay().
+ */
+void __ndelay(unsigned long nsec)
+{
+	udelay((nsec + 999) / 1000);
+}
+void ndelay(unsigned long nsec)
+	__attribute__((weak, alias("__ndelay")));
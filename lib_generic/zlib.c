@@ -625,6 +625,55 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
 		    unsigned long loops;
 
                     from = out - dist;          /* copy direct from output */
+#ifdef CONFIG_ZLIB_WORD_COPY
+		    /*
+		     * Long matches whose source and destination can both be
+		     * word aligned (dist a multiple of 4) or that replicate a
+		     * 1, 2 or 4 byte pattern are done a word at a time. Both
+		     * pointers stay aligned, so this is safe on ARMv4.
+		     */
+		    if (len >= 8 && (dist <= 2 || (dist & 3) == 0)) {
+			u32 *wout;
+
+			while ((unsigned long)(out + OFF) & 3) {
+			    PUP(out) = PUP(from);
+			    len--;
+			}
+			wout = (u32 *)(out + OFF - 4);
+			loops = len >> 2;
+			if (dist >= 4) {
+			    u32 *wfrom;
+
+			    wfrom = (u32 *)(from + OFF - 4);
+			    do
+				PUP(wout) = PUP(wfrom);
+			    while (--loops);
+			    from = (unsigned char *)wfrom + 4 - OFF;
+			} else {
+			    union {
+				u32 w;
+				unsigned char b[4];
+			    } pat;
+
+			    /* from + OFF .. out is one full period */
+			    pat.b[0] = from[OFF];
+			    pat.b[1] = from[OFF + (1 % dist)];
+			    pat.b[2] = from[OFF + (2 % dist)];
+			    pat.b[3] = from[OFF + (3 % dist)];
+			    do
+				PUP(wout) = pat.w;
+			    while (--loops);
+			    from = (unsigned char *)wout + 4 - OFF - dist;
+			}
+			out = (unsigned char *)wout + 4 - OFF;
+			len &= 3;
+			while (len) {
+			    PUP(out) = PUP(from);
+			    len--;
+			}
+			continue;
+		    }
+#endif
                     /* minimum length is three */
 		    /* Align out addr */
 		    if (!((long)(out - 1 + OFF) & 1)) {
@@ -213,5 +213,7 @@ int fdt_move(const void *fdt, void *buf, int bufsize)
 		return -FDT_ERR_NOSPACE;
 
 	memmove(buf, fdt, fdt_totalsize(fdt));
+	if (buf != fdt)
+		_fdt_index_invalidate(buf);
 	return 0;
 }
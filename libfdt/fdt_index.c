@@ -0,0 +1,435 @@
+/*
+ * libfdt - Flat Device Tree manipulation
+ * Copyright (C) 2006 David Gibson, IBM Corporation.
+ *
+ * libfdt is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This library is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This library is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "libfdt_env.h"
+
+#ifndef USE_HOSTCC
+#include <fdt.h>
+#include <libfdt.h>
+#else
+#include "fdt_host.h"
+#endif
+
+#include "libfdt_internal.h"
+
+/*
+ * Lookup index: one pass over the structure block records every node
+ * (offset, parent, phandle, whether it has a compatible property) in
+ * offset order, with hash chains by (parent, name without unit address)
+ * and by phandle. fdt_subnode_offset_namelen(), and so fdt_path_offset(),
+ * fdt_node_offset_by_phandle() and fdt_node_offset_by_compatible() use
+ * it instead of scanning the tree.
+ *
+ * The read-write functions keep it valid: splices that only move nodes
+ * shift the recorded offsets, everything else marks the index stale and
+ * it is rebuilt on the next lookup. A stale index that no longer fits
+ * its buffer is simply not used.
+ *
+ * A tree written over the indexed one without libfdt (a new DTB loaded
+ * to the same address) is caught by the header fields the index keeps,
+ * and by checking that the last node is still where it was recorded.
+ * Phandle results are verified against the tree before they are
+ * returned, a mismatch drops back to the scan.
+ */
+
+#define FDT_INDEX_COMPAT	0x1
+
+struct fdt_index_node {
+	int		offset;
+	int		parent;		/* index of the parent, -1 for root */
+	uint32_t	hash;		/* of parent and name up to '@' */
+	uint32_t	phandle;
+	int		next_name;	/* hash chains, ascending, -1 ends */
+	int		next_phandle;
+	int		flags;
+};
+
+struct fdt_index {
+	const void	*fdt;
+	int		valid;
+	/* header of the indexed tree, see _fdt_index_get() */
+	uint32_t	magic;
+	uint32_t	totalsize;
+	uint32_t	version;
+	uint32_t	off_dt_struct;
+	uint32_t	size_dt_struct;
+	int		max_nodes;
+	int		nodes;
+	unsigned int	mask;		/* hash buckets - 1 */
+	int		*name_bucket;
+	int		*phandle_bucket;
+	struct fdt_index_node *node;
+};
+
+/* Bytes per node: the node itself and one bucket of each table */
+#define FDT_INDEX_NODE_SIZE \
+	(sizeof(struct fdt_index_node) + 2 * sizeof(int))
+
+static struct fdt_index *_fdt_idx;
+
+static uint32_t _fdt_index_hash(int parent, const char *name, int len)
+{
+	uint32_t h = 2166136261u ^ (uint32_t)parent;
+
+	while (len-- && *name != '@') {
+		h ^= (unsigned char)*name++;
+		h *= 16777619;
+	}
+	return h;
+}
+
+static int _fdt_index_build(struct fdt_index *idx)
+{
+	const void *fdt = idx->fdt;
+	struct fdt_index_node *n;
+	int offset, nextoffset = 0;
+	int cur = -1, i, len;
+	uint32_t tag;
+	const char *name;
+	const struct fdt_property *prop;
+
+	idx->valid = 0;
+	idx->nodes = 0;
+	idx->magic = fdt_magic(fdt);
+	idx->totalsize = fdt_totalsize(fdt);
+	idx->version = fdt_version(fdt);
+	idx->off_dt_struct = fdt_off_dt_struct(fdt);
+	idx->size_dt_struct = fdt_size_dt_struct(fdt);
+
+	do {
+		offset = nextoffset;
+		tag = fdt_next_tag(fdt, offset, &nextoffset);
+
+		switch (tag) {
+		case FDT_BEGIN_NODE:
+			if (idx->nodes == idx->max_nodes)
+				return -FDT_ERR_NOSPACE;
+			name = fdt_get_name(fdt, offset, &len);
+			if (!name)
+				return len;
+			n = &idx->node[idx->nodes];
+			n->offset = offset;
+			n->parent = cur;
+			n->hash = _fdt_index_hash(cur, name, len);
+			n->phandle = 0;
+			n->flags = 0;
+			cur = idx->nodes++;
+			break;
+
+		case FDT_PROP:
+			if (cur < 0)
+				return -FDT_ERR_BADSTRUCTURE;
+			prop = fdt_offset_ptr(fdt, offset, sizeof(*prop));
+			name = fdt_string(fdt, fdt32_to_cpu(prop->nameoff));
+			len = fdt32_to_cpu(prop->len);
+			if (!strcmp(name, "linux,phandle") &&
+			    len == sizeof(uint32_t))
+				idx->node[cur].phandle =
+					fdt32_to_cpu(*(const uint32_t *)prop->data);
+			else if (!strcmp(name, "compatible"))
+				idx->node[cur].flags |= FDT_INDEX_COMPAT;
+			break;
+
+		case FDT_END_NODE:
+			if (cur < 0)
+				return -FDT_ERR_BADSTRUCTURE;
+			cur = idx->node[cur].parent;
+			break;
+
+		case FDT_NOP:
+			break;
+
+		default:
+			if (nextoffset < 0)
+				return nextoffset;
+			break;
+		}
+	} while (tag != FDT_END && (cur >= 0 || !idx->nodes));
+
+	if (cur >= 0 || !idx->nodes)
+		return -FDT_ERR_BADSTRUCTURE;
+
+	/* fill the chains back to front so they come out ascending */
+	for (i = 0; i <= idx->mask; i++)
+		idx->name_bucket[i] = idx->phandle_bucket[i] = -1;
+	for (i = idx->nodes - 1; i >= 0; i--) {
+		n = &idx->node[i];
+		n->next_name = idx->name_bucket[n->hash & idx->mask];
+		idx->name_bucket[n->hash & idx->mask] = i;
+		if (n->phandle) {
+			n->next_phandle =
+				idx->phandle_bucket[n->phandle & idx->mask];
+			idx->phandle_bucket[n->phandle & idx->mask] = i;
+		}
+	}
+
+	idx->valid = 1;
+	return 0;
+}
+
+int fdt_index_size(const void *fdt)
+{
+	int offset, nodes = 0;
+
+	FDT_CHECK_HEADER(fdt);
+
+	for (offset = 0; offset >= 0; offset = fdt_next_node(fdt, offset, NULL))
+		nodes++;
+	if (offset != -FDT_ERR_NOTFOUND)
+		return offset;
+
+	return sizeof(struct fdt_index) + nodes * FDT_INDEX_NODE_SIZE;
+}
+
+int fdt_index_attach(const void *fdt, void *buf, int bufsize)
+{
+	struct fdt_index *idx = buf;
+	int max_nodes, buckets, err;
+
+	FDT_CHECK_HEADER(fdt);
+
+	_fdt_idx = NULL;
+
+	max_nodes = (bufsize - (int)sizeof(*idx)) / (int)FDT_INDEX_NODE_SIZE;
+	if (max_nodes < 1)
+		return -FDT_ERR_NOSPACE;
+	for (buckets = 1; buckets * 2 <= max_nodes; buckets *= 2)
+		;
+
+	idx->fdt = fdt;
+	idx->max_nodes = max_nodes;
+	idx->mask = buckets - 1;
+	idx->name_bucket = (int *)(idx + 1);
+	idx->phandle_bucket = idx->name_bucket + buckets;
+	idx->node = (struct fdt_index_node *)(idx->phandle_bucket + buckets);
+
+	err = _fdt_index_build(idx);
+	if (err)
+		return err;
+
+	_fdt_idx = idx;
+	return 0;
+}
+
+void fdt_index_detach(void)
+{
+	_fdt_idx = NULL;
+}
+
+/*
+ * Whether the tree at idx->fdt still is the indexed one: same header,
+ * and the last node still starts where it was recorded, with the name
+ * it had. The last node moves with any edit before it.
+ */
+static int _fdt_index_current(const struct fdt_index *idx)
+{
+	const void *fdt = idx->fdt;
+	const struct fdt_index_node *n;
+	const char *name;
+	int len;
+
+	if (fdt_magic(fdt) != idx->magic ||
+	    fdt_totalsize(fdt) != idx->totalsize ||
+	    fdt_version(fdt) != idx->version ||
+	    fdt_off_dt_struct(fdt) != idx->off_dt_struct ||
+	    fdt_size_dt_struct(fdt) != idx->size_dt_struct)
+		return 0;
+
+	n = &idx->node[idx->nodes - 1];
+	name = fdt_get_name(fdt, n->offset, &len);
+	return name && _fdt_index_hash(n->parent, name, len) == n->hash;
+}
+
+/* The index for fdt if there is a usable one, rebuilding it if stale */
+static struct fdt_index *_fdt_index_get(const void *fdt)
+{
+	struct fdt_index *idx = _fdt_idx;
+
+	if (!idx || idx->fdt != fdt)
+		return NULL;
+	if (idx->valid && !_fdt_index_current(idx))
+		idx->valid = 0;
+	if (!idx->valid && _fdt_index_build(idx))
+		return NULL;
+	return idx;
+}
+
+/* Position of the first node at or after offset */
+static int _fdt_index_find(const struct fdt_index *idx, int offset)
+{
+	int lo = 0, hi = idx->nodes;
+
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+
+		if (idx->node[mid].offset < offset)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+int _fdt_index_subnode(const void *fdt, int offset, const char *name,
+		       int namelen)
+{
+	const struct fdt_index *idx = _fdt_index_get(fdt);
+	const struct fdt_index_node *n;
+	const char *p;
+	uint32_t hash;
+	int parent, i, len;
+
+	if (!idx)
+		return -FDT_ERR_INTERNAL;
+
+	parent = _fdt_index_find(idx, offset);
+	if (parent == idx->nodes || idx->node[parent].offset != offset)
+		return -FDT_ERR_INTERNAL;
+
+	/* same match rules as _fdt_nodename_eq() */
+	hash = _fdt_index_hash(parent, name, namelen);
+	for (i = idx->name_bucket[hash & idx->mask]; i >= 0; i = n->next_name) {
+		n = &idx->node[i];
+		if (n->hash != hash || n->parent != parent)
+			continue;
+		p = fdt_get_name(fdt, n->offset, &len);
+		if (!p || len < namelen || memcmp(p, name, namelen))
+			continue;
+		if (len == namelen ||
+		    (p[namelen] == '@' && !memchr(name, '@', namelen)))
+			return n->offset;
+	}
+
+	return -FDT_ERR_NOTFOUND;
+}
+
+int _fdt_index_phandle(const void *fdt, uint32_t phandle)
+{
+	struct fdt_index *idx = _fdt_index_get(fdt);
+	int i;
+
+	if (!idx)
+		return -FDT_ERR_INTERNAL;
+
+	for (i = idx->phandle_bucket[phandle & idx->mask]; i >= 0;
+	     i = idx->node[i].next_phandle) {
+		if (idx->node[i].phandle != phandle)
+			continue;
+		if (fdt_get_phandle(fdt, idx->node[i].offset) == phandle)
+			return idx->node[i].offset;
+		/* changed behind the index's back, scan this time */
+		idx->valid = 0;
+		return -FDT_ERR_INTERNAL;
+	}
+
+	return -FDT_ERR_NOTFOUND;
+}
+
+int _fdt_index_compatible(const void *fdt, int startoffset,
+			  const char *compatible)
+{
+	const struct fdt_index *idx = _fdt_index_get(fdt);
+	int i, err;
+
+	if (!idx)
+		return -FDT_ERR_INTERNAL;
+
+	i = _fdt_index_find(idx, startoffset);
+	if (startoffset >= 0) {
+		/* leave bad offsets to fdt_next_node() */
+		if (i == idx->nodes || idx->node[i].offset != startoffset)
+			return -FDT_ERR_INTERNAL;
+		i++;
+	}
+
+	for (; i < idx->nodes; i++) {
+		if (!(idx->node[i].flags & FDT_INDEX_COMPAT))
+			continue;
+		err = fdt_node_check_compatible(fdt, idx->node[i].offset,
+						compatible);
+		if (err < 0 && err != -FDT_ERR_NOTFOUND)
+			return err;
+		else if (err == 0)
+			return idx->node[i].offset;
+	}
+
+	return -FDT_ERR_NOTFOUND;
+}
+
+void _fdt_index_splice(const void *fdt, int offset, int oldlen, int newlen)
+{
+	struct fdt_index *idx = _fdt_idx;
+	int i;
+
+	if (!idx || idx->fdt != fdt || !idx->valid || oldlen == newlen)
+		return;
+
+	idx->size_dt_struct += newlen - oldlen;
+	for (i = _fdt_index_find(idx, offset + oldlen); i < idx->nodes; i++)
+		idx->node[i].offset += newlen - oldlen;
+}
+
+void _fdt_index_moved(const void *fdt, int delta)
+{
+	if (_fdt_idx && _fdt_idx->fdt == fdt)
+		_fdt_idx->off_dt_struct += delta;
+}
+
+void _fdt_index_invalidate(const void *fdt)
+{
+	if (_fdt_idx && _fdt_idx->fdt == fdt)
+		_fdt_idx->valid = 0;
+}
+
+void _fdt_index_prop_changed(const void *fdt, const char *name)
+{
+	if (!strcmp(name, "linux,phandle") || !strcmp(name, "compatible"))
+		_fdt_index_invalidate(fdt);
+}
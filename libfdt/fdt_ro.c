@@ -112,10 +112,14 @@ int fdt_num_mem_rsv(const void *fdt)
 int fdt_subnode_offset_namelen(const void *fdt, int offset,
 			       const char *name, int namelen)
 {
-	int depth;
+	int depth, sub;
 
 	FDT_CHECK_HEADER(fdt);
 
+	sub = _fdt_index_subnode(fdt, offset, name, namelen);
+	if (sub != -FDT_ERR_INTERNAL)
+		return sub;
+
 	for (depth = 0;
 	     (offset >= 0) && (depth >= 0);
 	     offset = fdt_next_node(fdt, offset, &depth))
@@ -440,8 +444,13 @@ int fdt_node_offset_by_prop_value(const void *fdt, int startoffset,
 
 int fdt_node_offset_by_phandle(const void *fdt, uint32_t phandle)
 {
+	int offset;
+
 	if ((phandle == 0) || (phandle == -1))
 		return -FDT_ERR_BADPHANDLE;
+	offset = _fdt_index_phandle(fdt, phandle);
+	if (offset != -FDT_ERR_INTERNAL)
+		return offset;
 	phandle = cpu_to_fdt32(phandle);
 	return fdt_node_offset_by_prop_value(fdt, -1, "linux,phandle",
 					     &phandle, sizeof(phandle));
@@ -487,6 +496,10 @@ int fdt_node_offset_by_compatible(const void *fdt, int startoffset,
 
 	FDT_CHECK_HEADER(fdt);
 
+	offset = _fdt_index_compatible(fdt, startoffset, compatible);
+	if (offset != -FDT_ERR_INTERNAL)
+		return offset;
+
 	/* FIXME: The algorithm here is pretty horrible: we scan each
 	 * property of a node in fdt_node_check_compatible(), then if
 	 * that didn't find what we want, we scan over them again
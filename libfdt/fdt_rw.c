@@ -119,6 +119,7 @@ static int _fdt_splice_mem_rsv(void *fdt, struct fdt_reserve_entry *p,
 	err = _fdt_splice(fdt, p, oldn * sizeof(*p), newn * sizeof(*p));
 	if (err)
 		return err;
+	_fdt_index_moved(fdt, delta);
 	fdt_set_off_dt_struct(fdt, fdt_off_dt_struct(fdt) + delta);
 	fdt_set_off_dt_strings(fdt, fdt_off_dt_strings(fdt) + delta);
 	return 0;
@@ -133,6 +134,8 @@ static int _fdt_splice_struct(void *fdt, void *p,
 	if ((err = _fdt_splice(fdt, p, oldlen, newlen)))
 		return err;
 
+	_fdt_index_splice(fdt, (char *)p - (char *)_fdt_offset_ptr(fdt, 0),
+			  oldlen, newlen);
 	fdt_set_size_dt_struct(fdt, fdt_size_dt_struct(fdt) + delta);
 	fdt_set_off_dt_strings(fdt, fdt_off_dt_strings(fdt) + delta);
 	return 0;
@@ -272,6 +275,7 @@ int fdt_set_name(void *fdt, int nodeoffset, const char *name)
 		return err;
 
 	memcpy(namep, name, newlen+1);
+	_fdt_index_invalidate(fdt);
 	return 0;
 }
 
@@ -290,6 +294,7 @@ int fdt_setprop(void *fdt, int nodeoffset, const char *name,
 		return err;
 
 	memcpy(prop->data, val, len);
+	_fdt_index_prop_changed(fdt, name);
 	return 0;
 }
 
@@ -304,6 +309,7 @@ int fdt_delprop(void *fdt, int nodeoffset, const char *name)
 	if (! prop)
 		return len;
 
+	_fdt_index_prop_changed(fdt, name);
 	proplen = sizeof(*prop) + FDT_TAGALIGN(len);
 	return _fdt_splice_struct(fdt, prop, proplen, 0);
 }
@@ -345,6 +351,7 @@ int fdt_add_subnode_namelen(void *fdt, int parentoffset,
 	memcpy(nh->name, name, namelen);
 	endtag = (uint32_t *)((char *)nh + nodelen - FDT_TAGSIZE);
 	*endtag = cpu_to_fdt32(FDT_END_NODE);
+	_fdt_index_invalidate(fdt);
 
 	return offset;
 }
@@ -364,6 +371,7 @@ int fdt_del_node(void *fdt, int nodeoffset)
 	if (endoffset < 0)
 		return endoffset;
 
+	_fdt_index_invalidate(fdt);
 	return _fdt_splice_struct(fdt, _fdt_offset_ptr_w(fdt, nodeoffset),
 				  endoffset - nodeoffset, 0);
 }
@@ -444,6 +452,7 @@ int fdt_open_into(const void *fdt, void *buf, int bufsize)
 
 	_fdt_packblocks(fdt, tmp, mem_rsv_size, struct_size);
 	memmove(buf, tmp, newsize);
+	_fdt_index_invalidate(buf);
 
 	fdt_set_magic(buf, FDT_MAGIC);
 	fdt_set_totalsize(buf, bufsize);
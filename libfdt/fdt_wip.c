@@ -73,6 +73,7 @@ int fdt_setprop_inplace(void *fdt, int nodeoffset, const char *name,
 		return -FDT_ERR_NOSPACE;
 
 	memcpy(propval, val, len);
+	_fdt_index_prop_changed(fdt, name);
 	return 0;
 }
 
@@ -94,6 +95,7 @@ int fdt_nop_property(void *fdt, int nodeoffset, const char *name)
 		return len;
 
 	_fdt_nop_region(prop, len + sizeof(*prop));
+	_fdt_index_prop_changed(fdt, name);
 
 	return 0;
 }
@@ -118,5 +120,6 @@ int fdt_nop_node(void *fdt, int nodeoffset)
 
 	_fdt_nop_region(fdt_offset_ptr_w(fdt, nodeoffset, 0),
 			endoffset - nodeoffset);
+	_fdt_index_invalidate(fdt);
 	return 0;
 }
@@ -66,6 +66,20 @@ int _fdt_check_node_offset(const void *fdt, int offset);
 const char *_fdt_find_string(const char *strtab, int tabsize, const char *s);
 int _fdt_node_end_offset(void *fdt, int nodeoffset);
 
+/*
+ * Lookup index hooks, see fdt_index.c. The lookups return
+ * -FDT_ERR_INTERNAL if fdt has no usable index; callers then scan.
+ */
+int _fdt_index_subnode(const void *fdt, int offset, const char *name,
+		       int namelen);
+int _fdt_index_phandle(const void *fdt, uint32_t phandle);
+int _fdt_index_compatible(const void *fdt, int startoffset,
+			  const char *compatible);
+void _fdt_index_splice(const void *fdt, int offset, int oldlen, int newlen);
+void _fdt_index_moved(const void *fdt, int delta);
+void _fdt_index_invalidate(const void *fdt);
+void _fdt_index_prop_changed(const void *fdt, const char *name);
+
 static inline const void *_fdt_offset_ptr(const void *fdt, int offset)
 {
 	return (const char *)fdt + fdt_off_dt_struct(fdt) + offset;
@@ -21,6 +21,7 @@
 #include <common.h>
 #include <nand.h>
 #include <asm/io.h>
+#include <bootstage.h>
 
 #define CONFIG_SYS_NAND_READ_DELAY \
 	{ volatile int dummy; int i; for (i=0; i<10000; i++) dummy = i; }
@@ -216,6 +217,7 @@ static int nand_load(struct mtd_info *mtd, unsigned int offs,
 				nand_read_page(mtd, block, page, dst);
 				dst += CONFIG_SYS_NAND_PAGE_SIZE;
 				page++;
+				bootstage_spl_poll();
 			}
 
 			page = 0;
@@ -241,6 +243,8 @@ void nand_boot(void)
 	int ret;
 	__attribute__((noreturn)) void (*uboot)(void);
 
+	bootstage_spl_start();
+
 	/*
 	 * Init board specific nand support
 	 */
@@ -257,6 +261,7 @@ void nand_boot(void)
 	 */
 	ret = nand_load(&nand_info, CONFIG_SYS_NAND_U_BOOT_OFFS, CONFIG_SYS_NAND_U_BOOT_SIZE,
 			(uchar *)CONFIG_SYS_NAND_U_BOOT_DST);
+	bootstage_spl_mark(BOOTSTAGE_SPL_UBOOT_LOADED);
 
 #ifdef CONFIG_NAND_ENV_DST
 	nand_load(&nand_info, CONFIG_ENV_OFFSET, CONFIG_ENV_SIZE,
@@ -266,6 +271,7 @@ void nand_boot(void)
 	nand_load(&nand_info, CONFIG_ENV_OFFSET_REDUND, CONFIG_ENV_SIZE,
 		  (uchar *)CONFIG_NAND_ENV_DST + CONFIG_ENV_SIZE);
 #endif
+	bootstage_spl_mark(BOOTSTAGE_SPL_ENV_LOADED);
 #endif
 
 	if (nand_chip.select_chip)
@@ -275,5 +281,6 @@ void nand_boot(void)
 	 * Jump to U-Boot image
 	 */
 	uboot = (void *)CONFIG_SYS_NAND_U_BOOT_START;
+	bootstage_spl_mark(BOOTSTAGE_SPL_JUMP);
 	(*uboot)();
 }
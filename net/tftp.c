@@ -172,6 +172,25 @@ store_block (unsigned block, uchar * src, unsigned len)
 		NetBootFileXferSize = newsize;
 }
 
+#ifdef CONFIG_CMD_NAND_TFTP
+struct tftp_sink *TftpSink;		/* replaces the copy to load_addr */
+
+static void
+store_sink (unsigned block, uchar * src, unsigned len)
+{
+	ulong offset = block * TftpBlkSize + TftpBlockWrapOffset;
+	ulong newsize = offset + len;
+
+	if (TftpSink->store(TftpSink->priv, offset, src, len)) {
+		NetState = NETLOOP_FAIL;
+		return;
+	}
+
+	if (NetBootFileXferSize < newsize)
+		NetBootFileXferSize = newsize;
+}
+#endif
+
 static void TftpSend (void);
 static void TftpTimeout (void);
 
@@ -416,6 +435,11 @@ TftpHandler (uchar * pkt, unsigned dest, unsigned src, unsigned len)
 		TftpTimeoutCountMax = TIMEOUT_COUNT;
 		NetSetTimeout (TftpTimeoutMSecs, TftpTimeout);
 
+#ifdef CONFIG_CMD_NAND_TFTP
+		if (TftpSink)
+			store_sink (TftpBlock - 1, pkt + 2, len);
+		else
+#endif
 		store_block (TftpBlock - 1, pkt + 2, len);
 
 		/*
@@ -449,6 +473,21 @@ TftpHandler (uchar * pkt, unsigned dest, unsigned src, unsigned len)
 #endif
 		TftpSend ();
 
+#ifdef CONFIG_CMD_NAND_TFTP
+		/*
+		 * Slow sink work (flash programming) runs while the server
+		 * already sends the next block, which the ethernet chip
+		 * buffers meanwhile.
+		 */
+		if (TftpSink && TftpSink->flush &&
+		    TftpSink->flush(TftpSink->priv))
+			NetState = NETLOOP_FAIL;
+#endif
+
+		/* A failed store must not be reported as done */
+		if (NetState == NETLOOP_FAIL)
+			break;
+
 #ifdef CONFIG_MCAST_TFTP
 		if (Multicast) {
 			if (MasterClient && (TftpBlock >= TftpEndingBlock)) {
@@ -598,6 +637,11 @@ TftpStart (void)
 
 	putc ('\n');
 
+#ifdef CONFIG_CMD_NAND_TFTP
+	if (TftpSink)
+		puts ("Load address: streaming to flash\n");
+	else
+#endif
 	printf ("Load address: 0x%lx\n", load_addr);
 
 	puts ("Loading: *\b");
@@ -0,0 +1,348 @@
+/*
+ * Host test and benchmark for the BCH encoder/decoder in lib_generic/bch.c
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * Every encoded block is checked to be a codeword by evaluating it at
+ * alpha^1 .. alpha^2t with GF arithmetic of this file's own, so the
+ * encoder is not only checked against the decoder.  Then 0 .. t random
+ * bit errors are injected in data and ecc, and the decoder must report
+ * exactly the flipped bits, through both of its entry points (stored
+ * and calculated ecc, or data).  More than t errors must never be
+ * "corrected" into anything but a codeword.
+ *
+ * bch.c is built for the host board (test/board).
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/bch.h>
+#include "bench.h"
+
+struct bch_config {
+	int m, t;
+	unsigned int poly;	/* primitive polynomial of GF(2^m) */
+	unsigned int len;	/* data bytes per block */
+};
+
+/*
+ * The NAND setups (4 and 8 bits per 512 bytes, 16 per 1024) exercise the
+ * two unrolled encoder paths; the others the generic one, the smallest
+ * field and odd lengths.
+ */
+static const struct bch_config configs[] = {
+	{ 13,  4, 0x201b,  512 },
+	{ 13,  8, 0x201b,  512 },
+	{ 14, 16, 0x402b, 1024 },
+	{ 13, 12, 0x201b,  511 },
+	{  5,  2, 0x25,      2 },
+	{  8,  4, 0x11d,    27 },
+};
+
+#define MAX_BYTES	(1024 + 32)
+
+/* Reference GF(2^m) arithmetic, bit by bit */
+static unsigned int gf_mul_ref(unsigned int a, unsigned int b, int m,
+			       unsigned int poly)
+{
+	unsigned int r = 0;
+
+	while (b) {
+		if (b & 1)
+			r ^= a;
+		b >>= 1;
+		a <<= 1;
+		if (a & (1u << m))
+			a ^= poly;
+	}
+	return r;
+}
+
+/*
+ * Evaluate the codeword (data MSB first, then ecc_bits of ecc) at
+ * alpha^j for j = 1 .. 2t; all must be zero.
+ */
+static int is_codeword(struct bch_control *bch, const struct bch_config *c,
+		       const uint8_t *data, const uint8_t *ecc)
+{
+	unsigned int j, k, x, acc, nbits = 8 * c->len;
+
+	for (j = 1, x = 2; j <= 2 * c->t; j++) {
+		acc = 0;
+		for (k = 0; k < nbits; k++)
+			acc = gf_mul_ref(acc, x, c->m, c->poly) ^
+				((data[k >> 3] >> (7 - (k & 7))) & 1);
+		for (k = 0; k < bch->ecc_bits; k++)
+			acc = gf_mul_ref(acc, x, c->m, c->poly) ^
+				((ecc[k >> 3] >> (7 - (k & 7))) & 1);
+		if (acc)
+			return 0;
+		x = gf_mul_ref(x, 2, c->m, c->poly);
+	}
+	return 1;
+}
+
+static void flip(uint8_t *data, uint8_t *ecc, unsigned int len,
+		 unsigned int bit)
+{
+	/* decoder numbering: LSB first within bytes, ecc after data */
+	if (bit < 8 * len)
+		data[bit >> 3] ^= 1 << (bit & 7);
+	else
+		ecc[(bit - 8 * len) >> 3] ^= 1 << (bit & 7);
+}
+
+/* Pick n distinct positions among the bits the code covers */
+static void pick_errors(struct bch_control *bch, unsigned int len,
+			unsigned int *pos, int n, unsigned int *seed)
+{
+	unsigned int nbits = 8 * len + bch->ecc_bits, bit;
+	int i, j;
+
+	for (i = 0; i < n; i++) {
+again:
+		bit = bench_rand(seed) % nbits;
+		/* skip the padding bits at the end of the last ecc byte */
+		if (bit >= 8 * len &&
+		    (bit - 8 * len) / 8 * 8 + 7 - ((bit - 8 * len) & 7) >=
+		    bch->ecc_bits)
+			goto again;
+		for (j = 0; j < i; j++)
+			if (pos[j] == bit)
+				goto again;
+		pos[i] = bit;
+	}
+}
+
+static int cmp_uint(const void *a, const void *b)
+{
+	unsigned int x = *(const unsigned int *)a, y = *(const unsigned int *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+static int check_config(const struct bch_config *c, unsigned int seed,
+			int rounds)
+{
+	struct bch_control *bch;
+	uint8_t data[MAX_BYTES], good[MAX_BYTES], ecc[64], recv[64], calc[64];
+	unsigned int errloc[64], pos[64];
+	int n, nerr, i, ret, fail = 0, miscorrect = 0;
+
+	bch = init_bch(c->m, c->t, c->poly);
+	if (!bch) {
+		printf("  m=%d t=%d: init_bch failed\n", c->m, c->t);
+		return 1;
+	}
+
+	for (n = 0; n < rounds && !fail; n++) {
+		bench_fill(good, c->len, &seed);
+		memset(ecc, 0, sizeof(ecc));
+		encode_bch(bch, good, c->len, ecc);
+		if (n < 16 && !is_codeword(bch, c, good, ecc)) {
+			printf("  m=%d t=%d len=%u: not a codeword (seed %u)\n",
+			       c->m, c->t, c->len, seed);
+			fail++;
+			break;
+		}
+
+		for (nerr = 0; nerr <= c->t + 1; nerr++) {
+			memcpy(data, good, c->len);
+			memcpy(recv, ecc, bch->ecc_bytes);
+			pick_errors(bch, c->len, pos, nerr, &seed);
+			for (i = 0; i < nerr; i++)
+				flip(data, recv, c->len, pos[i]);
+
+			/* as nand_bch does: ecc of the data read, then decode */
+			memset(calc, 0, sizeof(calc));
+			encode_bch(bch, data, c->len, calc);
+			ret = decode_bch(bch, NULL, c->len, recv, calc, errloc);
+
+			if (nerr > c->t) {
+				if (ret < 0)
+					continue;
+				/* must have landed on another codeword */
+				for (i = 0; i < ret; i++)
+					flip(data, recv, c->len, errloc[i]);
+				if (ret > c->t ||
+				    !is_codeword(bch, c, data, recv)) {
+					printf("  m=%d t=%d: %d errors, bogus "
+					       "correction (seed %u)\n", c->m,
+					       c->t, nerr, seed);
+					fail++;
+				}
+				miscorrect++;
+				continue;
+			}
+
+			if (ret != nerr) {
+				printf("  m=%d t=%d: %d errors, decode "
+				       "returned %d (seed %u)\n", c->m, c->t,
+				       nerr, ret, seed);
+				fail++;
+				continue;
+			}
+			qsort(pos, nerr, sizeof(*pos), cmp_uint);
+			qsort(errloc, ret, sizeof(*errloc), cmp_uint);
+			if (memcmp(pos, errloc, nerr * sizeof(*pos))) {
+				printf("  m=%d t=%d: %d errors, wrong "
+				       "locations (seed %u)\n", c->m, c->t,
+				       nerr, seed);
+				fail++;
+				continue;
+			}
+
+			/* the data entry point must agree */
+			ret = decode_bch(bch, data, c->len, recv, NULL,
+					 errloc);
+			if (ret != nerr) {
+				printf("  m=%d t=%d: %d errors, decode from "
+				       "data returned %d (seed %u)\n", c->m,
+				       c->t, nerr, ret, seed);
+				fail++;
+			}
+		}
+	}
+
+	/* a code too long for the field must be refused */
+	memset(recv, 0xff, sizeof(recv));
+	if (decode_bch(bch, NULL, (bch->n + 8) / 8, recv, ecc, errloc) !=
+	    -EINVAL) {
+		printf("  m=%d t=%d: oversized block accepted\n", c->m, c->t);
+		fail++;
+	}
+
+	printf("  m=%2d t=%2d len=%4u: %d blocks, %d miscorrected beyond "
+	       "t\n", c->m, c->t, c->len, n, miscorrect);
+	free_bch(bch);
+	return fail;
+}
+
+/* Time loops of encode (nerr < 0) or encode + decode with nerr errors */
+static void bench_one(struct bch_control *bch, const struct bch_config *c,
+		      uint8_t *buf, uint8_t *ecc, int nerr, int loops,
+		      unsigned int *seed)
+{
+	uint8_t calc[64];
+	unsigned int errloc[64], pos[64];
+	unsigned long long ns, cyc;
+	char name[40];
+	int k, l;
+
+	if (nerr > 0) {
+		pick_errors(bch, c->len, pos, nerr, seed);
+		for (k = 0; k < nerr; k++)
+			flip(buf, ecc, c->len, pos[k]);
+	}
+
+	ns = bench_ns();
+	cyc = bench_cycles();
+	for (l = 0; l < loops; l++) {
+		memset(calc, 0, sizeof(calc));
+		encode_bch(bch, buf, c->len, calc);
+		if (nerr >= 0)
+			decode_bch(bch, NULL, c->len, ecc, calc, errloc);
+	}
+	cyc = bench_cycles() - cyc;
+	ns = bench_ns() - ns;
+
+	for (k = 0; k < nerr; k++)
+		flip(buf, ecc, c->len, pos[k]);
+
+	if (nerr < 0)
+		sprintf(name, "t=%d/%u encode", c->t, c->len);
+	else
+		sprintf(name, "t=%d/%u decode, %d err", c->t, c->len, nerr);
+	bench_report(name, (unsigned long long)c->len * loops, ns, cyc);
+}
+
+static void bench(int loops)
+{
+	const struct bch_config *c;
+	struct bch_control *bch;
+	uint8_t *buf, ecc[64];
+	unsigned int seed = 1;
+	int i;
+
+	buf = malloc(MAX_BYTES);
+	if (!buf) {
+		perror("malloc");
+		exit(EXIT_FAILURE);
+	}
+
+	printf("bch_test: %d blocks per result\n", loops);
+	for (i = 0; i < sizeof(configs) / sizeof(configs[0]); i++) {
+		c = &configs[i];
+		if (c->len < 512)
+			continue;
+		bch = init_bch(c->m, c->t, c->poly);
+		bench_fill(buf, c->len, &seed);
+		memset(ecc, 0, sizeof(ecc));
+		encode_bch(bch, buf, c->len, ecc);
+
+		bench_one(bch, c, buf, ecc, -1, loops, &seed);
+		bench_one(bch, c, buf, ecc, 0, loops, &seed);
+		bench_one(bch, c, buf, ecc, 1, loops, &seed);
+		bench_one(bch, c, buf, ecc, c->t, loops, &seed);
+		free_bch(bch);
+	}
+	free(buf);
+}
+
+int main(int argc, char **argv)
+{
+	int i, opt, loops = 20000, rounds = 200, do_bench = 0, fail = 0;
+
+	while ((opt = getopt(argc, argv, "bl:n:")) != -1) {
+		switch (opt) {
+		case 'b':
+			do_bench = 1;
+			break;
+		case 'l':
+			loops = strtoul(optarg, NULL, 0);
+			break;
+		case 'n':
+			rounds = strtoul(optarg, NULL, 0);
+			break;
+		default:
+			fprintf(stderr, "Usage: %s [-n rounds] [-b [-l loops]]\n",
+				*argv);
+			exit(EXIT_FAILURE);
+		}
+	}
+	if (do_bench) {
+		bench(loops);
+		return 0;
+	}
+
+	for (i = 0; i < sizeof(configs) / sizeof(configs[0]); i++)
+		fail += check_config(&configs[i], i + 1, rounds);
+	if (fail) {
+		printf("bch_test: %d failures\n", fail);
+		return 1;
+	}
+	printf("bch_test: all checks passed\n");
+	return 0;
+}
@@ -0,0 +1,80 @@
+/*
+ * Timing helpers shared by the host test programs
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+#ifndef __TEST_BENCH_H
+#define __TEST_BENCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static inline unsigned long long bench_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ * Cycle counter where the host has one, nanoseconds elsewhere; the unit
+ * is reported by bench_unit.
+ */
+#if defined(__i386__) || defined(__x86_64__)
+static inline unsigned long long bench_cycles(void)
+{
+	unsigned int lo, hi;
+
+	__asm__ __volatile__("rdtsc" : "=a" (lo), "=d" (hi));
+	return ((unsigned long long)hi << 32) | lo;
+}
+#define bench_unit	"cycles"
+#else
+#define bench_cycles	bench_ns
+#define bench_unit	"ns"
+#endif
+
+/* Print one result line: name, per byte cost and MiB/s */
+static inline void bench_report(const char *name, unsigned long long bytes,
+				unsigned long long ns, unsigned long long cyc)
+{
+	printf("  %-24s %8.2f %s/byte %9.1f MiB/s\n", name,
+	       (double)cyc / bytes, bench_unit,
+	       ns ? bytes * 1e9 / ns / (1 << 20) : 0.0);
+}
+
+/* Small deterministic generator, so that failures can be reproduced */
+static inline unsigned int bench_rand(unsigned int *seed)
+{
+	*seed = *seed * 1103515245 + 12345;
+	return *seed >> 8;
+}
+
+static inline void bench_fill(unsigned char *buf, size_t len,
+			      unsigned int *seed)
+{
+	while (len--)
+		*buf++ = bench_rand(seed);
+}
+
+#endif /* __TEST_BENCH_H */
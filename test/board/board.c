@@ -0,0 +1,135 @@
+/*
+ * Host test board: global data, the simulated NAND array, console
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+#include <common.h>
+#include <command.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+static bd_t bd_data;
+static gd_t gd_data = {
+	.bd = &bd_data,
+	.flags = GD_FLG_RELOC | GD_FLG_DEVINIT,
+	.have_console = 1,
+};
+gd_t *gd = &gd_data;
+
+#ifdef CONFIG_NAND_SIM
+u_char nand_sim_array[CONFIG_NAND_SIM_SIZE];
+#endif
+
+ulong load_addr = CONFIG_SYS_LOAD_ADDR;
+const char version_string[] = "U-Boot host test board";
+
+extern void host_putc(char c);
+extern void host_puts(const char *s);
+
+void putc(const char c)
+{
+	host_putc(c);
+}
+
+void puts(const char *s)
+{
+	host_puts(s);
+}
+
+/* No input: commands never see a key press or Ctrl-C */
+int getc(void)
+{
+	return 0;
+}
+
+int tstc(void)
+{
+	return 0;
+}
+
+int ctrlc(void)
+{
+	return 0;
+}
+
+int had_ctrlc(void)
+{
+	return 0;
+}
+
+void clear_ctrlc(void)
+{
+}
+
+int disable_ctrlc(int disable)
+{
+	return 0;
+}
+
+/* Nothing to boot, no serial port or console devices */
+void show_boot_progress(int val)
+{
+}
+
+int do_bootm(cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
+{
+	puts("## the host board boots nothing\n");
+	return 1;
+}
+
+void serial_setbrg(void)
+{
+}
+
+int console_assign(int file, char *devname)
+{
+	return -1;
+}
+
+/* Run one command line, split at blanks; no quoting, variables, or ';' */
+int board_run(const char *fmt, ...)
+{
+	char line[CONFIG_SYS_CBSIZE], *argv[CONFIG_SYS_MAXARGS + 1], *p;
+	cmd_tbl_t *cmdtp;
+	va_list args;
+	int argc = 0;
+
+	va_start(args, fmt);
+	vsprintf(line, fmt, args);
+	va_end(args);
+
+	for (p = strtok(line, " \t"); p && argc < CONFIG_SYS_MAXARGS;
+	     p = strtok(NULL, " \t"))
+		argv[argc++] = p;
+	argv[argc] = NULL;
+	if (!argc)
+		return 0;
+
+	cmdtp = find_cmd(argv[0]);
+	if (!cmdtp) {
+		printf("Unknown command '%s'\n", argv[0]);
+		return 1;
+	}
+	if (argc > cmdtp->maxargs) {
+		cmd_usage(cmdtp);
+		return 1;
+	}
+	return (cmdtp->cmd)(cmdtp, 0, argc, argv);
+}
@@ -0,0 +1,119 @@
+/*
+ * Host test board: time, delays, console and panic from the C library
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * This half of the board is an ordinary host program and must not see
+ * the U-Boot headers; board.c is the half built against them.  Where
+ * U-Boot and the C library use the same name with different meanings
+ * (puts, putc, getc), board.c has the U-Boot function and calls the
+ * host_ one here.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* The time base runs in nanoseconds */
+unsigned long long get_ticks(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+unsigned long get_tbclk(void)
+{
+	return 1000000000;
+}
+
+static unsigned long long timer_base;
+
+void reset_timer(void)
+{
+	timer_base = get_ticks();
+}
+
+unsigned long get_timer(unsigned long base)
+{
+	return (get_ticks() - timer_base) / 1000000 - base;
+}
+
+/* Busy waits as on the target; sleeping would take far longer */
+void ndelay(unsigned long nsec)
+{
+	unsigned long long end = get_ticks() + nsec;
+
+	while (get_ticks() < end)
+		;
+}
+
+void udelay(unsigned long usec)
+{
+	ndelay(usec * 1000);
+}
+
+unsigned long simple_strtoul(const char *cp, char **endp, unsigned int base)
+{
+	return strtoul(cp, endp, base);
+}
+
+unsigned long long simple_strtoull(const char *cp, char **endp,
+				   unsigned int base)
+{
+	return strtoull(cp, endp, base);
+}
+
+long simple_strtol(const char *cp, char **endp, unsigned int base)
+{
+	return strtol(cp, endp, base);
+}
+
+void host_putc(char c)
+{
+	fputc(c, stdout);
+}
+
+void host_puts(const char *s)
+{
+	fputs(s, stdout);
+}
+
+void hang(void)
+{
+	fflush(stdout);
+	fprintf(stderr, "### board hung\n");
+	exit(EXIT_FAILURE);
+}
+
+void panic(const char *fmt, ...)
+{
+	va_list args;
+
+	fflush(stdout);
+	va_start(args, fmt);
+	vfprintf(stderr, fmt, args);
+	va_end(args);
+	fputc('\n', stderr);
+	exit(EXIT_FAILURE);
+}
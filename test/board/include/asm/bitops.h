@@ -0,0 +1,58 @@
+#ifndef __ASM_HOST_BITOPS_H
+#define __ASM_HOST_BITOPS_H
+
+/*
+ * Plain C bit operations; the test programs are single threaded, so the
+ * "atomic" versions are the same as the non-atomic ones.
+ */
+
+static inline void set_bit(int nr, volatile void *addr)
+{
+	((unsigned char *)addr)[nr >> 3] |= 1U << (nr & 7);
+}
+
+static inline void clear_bit(int nr, volatile void *addr)
+{
+	((unsigned char *)addr)[nr >> 3] &= ~(1U << (nr & 7));
+}
+
+static inline void change_bit(int nr, volatile void *addr)
+{
+	((unsigned char *)addr)[nr >> 3] ^= 1U << (nr & 7);
+}
+
+static inline int test_bit(int nr, const void *addr)
+{
+	return (((const unsigned char *)addr)[nr >> 3] >> (nr & 7)) & 1;
+}
+
+static inline int test_and_set_bit(int nr, volatile void *addr)
+{
+	int old = test_bit(nr, (const void *)addr);
+
+	set_bit(nr, addr);
+	return old;
+}
+
+static inline int test_and_clear_bit(int nr, volatile void *addr)
+{
+	int old = test_bit(nr, (const void *)addr);
+
+	clear_bit(nr, addr);
+	return old;
+}
+
+#define __change_bit		change_bit
+#define __test_and_set_bit	test_and_set_bit
+#define __test_and_clear_bit	test_and_clear_bit
+
+static inline unsigned long ffz(unsigned long word)
+{
+	return __builtin_ctzl(~word);
+}
+
+#define hweight32(x) generic_hweight32(x)
+#define hweight16(x) generic_hweight16(x)
+#define hweight8(x) generic_hweight8(x)
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef __ASM_HOST_BYTEORDER_H
+#define __ASM_HOST_BYTEORDER_H
+
+#include <asm/types.h>
+
+#define __BYTEORDER_HAS_U64__
+
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#include <linux/byteorder/big_endian.h>
+#else
+#include <linux/byteorder/little_endian.h>
+#endif
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef __ASM_HOST_IO_H
+#define __ASM_HOST_IO_H
+
+#include <linux/types.h>
+
+/*
+ * "I/O" on the host is ordinary memory: the simulator hands out RAM
+ * addresses for IO_ADDR_R/W.
+ */
+
+#define __raw_writeb(v,a)	(*(volatile unsigned char *)(a) = (v))
+#define __raw_writew(v,a)	(*(volatile unsigned short *)(a) = (v))
+#define __raw_writel(v,a)	(*(volatile unsigned int *)(a) = (v))
+
+#define __raw_readb(a)		(*(volatile unsigned char *)(a))
+#define __raw_readw(a)		(*(volatile unsigned short *)(a))
+#define __raw_readl(a)		(*(volatile unsigned int *)(a))
+
+#define writeb(v,a)		__raw_writeb(v,a)
+#define writew(v,a)		__raw_writew(v,a)
+#define writel(v,a)		__raw_writel(v,a)
+
+#define readb(a)		__raw_readb(a)
+#define readw(a)		__raw_readw(a)
+#define readl(a)		__raw_readl(a)
+
+static inline void readsb(const volatile void *a, void *b, int n)
+{
+	unsigned char *p = b;
+
+	while (n--)
+		*p++ = __raw_readb(a);
+}
+
+static inline void writesb(volatile void *a, const void *b, int n)
+{
+	const unsigned char *p = b;
+
+	while (n--)
+		__raw_writeb(*p++, a);
+}
+
+#define map_physmem(paddr, len, flags)	((void *)(paddr))
+#define unmap_physmem(vaddr, flags)	do { } while (0)
+
+static inline phys_addr_t virt_to_phys(void *vaddr)
+{
+	return (phys_addr_t)vaddr;
+}
+
+#endif	/* __ASM_HOST_IO_H */
@@ -0,0 +1,8 @@
+#ifndef __ASM_HOST_PTRACE_H
+#define __ASM_HOST_PTRACE_H
+
+struct pt_regs {
+	unsigned long regs[1];
+};
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef __ASM_HOST_STRING_H
+#define __ASM_HOST_STRING_H
+
+/*
+ * No __HAVE_ARCH_* here: linux/string.h declares the whole set and the
+ * host C library provides it.
+ */
+
+#endif
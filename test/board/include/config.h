@@ -0,0 +1,61 @@
+/*
+ * Host "board" for the test programs.
+ *
+ * Target code (drivers/mtd/nand, lib_generic/bch.c, ...) is built for the
+ * build machine against the real include/ tree with this directory put
+ * first, the way a board build would use include/configs/<board>.h and
+ * include/asm-<arch>.  There is no hardware: the NAND chip is the RAM
+ * backed simulator and the console is stdio.
+ */
+
+#ifndef __CONFIG_H
+#define __CONFIG_H
+
+#define CONFIG_SYS_HZ			1000
+#define CONFIG_SYS_MAXARGS		16
+#define CONFIG_SYS_BAUDRATE_TABLE	{ 115200 }
+#define CONFIG_SYS_CBSIZE		256
+#define CONFIG_SYS_LONGHELP
+#define CONFIG_NR_DRAM_BANKS		1
+#define CONFIG_SYS_NO_FLASH
+#define CONFIG_RELOC_FIXUP_WORKS
+#define CONFIG_SYS_MALLOC_LEN		(4 << 20)	/* host malloc */
+
+/*
+ * NAND: the simulator with a large page chip that has cache program,
+ * cache read and two-plane program (Samsung K9F2G08, 256 MiB, 2 KiB
+ * pages), two factory bad blocks.  The array is in board.c.
+ */
+#define CONFIG_CMD_NAND
+#define CONFIG_NAND_SIM
+#define CONFIG_NAND_SIM_ID		{ 0xec, 0xda, 0x10, 0x95 }
+#define CONFIG_NAND_SIM_TIMING		{ 25000, 200000, 2000000, 25 } /* K9F2G08 */
+#define CONFIG_NAND_SIM_BADBLOCKS	{ 3, 1000 }
+#define CONFIG_NAND_SIM_SIZE		(264 << 20)	/* chip plus OOB */
+#define CONFIG_SYS_MAX_NAND_DEVICE	1
+#define CONFIG_SYS_NAND_CACHEPRG
+#define CONFIG_SYS_NAND_MULTIPLANE
+#define CONFIG_SYS_NAND_READCACHE
+#define CONFIG_SYS_NAND_BASE_LIST	{ (ulong)nand_sim_array }
+#ifndef __ASSEMBLY__
+extern unsigned char nand_sim_array[];
+#endif
+#define CONFIG_SYS_LOAD_ADDR		0
+
+/* The users of the NAND code */
+#define CONFIG_ENV_IS_IN_NAND
+#define CONFIG_CMD_SAVEENV
+#define CONFIG_ENV_OFFSET		0x100000
+#define CONFIG_ENV_SIZE			0x20000
+#define CONFIG_CMD_JFFS2
+#define CONFIG_JFFS2_NAND
+#define CONFIG_CMD_UBI
+#define CONFIG_CMD_MTDPARTS
+#define CONFIG_MTD_DEVICE
+#define CONFIG_MTD_PARTITIONS
+#define CONFIG_RBTREE
+#define CONFIG_YAFFS2
+#define MTDIDS_DEFAULT			"nand0=sim"
+#define MTDPARTS_DEFAULT		"mtdparts=sim:2M(env),64M(jffs2),64M(ubi),-(yaffs2)"
+
+#endif	/* __CONFIG_H */
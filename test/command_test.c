@@ -0,0 +1,188 @@
+/*
+ * Command table lookup test and benchmark
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * Fills the linker's command table with short names in random order,
+ * many of them prefixes of others, before find_cmd() first sorts it.
+ * Every prefix of every name, with and without a ".b" size suffix, and
+ * names which are not in the table must give the same entry as the
+ * linear find_cmd_tbl(): the full match, the only command with that
+ * prefix, or NULL for an ambiguous abbreviation.  With -b both lookups
+ * are timed.
+ */
+
+#include <common.h>
+#include <command.h>
+
+#define NCMDS		160
+#define NAME_LEN	8
+#define BENCH_LOOPS	2000
+
+static int fails;
+
+#define check(cond, fmt, args...) do {					\
+		if (!(cond)) {						\
+			printf("  FAIL %s:%d: " fmt "\n", __func__,	\
+			       __LINE__, ##args);			\
+			fails++;					\
+		}							\
+	} while (0)
+
+/* the whole command table of this program, names filled in by main() */
+static cmd_tbl_t cmds[NCMDS] Struct_Section;
+static char names[NCMDS][NAME_LEN];
+
+static unsigned int seed = 1;
+
+/* bench_rand() from bench.h, whose low bits repeat too soon for this */
+static unsigned int rnd(unsigned int n)
+{
+	seed = seed * 1103515245 + 12345;
+	return (seed >> 16) % n;
+}
+
+/* random names of 1 to 4 letters from "abcm", plus a few real ones */
+static void fill_table(void)
+{
+	static const char *const real[] = {
+		"cp", "cmp", "crc32", "md", "mm", "mw", "nand", "nboot",
+		"nm", "run", "setenv", "saveenv", "help", "?", "version",
+	};
+	int i, j, n = 0, len;
+	char name[NAME_LEN];
+
+	for (i = 0; i < ARRAY_SIZE(real); i++)
+		strcpy(names[n++], real[i]);
+	while (n < NCMDS) {
+		len = 1 + rnd(4);
+		for (i = 0; i < len; i++)
+			name[i] = "abcm"[rnd(4)];
+		name[len] = '\0';
+		for (j = 0; j < n && strcmp(names[j], name); j++)
+			;
+		if (j == n)
+			strcpy(names[n++], name);
+	}
+
+	/* shuffle, the linker gives no particular order */
+	for (i = NCMDS - 1; i > 0; i--) {
+		j = rnd(i + 1);
+		strcpy(name, names[i]);
+		strcpy(names[i], names[j]);
+		strcpy(names[j], name);
+	}
+	for (i = 0; i < NCMDS; i++) {
+		cmds[i].name = names[i];
+		cmds[i].maxargs = 1;
+	}
+}
+
+static int lookup(const char *cmd)
+{
+	/* find_cmd() first: the first call moves the entries around */
+	cmd_tbl_t *got = find_cmd(cmd);
+	cmd_tbl_t *want = find_cmd_tbl(cmd, cmds, NCMDS);
+
+	check(got == want, "\"%s\": got %s, want %s", cmd,
+	      got ? got->name : "NULL", want ? want->name : "NULL");
+	return want != NULL;
+}
+
+static void check_lookups(void)
+{
+	char cmd[NAME_LEN + 4];
+	int i, len, cases = 0, found = 0;
+
+	for (i = 0; i < NCMDS; i++) {
+		for (len = 1; len <= strlen(names[i]); len++) {
+			strncpy(cmd, names[i], len);
+			cmd[len] = '\0';
+			found += lookup(cmd);
+			strcpy(cmd + len, ".b");
+			found += lookup(cmd);
+			cases += 2;
+		}
+	}
+	/* not in the table: before, between and after the names */
+	static const char *const missing[] = {
+		"", ".b", "0", "abcma", "aaaaa", "d", "mmmmm", "x", "zzz",
+		"nandx", "cmp2", "?x",
+	};
+	for (i = 0; i < ARRAY_SIZE(missing); i++, cases++)
+		check(!lookup(missing[i]), "\"%s\" found", missing[i]);
+
+	/* the first lookup sorted the table */
+	for (i = 1; i < NCMDS; i++)
+		check(strcmp(cmds[i - 1].name, cmds[i].name) < 0,
+		      "table not sorted at %d: %s, %s", i, cmds[i - 1].name,
+		      cmds[i].name);
+
+	/* both full matches and ambiguous abbreviations were seen */
+	check(found > NCMDS && found < cases - ARRAY_SIZE(missing),
+	      "%d of %d lookups found a command", found, cases);
+}
+
+static void bench(void)
+{
+	unsigned long long t0, t1, t2;
+	volatile cmd_tbl_t *sink;
+	int i, l;
+
+	find_cmd("help");	/* sort outside the timing */
+	t0 = get_ticks();
+	for (l = 0; l < BENCH_LOOPS; l++)
+		for (i = 0; i < NCMDS; i++)
+			sink = find_cmd_tbl(names[i], cmds, NCMDS);
+	t1 = get_ticks();
+	for (l = 0; l < BENCH_LOOPS; l++)
+		for (i = 0; i < NCMDS; i++)
+			sink = find_cmd(names[i]);
+	t2 = get_ticks();
+	(void)sink;
+
+	printf("%d commands, lookup of every name:\n", NCMDS);
+	printf("  linear  %8.1f ns\n", (double)(t1 - t0) / BENCH_LOOPS / NCMDS);
+	printf("  sorted  %8.1f ns\n", (double)(t2 - t1) / BENCH_LOOPS / NCMDS);
+}
+
+int main(int argc, char **argv)
+{
+	if (&__u_boot_cmd_end - &__u_boot_cmd_start != NCMDS) {
+		puts("command_test: the command table is not cmds[]\n");
+		return 1;
+	}
+	fill_table();
+
+	if (argc > 1 && !strcmp(argv[1], "-b")) {
+		bench();
+		return 0;
+	}
+
+	check_lookups();
+
+	if (fails) {
+		printf("command_test: %d failures\n", fails);
+		return 1;
+	}
+	puts("command_test: all checks passed\n");
+	return 0;
+}
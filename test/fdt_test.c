@@ -0,0 +1,529 @@
+/*
+ * libfdt lookup index test and benchmark on generated device trees
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * Builds large trees with fdt_sw, indexes one copy with
+ * fdt_index_attach() and keeps a second, unindexed copy of the same
+ * blob, on which libfdt scans.  Both get the same random edits, and
+ * path, abbreviated path, phandle and compatible lookups must give the
+ * same offsets on both.  Trees written over the indexed blob without
+ * libfdt must not be answered from the old index.  With -b the index
+ * build and the lookups are timed on trees of growing size, indexed
+ * against scanning.
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <libfdt.h>
+
+/* Tree shape: /soc/bus@N/dev@N/port@N, see make_tree() */
+struct shape {
+	int	buses;
+	int	devs;		/* per bus */
+	int	ports;		/* per device */
+};
+
+#define TREE_SLACK	(64 << 10)	/* room for the edits */
+#define INDEX_SIZE	(1 << 20)	/* some 25000 nodes */
+#define EDITS		600
+#define PATH_LEN	256
+
+static unsigned int seed = 1;
+static int fails;
+
+#define check(cond, fmt, args...) do {					\
+		if (!(cond)) {						\
+			printf("  FAIL %s:%d: " fmt "\n", __func__,	\
+			       __LINE__, ##args);			\
+			fails++;					\
+		}							\
+	} while (0)
+
+static unsigned int rnd(unsigned int n)
+{
+	seed = seed * 1103515245 + 12345;
+	return (seed >> 8) % n;
+}
+
+static unsigned long long now_ns(void)
+{
+	return get_ticks();
+}
+
+/* The first fdt_sw error, make_tree() gives up on it */
+static int sw_err;
+
+#define SW(call) do {							\
+		int __err = (call);					\
+		if (__err < 0 && !sw_err) {				\
+			printf("fdt_test: %s: %s\n", #call,		\
+			       fdt_strerror(__err));			\
+			sw_err = __err;					\
+		}							\
+	} while (0)
+
+static void sw_u32(void *fdt, const char *name, uint32_t val)
+{
+	val = cpu_to_fdt32(val);
+	SW(fdt_property(fdt, name, &val, sizeof(val)));
+}
+
+/*
+ * Every device and port has a phandle, devices a compatible out of 16
+ * (so some are shared), and ports a second kind of compatible. 'tag'
+ * changes the compatibles, so that two trees of the same shape differ.
+ */
+static void *make_tree(const struct shape *sh, int tag, int *sizep)
+{
+	int size = 256 + sh->buses * sh->devs * (sh->ports + 1) * 192 +
+		   TREE_SLACK;
+	void *sw = malloc(size), *fdt = malloc(size);
+	uint32_t phandle = 1;
+	char name[64];
+	int b, d, p, len;
+
+	if (!sw || !fdt) {
+		puts("fdt_test: out of memory\n");
+		free(sw);
+		free(fdt);
+		return NULL;
+	}
+	SW(fdt_create(sw, size));
+	SW(fdt_finish_reservemap(sw));
+	SW(fdt_begin_node(sw, ""));
+	sw_u32(sw, "#address-cells", 1);
+	SW(fdt_begin_node(sw, "soc"));
+	for (b = 0; b < sh->buses; b++) {
+		sprintf(name, "bus@%x", 0x10000000 + b * 0x100000);
+		SW(fdt_begin_node(sw, name));
+		SW(fdt_property_string(sw, "compatible", "simple-bus"));
+		for (d = 0; d < sh->devs; d++) {
+			sprintf(name, "dev@%x", d * 0x1000);
+			SW(fdt_begin_node(sw, name));
+			len = sprintf(name, "vendor,dev%d", (b + d + tag) % 16);
+			memcpy(name + len + 1, "vendor,generic", 15);
+			SW(fdt_property(sw, "compatible", name, len + 16));
+			sw_u32(sw, "reg", d * 0x1000);
+			sw_u32(sw, "linux,phandle", phandle++);
+			for (p = 0; p < sh->ports; p++) {
+				sprintf(name, "port@%d", p);
+				SW(fdt_begin_node(sw, name));
+				sprintf(name, "vendor,port%d", (p + tag) % 4);
+				SW(fdt_property_string(sw, "compatible", name));
+				sw_u32(sw, "linux,phandle", phandle++);
+				SW(fdt_end_node(sw));
+			}
+			SW(fdt_end_node(sw));
+		}
+		SW(fdt_end_node(sw));
+	}
+	SW(fdt_end_node(sw));
+	SW(fdt_end_node(sw));
+	SW(fdt_finish(sw));
+
+	SW(fdt_open_into(sw, fdt, size));
+	free(sw);
+	if (sw_err) {
+		free(fdt);
+		return NULL;
+	}
+	*sizep = size;
+	return fdt;
+}
+
+static uint32_t max_phandle(const struct shape *sh)
+{
+	return sh->buses * sh->devs * (sh->ports + 1);
+}
+
+/*
+ * The indexed blob and its unindexed twin. The twin has to be at
+ * another address, which is all it takes for libfdt to scan it.
+ */
+static void *ifdt, *pfdt;
+static int fdt_size;
+
+static void twin_sync(void)
+{
+	memcpy(pfdt, ifdt, fdt_size);
+}
+
+static void compare_path(const char *path)
+{
+	int a = fdt_path_offset(ifdt, path), b = fdt_path_offset(pfdt, path);
+
+	check(a == b, "%s: %d, scan %d", path, a, b);
+}
+
+/* Full and abbreviated paths of node, and a name that isn't there */
+static void compare_node(int node)
+{
+	char path[PATH_LEN], *at;
+	int err;
+
+	err = fdt_get_path(pfdt, node, path, sizeof(path));
+	if (err < 0) {
+		check(0, "fdt_get_path(%d): %s", node, fdt_strerror(err));
+		return;
+	}
+	compare_path(path);
+	at = strrchr(path, '@');
+	if (at && !strchr(at, '/')) {
+		*at = '\0';
+		compare_path(path);
+	}
+	strcat(path, "/none");
+	compare_path(path);
+}
+
+static void compare_phandle(uint32_t phandle)
+{
+	int a = fdt_node_offset_by_phandle(ifdt, phandle);
+	int b = fdt_node_offset_by_phandle(pfdt, phandle);
+
+	check(a == b, "phandle %u: %d, scan %d", phandle, a, b);
+}
+
+static void compare_compatible(const char *compat)
+{
+	int a = -1, b = -1;
+
+	do {
+		a = fdt_node_offset_by_compatible(ifdt, a, compat);
+		b = fdt_node_offset_by_compatible(pfdt, b, compat);
+		check(a == b, "%s: %d, scan %d", compat, a, b);
+	} while (a >= 0 && a == b);
+}
+
+static void compare_all(uint32_t phandles)
+{
+	char compat[32];
+	int node, i;
+
+	for (node = 0; node >= 0; node = fdt_next_node(pfdt, node, NULL))
+		compare_node(node);
+	for (i = 0; i <= phandles + 2; i++)
+		compare_phandle(i);
+	for (i = 0; i < 16; i++) {
+		sprintf(compat, "vendor,dev%d", i);
+		compare_compatible(compat);
+	}
+	compare_compatible("vendor,port1");
+	compare_compatible("vendor,generic");
+}
+
+/* A random node of the tree, root included */
+static int random_node(void)
+{
+	int node, n = 0, pick;
+
+	for (node = 0; node >= 0; node = fdt_next_node(pfdt, node, NULL))
+		n++;
+	pick = rnd(n);
+	for (node = 0; pick--; node = fdt_next_node(pfdt, node, NULL))
+		;
+	return node;
+}
+
+/* One random edit, applied the same way to both blobs */
+static void random_edit(uint32_t *phandles)
+{
+	static const char *props[] = {
+		"reg", "status", "compatible", "linux,phandle", "x-extra",
+	};
+	int node = random_node(), op = rnd(8), ea, eb;
+	const char *prop = props[rnd(5)];
+	char buf[64], name[16];
+	uint32_t val;
+	int len;
+
+	switch (op) {
+	case 0: case 1: case 2:		/* set, often changing the size */
+		if (!strcmp(prop, "linux,phandle")) {
+			val = cpu_to_fdt32(++*phandles);
+			memcpy(buf, &val, sizeof(val));
+			len = sizeof(val);
+		} else if (!strcmp(prop, "compatible")) {
+			len = sprintf(buf, "vendor,dev%d", rnd(16)) + 1;
+		} else {
+			len = rnd(sizeof(buf));
+			memset(buf, 'a' + rnd(26), len);
+		}
+		ea = fdt_setprop(ifdt, node, prop, buf, len);
+		eb = fdt_setprop(pfdt, node, prop, buf, len);
+		break;
+	case 3:
+		ea = fdt_delprop(ifdt, node, prop);
+		eb = fdt_delprop(pfdt, node, prop);
+		break;
+	case 4:
+		sprintf(name, rnd(2) ? "new@%x" : "new%x", rnd(64));
+		ea = fdt_add_subnode(ifdt, node, name);
+		eb = fdt_add_subnode(pfdt, node, name);
+		break;
+	case 5:
+		if (!node)
+			return;
+		if (rnd(2)) {
+			ea = fdt_del_node(ifdt, node);
+			eb = fdt_del_node(pfdt, node);
+		} else {
+			ea = fdt_nop_node(ifdt, node);
+			eb = fdt_nop_node(pfdt, node);
+		}
+		break;
+	case 6:
+		if (!node)
+			return;
+		sprintf(name, "ren@%x", rnd(64));
+		ea = fdt_set_name(ifdt, node, name);
+		eb = fdt_set_name(pfdt, node, name);
+		break;
+	default:			/* moves the structure block */
+		if (fdt_num_mem_rsv(pfdt) && rnd(2)) {
+			ea = fdt_del_mem_rsv(ifdt, 0);
+			eb = fdt_del_mem_rsv(pfdt, 0);
+		} else {
+			val = rnd(1 << 20);
+			ea = fdt_add_mem_rsv(ifdt, val, 4096);
+			eb = fdt_add_mem_rsv(pfdt, val, 4096);
+		}
+		break;
+	}
+	check(ea == eb, "edit %d: %d, scan %d", op, ea, eb);
+	check(!memcmp(ifdt, pfdt, fdt_size), "edit %d: blobs differ", op);
+	if (memcmp(ifdt, pfdt, fdt_size))
+		twin_sync();
+}
+
+static void *idx_buf;
+
+static void attach(void)
+{
+	int err = fdt_index_attach(ifdt, idx_buf, INDEX_SIZE);
+
+	check(err == 0, "fdt_index_attach: %s", fdt_strerror(err));
+}
+
+/* The indexed tree and its twin; returns 0 if out of memory */
+static int open_twins(const struct shape *sh)
+{
+	ifdt = make_tree(sh, 0, &fdt_size);
+	pfdt = ifdt ? malloc(fdt_size) : NULL;
+	if (!pfdt) {
+		free(ifdt);
+		return 0;
+	}
+	twin_sync();
+	attach();
+	return 1;
+}
+
+static void close_twins(void)
+{
+	fdt_index_detach();
+	free(ifdt);
+	free(pfdt);
+}
+
+static void check_edits(void)
+{
+	struct shape sh = { 8, 16, 3 };
+	uint32_t phandles = max_phandle(&sh);
+	int i;
+
+	if (!open_twins(&sh)) {
+		check(0, "no tree");
+		return;
+	}
+	compare_all(phandles);
+	for (i = 0; i < EDITS && !fails; i++) {
+		random_edit(&phandles);
+		compare_node(random_node());
+		compare_phandle(1 + rnd(phandles));
+		if (i % 50 == 49)
+			compare_all(phandles);
+	}
+	compare_all(phandles);
+	close_twins();
+}
+
+/*
+ * Trees written over the indexed blob by other means: a different
+ * tree, the same tree with nodes moved but the same header, and a
+ * phandle changed in place.
+ */
+static void check_stale(void)
+{
+	struct shape sh = { 4, 20, 3 }, other = { 3, 20, 3 };
+	uint32_t phandles = max_phandle(&other);
+	int size, off, len;
+	uint32_t *php;
+	void *t;
+
+	if (!open_twins(&sh)) {
+		check(0, "no tree");
+		return;
+	}
+	compare_all(max_phandle(&sh));
+
+	/* another tree, as a new DTB loaded to the same address */
+	t = make_tree(&other, 1, &size);
+	check(t && size <= fdt_size, "other tree");
+	if (!t || size > fdt_size) {
+		close_twins();
+		return;
+	}
+	fdt_open_into(t, pfdt, fdt_size);
+	free(t);
+	memcpy(ifdt, pfdt, fdt_size);
+	compare_all(phandles);
+
+	/*
+	 * Same tree, same header, but "reg" of the first device moved to
+	 * the last node: every node after the first device is elsewhere.
+	 */
+	attach();
+	off = fdt_path_offset(pfdt, "/soc/bus@10000000/dev@0");
+	fdt_delprop(pfdt, off, "reg");
+	off = fdt_path_offset(pfdt, "/soc/bus@10200000/dev@13000/port@2");
+	len = 0x1234;
+	fdt_setprop(pfdt, off, "reg", &len, sizeof(len));
+	check(fdt_size_dt_struct(pfdt) == fdt_size_dt_struct(ifdt) &&
+	      fdt_totalsize(pfdt) == fdt_totalsize(ifdt),
+	      "moved tree has another header");
+	memcpy(ifdt, pfdt, fdt_size);
+	compare_all(phandles);
+
+	/* a phandle rewritten in place, the lookup of the old one first */
+	attach();
+	off = fdt_node_offset_by_phandle(pfdt, 7);
+	php = (uint32_t *)fdt_getprop(ifdt, off, "linux,phandle", &len);
+	*php = cpu_to_fdt32(phandles + 1);
+	twin_sync();
+	compare_phandle(7);
+	compare_phandle(phandles + 1);
+	compare_all(phandles + 1);
+
+	close_twins();
+}
+
+#define BENCH_LOOKUPS	1000
+
+/* Time BENCH_LOOKUPS path, phandle and compatible lookups in fdt */
+static void bench_lookups(const char *what, void *fdt, const struct shape *sh,
+			  char (*paths)[PATH_LEN])
+{
+	unsigned long long t0, t1, t2, t3;
+	int i, off, found = 0;
+	uint32_t phandles = max_phandle(sh);
+
+	t0 = now_ns();
+	for (i = 0; i < BENCH_LOOKUPS; i++)
+		found += fdt_path_offset(fdt, paths[i]) >= 0;
+	t1 = now_ns();
+	for (i = 0; i < BENCH_LOOKUPS; i++)
+		found += fdt_node_offset_by_phandle(fdt,
+				1 + i * 7919 % phandles) >= 0;
+	t2 = now_ns();
+	for (i = 0; i < BENCH_LOOKUPS / 100; i++)
+		for (off = -1; (off = fdt_node_offset_by_compatible(fdt, off,
+				"vendor,dev3")) >= 0; )
+			found++;
+	t3 = now_ns();
+
+	printf("  %-8s path %8.2f us  phandle %8.2f us  compatible walk "
+	       "%9.2f us  (%d found)\n", what,
+	       (t1 - t0) / 1e3 / BENCH_LOOKUPS, (t2 - t1) / 1e3 / BENCH_LOOKUPS,
+	       (t3 - t2) / 1e3 / (BENCH_LOOKUPS / 100), found);
+}
+
+static void bench(void)
+{
+	static const struct shape shapes[] = {
+		{ 4, 32, 4 },		/* 646 nodes */
+		{ 16, 64, 8 },		/* 9234 nodes */
+		{ 32, 128, 12 },	/* 53282 nodes */
+	};
+	char (*paths)[PATH_LEN] = malloc(BENCH_LOOKUPS * PATH_LEN);
+	unsigned long long t0, t1;
+	const struct shape *sh;
+	void *fdt, *idx;
+	int i, size, nodes, node, isize;
+
+	if (!paths)
+		return;
+	for (sh = shapes; sh < shapes + ARRAY_SIZE(shapes); sh++) {
+		fdt = make_tree(sh, 0, &size);
+		if (!fdt)
+			break;
+		for (i = 0; i < BENCH_LOOKUPS; i++)
+			sprintf(paths[i], "/soc/bus@%x/dev@%x/port@%d",
+				0x10000000 + rnd(sh->buses) * 0x100000,
+				rnd(sh->devs) * 0x1000, rnd(sh->ports));
+		nodes = 0;
+		for (node = 0; node >= 0; node = fdt_next_node(fdt, node, NULL))
+			nodes++;
+		printf("%d nodes, %u KiB structure:\n", nodes,
+		       fdt_size_dt_struct(fdt) >> 10);
+
+		bench_lookups("scan", fdt, sh, paths);
+
+		t0 = now_ns();
+		isize = fdt_index_size(fdt);
+		idx = malloc(isize);
+		fdt_index_attach(fdt, idx, isize);
+		t1 = now_ns();
+		printf("  index    %d KiB, built in %.2f ms\n", isize >> 10,
+		       (t1 - t0) / 1e6);
+		bench_lookups("indexed", fdt, sh, paths);
+
+		fdt_index_detach();
+		free(idx);
+		free(fdt);
+	}
+	free(paths);
+}
+
+int main(int argc, char **argv)
+{
+	idx_buf = malloc(INDEX_SIZE);
+	if (!idx_buf) {
+		puts("fdt_test: out of memory\n");
+		return 1;
+	}
+
+	if (argc > 1 && !strcmp(argv[1], "-b")) {
+		bench();
+		return 0;
+	}
+
+	check_edits();
+	check_stale();
+
+	if (fails) {
+		printf("fdt_test: %d failures\n", fails);
+		return 1;
+	}
+	puts("fdt_test: all checks passed\n");
+	return 0;
+}
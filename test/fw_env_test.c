@@ -0,0 +1,585 @@
+/*
+ * fw_printenv/fw_setenv test on files standing in for MTD devices
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * tools/env/fw_env.c is built with its ioctl() calls going to
+ * fw_test_ioctl() below, which answers MEMGETINFO for a NOR or NAND
+ * device and erases by filling the file with 0xff; read() and write()
+ * go to plain files in a scratch directory.  On redundant NOR, redundant
+ * NAND and single NOR setups, random set/delete sequences given to
+ * fw_setenv one by one must leave the environment a simple model of it
+ * predicts, with one erase per change.  The same changes as one
+ * "fw_setenv -s" script must give the same environment with a single
+ * erase, and a script with a failing line must not touch the flash.
+ * The library calls must see uncommitted changes and alternate the
+ * redundant copies on every commit.  With -b, setting many variables
+ * one by one is compared with one script.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <mtd/mtd-user.h>
+#include "env/fw_env.h"
+#include "bench.h"
+
+#define DEV_SIZE	0x10000
+#define SECT_SIZE	0x4000		/* environment and erase size */
+#define SEQUENCES	15
+#define MAX_OPS		40
+#define MAX_VARS	64
+#define VAR_LEN		4096
+#define BENCH_VARS	64
+
+#define ARRAY_SIZE(x)	(sizeof(x) / sizeof((x)[0]))
+
+static const char *dev_names[2] = { "dev0", "dev1" };
+
+struct setup {
+	const char	*name;
+	int		nand;
+	int		redund;
+};
+
+static const struct setup setups[] = {
+	{ "redundant NOR",	0, 1 },
+	{ "redundant NAND",	1, 1 },
+	{ "single NOR",		0, 0 },
+};
+
+static int fails;
+
+#define check(cond, fmt, args...) do {					\
+		if (!(cond)) {						\
+			printf("  FAIL %s:%d: " fmt "\n", __func__,	\
+			       __LINE__, ##args);			\
+			fails++;					\
+		}							\
+	} while (0)
+
+static unsigned int seed = 1;
+
+static unsigned int rnd(unsigned int n)
+{
+	return bench_rand(&seed) % n;
+}
+
+/* The fake MTD layer */
+
+static const struct setup *cur;
+static int erases[2];		/* per device */
+
+static int dev_index(int fd)
+{
+	struct stat st, dev;
+	int i;
+
+	if (fstat(fd, &st))
+		return -1;
+	for (i = 0; i < 2; i++)
+		if (!stat(dev_names[i], &dev) && dev.st_ino == st.st_ino)
+			return i;
+	return -1;
+}
+
+int fw_test_ioctl(int fd, unsigned long req, ...)
+{
+	struct mtd_info_user *info;
+	struct erase_info_user *erase;
+	char blank[SECT_SIZE];
+	va_list ap;
+	void *arg;
+	int dev;
+
+	va_start(ap, req);
+	arg = va_arg(ap, void *);
+	va_end(ap);
+
+	switch (req) {
+	case MEMGETINFO:
+		info = arg;
+		memset(info, 0, sizeof(*info));
+		info->type = cur->nand ? MTD_NANDFLASH : MTD_NORFLASH;
+		info->size = DEV_SIZE;
+		info->erasesize = SECT_SIZE;
+		info->writesize = cur->nand ? 512 : 1;
+		return 0;
+	case MEMERASE:
+		erase = arg;
+		dev = dev_index(fd);
+		if (dev < 0 || erase->length != SECT_SIZE ||
+		    erase->start + erase->length > DEV_SIZE) {
+			errno = EINVAL;
+			return -1;
+		}
+		memset(blank, 0xff, sizeof(blank));
+		if (pwrite(fd, blank, SECT_SIZE, erase->start) != SECT_SIZE)
+			return -1;
+		erases[dev]++;
+		return 0;
+	case MEMGETBADBLOCK:
+	case MEMLOCK:
+	case MEMUNLOCK:
+		return 0;
+	}
+	errno = EINVAL;
+	return -1;
+}
+
+static void reset(const struct setup *s)
+{
+	char blank[DEV_SIZE];
+	FILE *fp;
+	int i;
+
+	cur = s;
+	fp = fopen("fw_env_test.config", "w");
+	if (!fp) {
+		perror("fw_env_test.config");
+		exit(1);
+	}
+	for (i = 0; i <= s->redund; i++)
+		fprintf(fp, "%s 0x0 0x%x 0x%x\n", dev_names[i], SECT_SIZE,
+			SECT_SIZE);
+	fclose(fp);
+
+	memset(blank, 0xff, sizeof(blank));
+	for (i = 0; i < 2; i++) {
+		fp = fopen(dev_names[i], "w");
+		if (!fp || fwrite(blank, 1, DEV_SIZE, fp) != DEV_SIZE) {
+			perror(dev_names[i]);
+			exit(1);
+		}
+		fclose(fp);
+	}
+	erases[0] = erases[1] = 0;
+}
+
+static void read_devs(char *buf)
+{
+	FILE *fp;
+	int i;
+
+	for (i = 0; i < 2; i++) {
+		fp = fopen(dev_names[i], "r");
+		if (!fp || fread(buf + i * DEV_SIZE, 1, DEV_SIZE, fp) != DEV_SIZE)
+			memset(buf + i * DEV_SIZE, 0, DEV_SIZE);
+		if (fp)
+			fclose(fp);
+	}
+}
+
+/* Output of fw_env.c on fd, between capture_start() and capture_end() */
+static char captured[64 << 10];
+static FILE *capture_file;
+static int capture_fd, saved_fd;
+
+static void capture_start(int fd)
+{
+	fflush(stdout);
+	capture_file = tmpfile();
+	if (!capture_file) {
+		perror("tmpfile");
+		exit(1);
+	}
+	capture_fd = fd;
+	saved_fd = dup(fd);
+	dup2(fileno(capture_file), fd);
+}
+
+static const char *capture_end(void)
+{
+	size_t n;
+
+	fflush(stdout);
+	dup2(saved_fd, capture_fd);
+	close(saved_fd);
+	rewind(capture_file);
+	n = fread(captured, 1, sizeof(captured) - 1, capture_file);
+	captured[n] = '\0';
+	fclose(capture_file);
+	return captured;
+}
+
+/* What fw_printenv prints for the environment in flash */
+static const char *listing(void)
+{
+	char *argv[] = { "fw_printenv", NULL };
+	const char *out;
+
+	capture_start(1);
+	fw_printenv(1, argv);
+	out = capture_end();
+	fw_env_close();
+	return out;
+}
+
+/*
+ * The model: "name=value" strings in environment order, as fw_setenv
+ * keeps them. dirty is set while a change (or the default environment
+ * after a bad CRC) still has to be written.
+ */
+struct model {
+	char	vars[MAX_VARS][VAR_LEN];
+	int	n;
+	int	dirty;
+};
+
+static unsigned long model_size(void)
+{
+	return SECT_SIZE - sizeof(long) - (cur->redund ? 1 : 0);
+}
+
+static void model_load(struct model *m, const char *list)
+{
+	const char *end;
+
+	m->n = 0;
+	m->dirty = 1;
+	for (; *list && m->n < MAX_VARS; list = end + 1) {
+		end = strchr(list, '\n');
+		if (!end)
+			break;
+		memcpy(m->vars[m->n], list, end - list);
+		m->vars[m->n++][end - list] = '\0';
+	}
+}
+
+static int model_find(struct model *m, const char *name)
+{
+	int i, len = strlen(name);
+
+	for (i = 0; i < m->n; i++)
+		if (!strncmp(m->vars[i], name, len) && m->vars[i][len] == '=')
+			return i;
+	return -1;
+}
+
+/* fw_setenv name [value]: 0, or -1 and errno with m unchanged */
+static int model_set(struct model *m, const char *name, const char *value)
+{
+	unsigned long used = 1;
+	int i = model_find(m, name);
+	int j;
+
+	if (i >= 0 && (!strcmp(name, "ethaddr") || !strcmp(name, "serial#"))) {
+		errno = EROFS;
+		return -1;
+	}
+	if (value) {
+		for (j = 0; j < m->n; j++)
+			if (j != i)
+				used += strlen(m->vars[j]) + 1;
+		if (used + strlen(name) + strlen(value) + 2 > model_size()) {
+			errno = ENOSPC;
+			return -1;
+		}
+	}
+	if (i >= 0) {
+		memmove(m->vars[i], m->vars[i + 1],
+			(m->n - i - 1) * sizeof(m->vars[0]));
+		m->n--;
+		m->dirty = 1;
+	}
+	if (value) {
+		sprintf(m->vars[m->n++], "%s=%s", name, value);
+		m->dirty = 1;
+	}
+	return 0;
+}
+
+static void model_check(struct model *m, const char *what)
+{
+	static char expect[sizeof(captured)];
+	char *p = expect;
+	int i;
+
+	for (i = 0; i < m->n; i++)
+		p += sprintf(p, "%s\n", m->vars[i]);
+	check(!strcmp(listing(), expect), "%s, %s: environment differs",
+	      cur->name, what);
+}
+
+/* A random change: name, and value words or none to delete */
+struct op {
+	const char	*name;
+	int		words;
+	char		value[VAR_LEN];
+};
+
+static void random_op(struct op *op)
+{
+	static const char *names[] = {
+		"a", "b", "bootargs", "bootcmd", "ipaddr", "serverip", "x1",
+		"longname_zzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzz",
+		"ethaddr", "serial#", "bootdelay",
+	};
+	char *p = op->value;
+	int i, n;
+
+	op->name = names[rnd(ARRAY_SIZE(names))];
+	op->words = rnd(5) ? 1 + rnd(4) : 0;
+	*p = '\0';
+	for (i = 0; i < op->words; i++)
+		p += sprintf(p, "%sv%d", i ? " " : "", rnd(1000));
+	if (op->words && !rnd(8)) {
+		/* a big one, so that the environment overflows */
+		n = 1 + rnd(3000);
+		*p++ = ' ';
+		memset(p, 'y', n);
+		p[n] = '\0';
+		op->words++;
+	}
+}
+
+/* fw_setenv with op as its arguments; its messages end up in captured */
+static int setenv_op(struct op *op)
+{
+	char *argv[3 + 8], *words, *w;
+	int argc = 0, rc;
+
+	words = strdup(op->value);
+	argv[argc++] = "fw_setenv";
+	argv[argc++] = (char *)op->name;
+	for (w = strtok(words, " "); w; w = strtok(NULL, " "))
+		argv[argc++] = w;
+	argv[argc] = NULL;
+
+	capture_start(2);
+	rc = fw_setenv(argc, argv);
+	capture_end();
+	free(words);
+	return rc;
+}
+
+static int setenv_script(const char *script)
+{
+	char *argv[] = { "fw_setenv", "-s", "fw_env_test.script", NULL };
+	FILE *fp = fopen(argv[2], "w");
+	int rc;
+
+	if (!fp || fputs(script, fp) < 0) {
+		perror(argv[2]);
+		exit(1);
+	}
+	fclose(fp);
+
+	capture_start(2);
+	rc = fw_setenv(3, argv);
+	capture_end();
+	return rc;
+}
+
+static struct op ops[MAX_OPS];
+static struct model model;
+static char script[MAX_OPS * (VAR_LEN + 64)];
+static char before[2 * DEV_SIZE], after[2 * DEV_SIZE];
+
+static void check_sequence(const struct setup *s, int n)
+{
+	int i, rc, err, expect, e;
+	char *p;
+
+	/* one by one, each change written at once */
+	reset(s);
+	model_load(&model, listing());
+	p = script + sprintf(script, "# provisioning\n\n");
+	for (i = 0; i < n; i++) {
+		random_op(&ops[i]);
+		expect = model_set(&model, ops[i].name,
+				   ops[i].words ? ops[i].value : NULL);
+		err = errno;
+		e = erases[0] + erases[1];
+		rc = setenv_op(&ops[i]);
+		check(rc == expect && (!rc || errno == err),
+		      "%s, fw_setenv %s: %d (errno %d), expected %d (%d)",
+		      s->name, ops[i].name, rc, errno, expect, err);
+		if (!rc) {
+			check(erases[0] + erases[1] - e == model.dirty,
+			      "%s, fw_setenv %s: %d erases", s->name,
+			      ops[i].name, erases[0] + erases[1] - e);
+			model.dirty = 0;
+		}
+		if (rc && err == ENOSPC)
+			check(strstr(captured, "\" not set") &&
+			      !strstr(captured, "deleted"),
+			      "%s: overflow message: %s", s->name, captured);
+		if (!rc)
+			p += sprintf(p, "%s %s\n", ops[i].name, ops[i].value);
+	}
+	model_check(&model, "one by one");
+
+	/* the changes which worked as one script, one erase */
+	reset(s);
+	rc = setenv_script(script);
+	check(rc == 0, "%s: script failed: %s", s->name, captured);
+	check(erases[0] + erases[1] == 1, "%s: script: %d erases", s->name,
+	      erases[0] + erases[1]);
+	model_check(&model, "script");
+
+	/* a failing line leaves the flash as it was */
+	read_devs(before);
+	e = erases[0] + erases[1];
+	p = script + sprintf(script, "big small\nnew1 value\nbig ");
+	memset(p, 'y', SECT_SIZE);
+	strcpy(p + SECT_SIZE, "\nnew2 value\n");
+	rc = setenv_script(script);
+	read_devs(after);
+	check(rc != 0, "%s: overflowing script worked", s->name);
+	check(erases[0] + erases[1] == e &&
+	      !memcmp(before, after, sizeof(before)),
+	      "%s: failed script changed the flash", s->name);
+	check(strstr(captured, "\"big\" not set") &&
+	      strstr(captured, "nothing written") &&
+	      !strstr(captured, "deleted"),
+	      "%s: script overflow message: %s", s->name, captured);
+}
+
+static void check_sequences(void)
+{
+	const struct setup *s;
+	int i;
+
+	for (s = setups; s < setups + ARRAY_SIZE(setups); s++)
+		for (i = 0; i < SEQUENCES && !fails; i++)
+			check_sequence(s, 1 + rnd(MAX_OPS));
+}
+
+static void check_library(void)
+{
+	char lib1[] = "lib1", lib2[] = "lib2", one[] = "one", two[] = "two";
+	char *big = malloc(SECT_SIZE);
+	const char *val;
+	int rc;
+
+	reset(&setups[0]);
+	check(fw_env_open() == 0, "open failed");
+	check(fw_env_write(lib1, one) == 0, "write lib1 failed");
+	val = fw_getenv(lib1);
+	check(val && !strcmp(val, "one"), "lib1 not seen before commit");
+	check(fw_env_commit() == 0, "first commit failed");
+	check(fw_env_write(lib2, two) == 0 && fw_env_write(lib1, NULL) == 0,
+	      "second writes failed");
+	check(fw_env_commit() == 0, "second commit failed");
+	fw_env_close();
+	check(erases[0] == 1 && erases[1] == 1,
+	      "commits did not alternate: %d/%d erases", erases[0], erases[1]);
+
+	/* reread from flash */
+	check(!fw_getenv(lib1), "lib1 still set");
+	val = fw_getenv(lib2);
+	check(val && !strcmp(val, "two"), "lib2 lost");
+
+	/* overflow: the library user is told the old value is gone */
+	memset(big, 'y', SECT_SIZE - 1);
+	big[SECT_SIZE - 1] = '\0';
+	capture_start(2);
+	rc = fw_env_write(lib2, big);
+	capture_end();
+	check(rc == -1 && errno == ENOSPC, "overflow: %d, errno %d", rc,
+	      errno);
+	check(!fw_getenv(lib2), "lib2 still set after overflow");
+	check(strstr(captured, "\"lib2\" deleted") != NULL,
+	      "library overflow message: %s", captured);
+	fw_env_close();
+	free(big);
+}
+
+/* Setting BENCH_VARS variables one by one and as one script */
+static void bench(void)
+{
+	const struct setup *s;
+	unsigned long long t0, t1, t2;
+	struct op op;
+	char name[16];
+	int i, e;
+	char *p;
+
+	for (s = setups; s < setups + ARRAY_SIZE(setups); s++) {
+		reset(s);
+		p = script;
+		t0 = bench_ns();
+		for (i = 0; i < BENCH_VARS; i++) {
+			sprintf(name, "var%d", i);
+			sprintf(op.value, "value%d", i);
+			op.name = name;
+			op.words = 1;
+			setenv_op(&op);
+			p += sprintf(p, "%s %s\n", name, op.value);
+		}
+		t0 = bench_ns() - t0;
+		e = erases[0] + erases[1];
+		reset(s);
+		t1 = bench_ns();
+		setenv_script(script);
+		t2 = bench_ns();
+		printf("  %-16s %d variables: one by one %4d erases %8.2f ms, "
+		       "script %d erases %6.2f ms\n", s->name, BENCH_VARS, e,
+		       t0 / 1e6, erases[0] + erases[1],
+		       (t2 - t1) / 1e6);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	char dir[] = "/tmp/fw_env_test.XXXXXX";
+	int i, fd;
+
+	if (!mkdtemp(dir) || chdir(dir)) {
+		perror(dir);
+		return 1;
+	}
+	/* fw_env.c warns about every blank flash, the checks print to stdout */
+	fd = open("/dev/null", O_WRONLY);
+	if (fd >= 0) {
+		dup2(fd, 2);
+		close(fd);
+	}
+
+	if (argc > 1 && !strcmp(argv[1], "-b")) {
+		bench();
+	} else {
+		check_sequences();
+		check_library();
+	}
+
+	unlink("fw_env_test.config");
+	unlink("fw_env_test.script");
+	for (i = 0; i < 2; i++)
+		unlink(dev_names[i]);
+	if (chdir("/") || rmdir(dir))
+		perror(dir);
+
+	if (fails) {
+		printf("fw_env_test: %d failures\n", fails);
+		return 1;
+	}
+	if (argc == 1)
+		printf("fw_env_test: all checks passed\n");
+	return 0;
+}
@@ -0,0 +1,427 @@
+/*
+ * Host test and benchmark for lib_generic SHA-1, SHA-256 and MD5
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * Checks the FIPS 180-2 and RFC 1321 test vectors, then hashes random
+ * data at every alignment and in random sized pieces: the word oriented
+ * block paths are only taken for aligned input, so both paths must give
+ * the same digest.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "sha1.h"
+#include "sha256.h"
+#include <u-boot/md5.h>
+#include "bench.h"
+
+#define MAX_SUM		32
+
+struct hash_algo {
+	const char *name;
+	int len;
+	void (*start)(void *ctx);
+	void (*update)(void *ctx, unsigned char *buf, int len);
+	void (*finish)(void *ctx, unsigned char *sum);
+};
+
+static void sha1_start_(void *ctx)
+{
+	sha1_starts(ctx);
+}
+
+static void sha1_update_(void *ctx, unsigned char *buf, int len)
+{
+	sha1_update(ctx, buf, len);
+}
+
+static void sha1_finish_(void *ctx, unsigned char *sum)
+{
+	sha1_finish(ctx, sum);
+}
+
+static void sha256_start_(void *ctx)
+{
+	sha256_starts(ctx);
+}
+
+static void sha256_update_(void *ctx, unsigned char *buf, int len)
+{
+	sha256_update(ctx, buf, len);
+}
+
+static void sha256_finish_(void *ctx, unsigned char *sum)
+{
+	sha256_finish(ctx, sum);
+}
+
+/*
+ * md5.c keeps MD5Init/Update/Final static, so the MD5 "context" here
+ * just gathers the message for a single md5() call.  The piecewise
+ * MD5Update() calls are checked through md5_wd() in check_md5_wd().
+ */
+struct md5_acc {
+	unsigned char *buf;
+	size_t len;
+};
+
+static void md5_start_(void *ctx)
+{
+	struct md5_acc *acc = ctx;
+
+	acc->buf = NULL;
+	acc->len = 0;
+}
+
+static void md5_update_(void *ctx, unsigned char *buf, int len)
+{
+	struct md5_acc *acc = ctx;
+
+	acc->buf = realloc(acc->buf, acc->len + len + 1);
+	if (!acc->buf) {
+		perror("realloc");
+		exit(EXIT_FAILURE);
+	}
+	memcpy(acc->buf + acc->len, buf, len);
+	acc->len += len;
+}
+
+static void md5_finish_(void *ctx, unsigned char *sum)
+{
+	struct md5_acc *acc = ctx;
+
+	md5(acc->buf, acc->len, sum);
+	free(acc->buf);
+}
+
+static const struct hash_algo algos[] = {
+	{ "md5", 16, md5_start_, md5_update_, md5_finish_ },
+	{ "sha1", 20, sha1_start_, sha1_update_, sha1_finish_ },
+	{ "sha256", 32, sha256_start_, sha256_update_, sha256_finish_ },
+};
+
+union hash_ctx {
+	sha1_context sha1;
+	sha256_context sha256;
+	struct md5_acc md5;
+};
+
+struct hash_vector {
+	const char *algo;
+	const char *msg;
+	int repeat;		/* msg is hashed this many times */
+	const char *sum;
+};
+
+static const struct hash_vector vectors[] = {
+	/* RFC 1321, appendix A.5 */
+	{ "md5", "", 1, "d41d8cd98f00b204e9800998ecf8427e" },
+	{ "md5", "a", 1, "0cc175b9c0f1b6a831c399e269772661" },
+	{ "md5", "abc", 1, "900150983cd24fb0d6963f7d28e17f72" },
+	{ "md5", "message digest", 1, "f96b697d7cb7938d525a2f31aaf161d0" },
+	{ "md5", "abcdefghijklmnopqrstuvwxyz", 1,
+	  "c3fcd3d76192e4007dfb496cca67e13b" },
+	{ "md5", "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz"
+		 "0123456789", 1,
+	  "d174ab98d277d9f5a5611c2c9f419d9f" },
+	{ "md5", "1234567890", 8, "57edf4a22be3c955ac49da2e2107b67a" },
+	/* FIPS 180-2, appendix A */
+	{ "sha1", "abc", 1, "a9993e364706816aba3e25717850c26c9cd0d89d" },
+	{ "sha1", "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 1,
+	  "84983e441c3bd26ebaae4aa1f95129e5e54670f1" },
+	{ "sha1", "a", 1000000, "34aa973cd4c4daa4f61eeb2bdbad27316534016f" },
+	/* FIPS 180-2, appendix B */
+	{ "sha256", "abc", 1,
+	  "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" },
+	{ "sha256", "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+	  1,
+	  "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" },
+	{ "sha256", "a", 1000000,
+	  "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0" },
+};
+
+static const struct hash_algo *find_algo(const char *name)
+{
+	int i;
+
+	for (i = 0; i < sizeof(algos) / sizeof(algos[0]); i++)
+		if (!strcmp(algos[i].name, name))
+			return &algos[i];
+	return NULL;
+}
+
+static void to_hex(const unsigned char *sum, int len, char *hex)
+{
+	int i;
+
+	for (i = 0; i < len; i++)
+		sprintf(hex + 2 * i, "%02x", sum[i]);
+}
+
+static int check_vectors(void)
+{
+	const struct hash_vector *v;
+	const struct hash_algo *a;
+	unsigned char *buf, sum[MAX_SUM];
+	char hex[2 * MAX_SUM + 1];
+	union hash_ctx ctx;
+	size_t mlen;
+	int i, r, fail = 0;
+
+	for (i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++) {
+		v = &vectors[i];
+		a = find_algo(v->algo);
+		mlen = strlen(v->msg);
+
+		/* Whole message in one buffer, so long runs hit the fast path */
+		buf = malloc(mlen * v->repeat + 1);
+		if (!buf) {
+			perror("malloc");
+			exit(EXIT_FAILURE);
+		}
+		for (r = 0; r < v->repeat; r++)
+			memcpy(buf + r * mlen, v->msg, mlen);
+
+		a->start(&ctx);
+		a->update(&ctx, buf, mlen * v->repeat);
+		a->finish(&ctx, sum);
+		free(buf);
+
+		to_hex(sum, a->len, hex);
+		if (strcmp(hex, v->sum)) {
+			printf("  %s vector %d: got %s, expected %s\n",
+			       v->algo, i, hex, v->sum);
+			fail++;
+		}
+	}
+	return fail;
+}
+
+/*
+ * Hash the same random message from every alignment, both in one call
+ * and in random sized pieces, and compare with the aligned one-shot
+ * digest.
+ */
+static int check_alignment(unsigned int seed, int rounds)
+{
+	const struct hash_algo *a;
+	unsigned char *buf, *msg, ref[MAX_SUM], sum[MAX_SUM];
+	union hash_ctx ctx;
+	int i, n, off, len, done, piece, fail = 0;
+
+	buf = malloc(8192 + 8);
+	if (!buf) {
+		perror("malloc");
+		exit(EXIT_FAILURE);
+	}
+
+	for (n = 0; n < rounds; n++) {
+		len = bench_rand(&seed) % 8192;
+		bench_fill(buf, len, &seed);
+
+		for (i = 0; i < sizeof(algos) / sizeof(algos[0]); i++) {
+			a = &algos[i];
+			a->start(&ctx);
+			a->update(&ctx, buf, len);
+			a->finish(&ctx, ref);
+
+			for (off = 1; off < 8; off++) {
+				msg = buf + off;
+				memmove(msg, buf, len);
+
+				a->start(&ctx);
+				for (done = 0; done < len; done += piece) {
+					piece = bench_rand(&seed) % 300;
+					if (piece > len - done)
+						piece = len - done;
+					a->update(&ctx, msg + done, piece);
+				}
+				a->finish(&ctx, sum);
+				memmove(buf, msg, len);
+
+				if (memcmp(ref, sum, a->len)) {
+					printf("  %s: %d bytes at offset %d "
+					       "differ (seed %u)\n", a->name,
+					       len, off, seed);
+					fail++;
+				}
+			}
+		}
+	}
+	free(buf);
+	return fail;
+}
+
+/*
+ * md5.o is built with a watchdog, so md5_wd() hashes in chunk_sz
+ * pieces and calls this after each of them.
+ */
+static int watchdog_calls;
+
+void hw_watchdog_reset(void)
+{
+	watchdog_calls++;
+}
+
+/*
+ * Hash random messages with md5_wd() in pieces which fill, straddle and
+ * exactly end MD5 blocks, from every alignment, and compare with md5()
+ * of the whole aligned message.
+ */
+static int check_md5_wd(unsigned int seed, int rounds)
+{
+	static const unsigned int chunks[] = {
+		1, 2, 3, 7, 55, 56, 63, 64, 65, 100, 128, 191, 0,
+	};
+	unsigned char *buf, *msg, ref[16], sum[16];
+	unsigned int chunk;
+	int i, n, off, len, fail = 0;
+
+	buf = malloc(8192 + 8);
+	if (!buf) {
+		perror("malloc");
+		exit(EXIT_FAILURE);
+	}
+
+	for (n = 0; n < rounds; n++) {
+		len = bench_rand(&seed) % 8192;
+		bench_fill(buf, len, &seed);
+		md5(buf, len, ref);
+
+		for (i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++) {
+			/* the last one is random */
+			chunk = chunks[i] ? chunks[i] :
+				1 + bench_rand(&seed) % 300;
+			for (off = 0; off < 8; off++) {
+				msg = buf + off;
+				memmove(msg, buf, len);
+
+				watchdog_calls = 0;
+				md5_wd(msg, len, sum, chunk);
+				memmove(buf, msg, len);
+
+				if (memcmp(ref, sum, 16)) {
+					printf("  md5_wd: %d bytes at offset "
+					       "%d in %u byte chunks differ "
+					       "(seed %u)\n", len, off, chunk,
+					       seed);
+					fail++;
+				}
+				if (watchdog_calls != (len + chunk - 1) / chunk) {
+					printf("  md5_wd: %d bytes in %u byte "
+					       "chunks took %d pieces\n", len,
+					       chunk, watchdog_calls);
+					fail++;
+				}
+			}
+		}
+	}
+	free(buf);
+	return fail;
+}
+
+static void bench(size_t size, int loops)
+{
+	const struct hash_algo *a;
+	unsigned char *buf, sum[MAX_SUM];
+	unsigned long long ns, cyc;
+	unsigned int seed = 1;
+	union hash_ctx ctx;
+	int i, l, off;
+
+	buf = malloc(size + 4);
+	if (!buf) {
+		perror("malloc");
+		exit(EXIT_FAILURE);
+	}
+	bench_fill(buf, size + 4, &seed);
+
+	printf("hash_test: %lu bytes, %d loops\n", (unsigned long)size, loops);
+	for (i = 0; i < sizeof(algos) / sizeof(algos[0]); i++) {
+		a = &algos[i];
+		for (off = 0; off < 2; off++) {
+			char name[32];
+
+			/* One untimed pass to warm up caches */
+			a->start(&ctx);
+			a->update(&ctx, buf + off, size);
+			a->finish(&ctx, sum);
+
+			ns = bench_ns();
+			cyc = bench_cycles();
+			for (l = 0; l < loops; l++) {
+				a->start(&ctx);
+				a->update(&ctx, buf + off, size);
+				a->finish(&ctx, sum);
+			}
+			cyc = bench_cycles() - cyc;
+			ns = bench_ns() - ns;
+
+			sprintf(name, "%s%s", a->name,
+				off ? " (unaligned)" : "");
+			bench_report(name, (unsigned long long)size * loops,
+				     ns, cyc);
+		}
+	}
+	free(buf);
+}
+
+int main(int argc, char **argv)
+{
+	unsigned long size = 1 << 20;
+	int opt, loops = 16, do_bench = 0, fail;
+
+	while ((opt = getopt(argc, argv, "bs:l:")) != -1) {
+		switch (opt) {
+		case 'b':
+			do_bench = 1;
+			break;
+		case 's':
+			size = strtoul(optarg, NULL, 0);
+			break;
+		case 'l':
+			loops = strtoul(optarg, NULL, 0);
+			break;
+		default:
+			fprintf(stderr, "Usage: %s [-b [-s size] [-l loops]]\n",
+				*argv);
+			exit(EXIT_FAILURE);
+		}
+	}
+	if (do_bench) {
+		bench(size, loops);
+		return 0;
+	}
+
+	fail = check_vectors();
+	fail += check_alignment(1, 200);
+	fail += check_md5_wd(1, 50);
+	if (fail) {
+		printf("hash_test: %d failures\n", fail);
+		return 1;
+	}
+	printf("hash_test: all checks passed\n");
+	return 0;
+}
@@ -0,0 +1,285 @@
+/*
+ * hush parse cache test
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * Runs scripts from the environment with "run", as bootcmd does, on the
+ * real hush, command table and environment commands.  hush.c is
+ * included here, so that the checks can look at its parse cache: a
+ * script run again must reuse its parse tree, nested "run"s and loops
+ * must give the same output every time, and setting a variable to a
+ * new script must run the new text.  The "echo_x" command records its
+ * arguments and then scribbles over them, which must not reach a
+ * cached tree.  With -b a loop and if/else script is timed when it is
+ * found in the cache and when it is parsed on every run.
+ */
+
+#include "../common/hush.c"
+
+#include <environment.h>
+
+extern int env_init(void);
+extern void env_relocate(void);
+extern int board_run(const char *fmt, ...);
+
+/* env_nowhere.c has no saveenv, the board config asks for the command */
+char *env_name_spec = "nowhere";
+
+int saveenv(void)
+{
+	return 1;
+}
+
+/*
+ * cmd_nvedit.o is shared with nand_test, which has no do_run(), so it
+ * is built without CONFIG_CMD_RUN; register "run" here as it would.
+ */
+int do_run(cmd_tbl_t *cmdtp, int flag, int argc, char *argv[]);
+U_BOOT_CMD(
+	run,	CONFIG_SYS_MAXARGS,	1,	do_run,
+	"run commands in an environment variable",
+	"var [...]"
+);
+
+static int fails;
+
+#define check(cond, fmt, args...) do {					\
+		if (!(cond)) {						\
+			printf("  FAIL %s:%d: " fmt "\n", __func__,	\
+			       __LINE__, ##args);			\
+			fails++;					\
+		}							\
+	} while (0)
+
+/* What echo_x was called with since the last run_script() */
+static char out[512];
+
+static int do_echo_x(cmd_tbl_t *cmdtp, int flag, int argc, char *argv[])
+{
+	int i;
+
+	for (i = 1; i < argc; i++) {
+		if (*out)
+			strcat(out, " ");
+		strcat(out, argv[i]);
+		/* a command may change its arguments */
+		memset(argv[i], 'X', strlen(argv[i]));
+	}
+	return 0;
+}
+
+U_BOOT_CMD(
+	echo_x,	CONFIG_SYS_MAXARGS,	0,	do_echo_x,
+	"record the arguments, then overwrite them",
+	"args..."
+);
+
+/* "run name" with the script set to text, if text is not NULL */
+static const char *run_script(const char *name, const char *text)
+{
+	if (text)
+		setenv((char *)name, (char *)text);
+	*out = 0;
+	board_run("run %s", name);
+	return out;
+}
+
+static struct parse_cache *cache_entry(const char *text)
+{
+	int i;
+
+	for (i = 0; i < CONFIG_SYS_HUSH_PARSE_CACHE; i++)
+		if (parse_cache[i].list && !strcmp(parse_cache[i].text, text))
+			return &parse_cache[i];
+	return NULL;
+}
+
+static void check_hit(void)
+{
+	const char *text = "echo_x one two; echo_x three";
+	struct parse_cache *pc;
+	struct pipe *list;
+	ulong used;
+	int i;
+
+	check(!strcmp(run_script("s", text), "one two three"),
+	      "first run gave \"%s\"", out);
+	pc = cache_entry(text);
+	check(pc, "script not cached");
+	if (!pc)
+		return;
+	list = pc->list;
+	used = pc->used;
+
+	for (i = 0; i < 3; i++) {
+		check(!strcmp(run_script("s", NULL), "one two three"),
+		      "run %d gave \"%s\"", i + 2, out);
+		check(pc->list == list && !strcmp(pc->text, text),
+		      "run %d parsed the script again", i + 2);
+		check(pc->used > used, "run %d did not use the entry", i + 2);
+		check(!pc->busy, "entry still busy after run %d", i + 2);
+		used = pc->used;
+	}
+}
+
+static void check_nested(void)
+{
+	const char *inner = "echo_x in";
+	const char *outer = "echo_x pre; run inner; echo_x post";
+	const char *loop = "for i in a b c; do echo_x $i; run inner; done";
+	int i;
+
+	setenv("inner", (char *)inner);
+	for (i = 0; i < 3; i++) {
+		check(!strcmp(run_script("outer", outer), "pre in post"),
+		      "run %d gave \"%s\"", i + 1, out);
+		check(!strcmp(run_script("loop", loop),
+			      "a in b in c in"),
+		      "loop run %d gave \"%s\"", i + 1, out);
+	}
+	for (i = 0; i < CONFIG_SYS_HUSH_PARSE_CACHE; i++)
+		check(!parse_cache[i].busy, "entry %d still busy", i);
+	check(cache_entry(inner) && cache_entry(outer) && cache_entry(loop),
+	      "nested scripts not all cached");
+
+	/* a script which runs itself: the running entry is not reused */
+	setenv("n", "");
+	run_script("self", "echo_x x$n; if test x$n = x; then setenv n 1; "
+			   "run self; fi");
+	check(!strcmp(out, "x x1"), "recursion gave \"%s\"", out);
+	run_script("self", NULL);
+	check(!strcmp(out, "x1"), "second recursion run gave \"%s\"", out);
+
+	/* the same inside a loop, whose tree is patched while it runs */
+	setenv("n", "");
+	run_script("self", "for i in a b; do echo_x $i$n; if test x$n = x; "
+			   "then setenv n 1; run self; fi; done");
+	check(!strcmp(out, "a a1 b1 b1"), "recursion in a loop gave \"%s\"",
+	      out);
+
+	/* a running script is not evicted by the ones it runs */
+	setenv("e1", "echo_x e1");
+	setenv("e2", "echo_x e2");
+	setenv("e3", "echo_x e3");
+	setenv("e4", "echo_x e4");
+	check(!strcmp(run_script("deep", "echo_x d; run e1 e2 e3 e4; echo_x d"),
+		      "d e1 e2 e3 e4 d"),
+	      "deep run gave \"%s\"", out);
+	check(cache_entry("echo_x d; run e1 e2 e3 e4; echo_x d"),
+	      "running script was evicted");
+}
+
+static void check_change(void)
+{
+	check(!strcmp(run_script("s", "echo_x old"), "old"),
+	      "old script gave \"%s\"", out);
+	check(!strcmp(run_script("s", "echo_x new"), "new"),
+	      "changed script gave \"%s\"", out);
+	check(!strcmp(run_script("s", "echo_x old"), "old"),
+	      "old script again gave \"%s\"", out);
+
+	/* variables in the arguments are expanded on every run */
+	setenv("v", "1");
+	check(!strcmp(run_script("s", "echo_x v$v"), "v1"),
+	      "v=1 gave \"%s\"", out);
+	setenv("v", "2");
+	check(!strcmp(run_script("s", NULL), "v2"),
+	      "v=2 gave \"%s\"", out);
+	check(cache_entry("echo_x v$v"), "script with $v not cached");
+}
+
+static void check_evict(void)
+{
+	char text[CONFIG_SYS_HUSH_PARSE_CACHE + 2][32], want[32];
+	int i, n = CONFIG_SYS_HUSH_PARSE_CACHE + 2;
+
+	for (i = 0; i < n; i++) {
+		sprintf(text[i], "echo_x e%d", i);
+		sprintf(want, "e%d", i);
+		check(!strcmp(run_script("s", text[i]), want),
+		      "script %d gave \"%s\"", i, out);
+	}
+	/* the least recently used ones made room */
+	for (i = 0; i < n; i++)
+		check(!cache_entry(text[i]) == (i < 2),
+		      "script %d %scached", i, cache_entry(text[i]) ? "" : "not ");
+	check(!strcmp(run_script("s", text[0]), "e0"),
+	      "evicted script gave \"%s\"", out);
+}
+
+#define BENCH_RUNS	20000
+#define BENCH_SCRIPT	"for i in a b c; do if test $i = b; then echo_x $i; " \
+			"else echo_x -; fi; done"
+
+/*
+ * Cached: the same script every time.  Parsed: more scripts than cache
+ * entries, run in turn, so that every run misses.
+ */
+static void bench(void)
+{
+	char name[8], text[128];
+	unsigned long long t0, t1, t2;
+	int i;
+
+	for (i = 0; i <= CONFIG_SYS_HUSH_PARSE_CACHE; i++) {
+		sprintf(name, "b%d", i);
+		sprintf(text, BENCH_SCRIPT "; echo_x %d", i);
+		setenv(name, text);
+	}
+
+	t0 = get_ticks();
+	for (i = 0; i < BENCH_RUNS; i++)
+		run_script("b0", NULL);
+	t1 = get_ticks();
+	for (i = 0; i < BENCH_RUNS; i++) {
+		sprintf(name, "b%d", i % (CONFIG_SYS_HUSH_PARSE_CACHE + 1));
+		run_script(name, NULL);
+	}
+	t2 = get_ticks();
+
+	printf("%d runs of \"%s\":\n", BENCH_RUNS, BENCH_SCRIPT);
+	printf("  cached  %8.2f us per run\n", (t1 - t0) / 1e3 / BENCH_RUNS);
+	printf("  parsed  %8.2f us per run\n", (t2 - t1) / 1e3 / BENCH_RUNS);
+}
+
+int main(int argc, char **argv)
+{
+	env_init();
+	env_relocate();
+	u_boot_hush_start();
+
+	if (argc > 1 && !strcmp(argv[1], "-b")) {
+		bench();
+		return 0;
+	}
+
+	check_hit();
+	check_nested();
+	check_change();
+	check_evict();
+
+	if (fails) {
+		printf("hush_test: %d failures\n", fails);
+		return 1;
+	}
+	puts("hush_test: all checks passed\n");
+	return 0;
+}
@@ -0,0 +1,25 @@
+/*
+ * Host stand-in for <asm/unaligned.h>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ */
+
+#ifndef __TEST_ASM_UNALIGNED_H
+#define __TEST_ASM_UNALIGNED_H
+
+#include <string.h>
+
+#define get_unaligned(p) ({			\
+	__typeof__(*(p)) __v;			\
+	memcpy(&__v, (p), sizeof(__v));		\
+	__v; })
+
+#define put_unaligned(v, p) do {		\
+	__typeof__(*(p)) __v = (v);		\
+	memcpy((p), &__v, sizeof(__v));		\
+	} while (0)
+
+#endif /* __TEST_ASM_UNALIGNED_H */
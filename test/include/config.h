@@ -0,0 +1,4 @@
+/*
+ * Host stand-in for the generated <config.h>: the test programs have no
+ * board, test/Makefile sets the options they need on the command line.
+ */
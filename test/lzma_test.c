@@ -0,0 +1,288 @@
+/*
+ * Host test and benchmark for the lib_generic LZMA decoder
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * The reference streams are made by the host's xz(1) in LZMA_Alone
+ * format. They are decoded with lzmaBuffToBuffDecompress() and with the
+ * streaming interface fed in chunks of random size, the way
+ * nand_read_lzma() feeds it from flash, and compared with the input.
+ * Both must refuse a destination which is too small.
+ * lzma_test uses 32-bit probabilities, lzma_test16 16-bit ones.
+ */
+
+#include <common.h>
+#include <unistd.h>
+#include <lzma/LzmaTools.h>
+#include "bench.h"
+
+#define DATA_SIZE	(1 << 20)
+#define LZMA_HDR_SIZE	13
+
+/* Text like data with some random stretches, as in a kernel image */
+static void fill(unsigned char *buf, size_t len, unsigned int seed)
+{
+	static const char *words[] = {
+		"mov r0, ", "ldr r1, [r0]", "bl printk", "str r2, [sp]",
+		"\0\0\0\0", "\xe5\x9f\x10\x10", "vmlinux", "console",
+	};
+	size_t n;
+	const char *w;
+
+	while (len) {
+		if (bench_rand(&seed) % 16 == 0) {
+			n = bench_rand(&seed) % 64;
+			if (n > len)
+				n = len;
+			bench_fill(buf, n, &seed);
+		} else {
+			w = words[bench_rand(&seed) % ARRAY_SIZE(words)];
+			n = strlen(w) ? strlen(w) : 4;
+			if (n > len)
+				n = len;
+			memcpy(buf, w, n);
+		}
+		buf += n;
+		len -= n;
+	}
+}
+
+/* xz --format=lzma output; with_size stores the length in the header */
+static unsigned char *compress(const unsigned char *data, size_t len,
+			       size_t *zlen, int with_size)
+{
+	char name[] = "/tmp/lzma_testXXXXXX";
+	char cmd[64];
+	unsigned char *z;
+	size_t size = len + len / 8 + 1024;
+	FILE *f;
+	int fd, i;
+
+	fd = mkstemp(name);
+	if (fd < 0 || write(fd, data, len) != len) {
+		perror(name);
+		exit(EXIT_FAILURE);
+	}
+	close(fd);
+
+	snprintf(cmd, sizeof(cmd), "xz --format=lzma -6 -c %s", name);
+	f = popen(cmd, "r");
+	z = malloc(size);
+	if (!f || !z) {
+		perror("xz");
+		exit(EXIT_FAILURE);
+	}
+	*zlen = fread(z, 1, size, f);
+	if (pclose(f) || *zlen <= LZMA_HDR_SIZE) {
+		fprintf(stderr, "xz failed\n");
+		exit(EXIT_FAILURE);
+	}
+	unlink(name);
+
+	if (with_size)
+		for (i = 0; i < 8; i++)
+			z[LZMA_PROPS_SIZE + i] = i < 4 ? len >> (i * 8) : 0;
+
+	/* Erased flash after the stream, as nand read.lzma sees it */
+	while (*zlen & 2047)
+		z[(*zlen)++] = 0xff;
+	return z;
+}
+
+/* Feed the stream in chunks of 1..max_chunk bytes, 0: fixed 2 KiB */
+static int stream_decode(unsigned char *out, size_t outlen,
+			 const unsigned char *z, size_t zlen,
+			 unsigned int seed, size_t max_chunk, size_t *done)
+{
+	LzmaStream s;
+	size_t off, n;
+	int res = SZ_OK;
+
+	lzmaStreamInit(&s, out, outlen);
+	for (off = 0; off < zlen && !s.finished; off += n) {
+		n = max_chunk ? 1 + bench_rand(&seed) % max_chunk : 2048;
+		if (n > zlen - off)
+			n = zlen - off;
+		res = lzmaStreamDecode(&s, z + off, n);
+		if (res != SZ_OK)
+			break;
+	}
+	*done = lzmaStreamOutLen(&s);
+	if (res == SZ_OK && !s.finished)
+		res = SZ_ERROR_INPUT_EOF;
+	lzmaStreamEnd(&s);
+	return res;
+}
+
+static int check(void)
+{
+	static const size_t chunks[] = { 1, 16, 5000, 0 };
+	unsigned char *data, *z, *out;
+	size_t zlen, outlen;
+	SizeT len;
+	int with_size, c, r, fail = 0;
+
+	data = malloc(DATA_SIZE);
+	out = malloc(DATA_SIZE + 1);
+	if (!data || !out) {
+		perror("malloc");
+		exit(EXIT_FAILURE);
+	}
+	fill(data, DATA_SIZE, 1);
+
+	for (with_size = 0; with_size < 2; with_size++) {
+		z = compress(data, DATA_SIZE, &zlen, with_size);
+
+		/* One call: exact room (a marker needs one more), more room */
+		for (c = 0; c < 2; c++) {
+			memset(out, 0xa5, DATA_SIZE + 1);
+			len = DATA_SIZE + !with_size + c;
+			r = lzmaBuffToBuffDecompress(out, &len, z, zlen);
+			if (r != SZ_OK || len != DATA_SIZE ||
+			    memcmp(out, data, DATA_SIZE)) {
+				printf("  one call, %s size, %lu bytes room: "
+				       "returned %d, %lu bytes\n",
+				       with_size ? "known" : "unknown",
+				       (unsigned long)DATA_SIZE + !with_size + c,
+				       r, (unsigned long)len);
+				fail++;
+			}
+		}
+
+		/* One call, room one byte short: error, nothing past it */
+		memset(out, 0xa5, DATA_SIZE);
+		len = DATA_SIZE - 1;
+		r = lzmaBuffToBuffDecompress(out, &len, z, zlen);
+		if (r == SZ_OK || out[DATA_SIZE - 1] != 0xa5) {
+			printf("  one call, %s size, short destination: "
+			       "returned %d\n",
+			       with_size ? "known" : "unknown", r);
+			fail++;
+		}
+
+		for (c = 0; c < ARRAY_SIZE(chunks); c++) {
+			memset(out, 0xa5, DATA_SIZE + 1);
+			r = stream_decode(out, DATA_SIZE + with_size, z, zlen,
+					  c + 1, chunks[c], &outlen);
+			if (r != SZ_OK || outlen != DATA_SIZE ||
+			    memcmp(out, data, DATA_SIZE)) {
+				printf("  stream, %s size, %lu byte chunks: "
+				       "returned %d, %lu bytes\n",
+				       with_size ? "known" : "unknown",
+				       (unsigned long)chunks[c], r,
+				       (unsigned long)outlen);
+				fail++;
+			}
+		}
+
+		/* Destination one byte short: error, nothing written past it */
+		memset(out, 0xa5, DATA_SIZE);
+		r = stream_decode(out, DATA_SIZE - 1, z, zlen, 1, 4096,
+				  &outlen);
+		if (r == SZ_OK || out[DATA_SIZE - 1] != 0xa5) {
+			printf("  stream, %s size, short destination: "
+			       "returned %d\n",
+			       with_size ? "known" : "unknown", r);
+			fail++;
+		}
+		free(z);
+	}
+	free(data);
+	free(out);
+	return fail;
+}
+
+static void bench(const char *name, int loops)
+{
+	unsigned char *data, *z, *out;
+	unsigned long long ns, cyc;
+	size_t zlen, outlen;
+	SizeT len;
+	int l;
+
+	data = malloc(DATA_SIZE);
+	out = malloc(DATA_SIZE);
+	if (!data || !out) {
+		perror("malloc");
+		exit(EXIT_FAILURE);
+	}
+	fill(data, DATA_SIZE, 1);
+	z = compress(data, DATA_SIZE, &zlen, 1);
+
+	/* lzmaMemUsage() comes from the library, so it tells the width */
+	printf("%s: %d bytes, %d loops, %lu byte model\n", name, DATA_SIZE,
+	       loops, (unsigned long)lzmaMemUsage(z));
+
+	ns = bench_ns();
+	cyc = bench_cycles();
+	for (l = 0; l < loops; l++) {
+		len = DATA_SIZE;
+		lzmaBuffToBuffDecompress(out, &len, z, zlen);
+	}
+	cyc = bench_cycles() - cyc;
+	ns = bench_ns() - ns;
+	bench_report("one call", (unsigned long long)DATA_SIZE * loops,
+		     ns, cyc);
+
+	ns = bench_ns();
+	cyc = bench_cycles();
+	for (l = 0; l < loops; l++)
+		stream_decode(out, DATA_SIZE, z, zlen, 1, 0, &outlen);
+	cyc = bench_cycles() - cyc;
+	ns = bench_ns() - ns;
+	bench_report("stream, 2 KiB chunks",
+		     (unsigned long long)DATA_SIZE * loops, ns, cyc);
+
+	free(z);
+	free(data);
+	free(out);
+}
+
+int main(int argc, char **argv)
+{
+	int opt, loops = 8, do_bench = 0, fail;
+
+	while ((opt = getopt(argc, argv, "bl:")) != -1) {
+		switch (opt) {
+		case 'b':
+			do_bench = 1;
+			break;
+		case 'l':
+			loops = strtoul(optarg, NULL, 0);
+			break;
+		default:
+			fprintf(stderr, "Usage: %s [-b [-l loops]]\n", *argv);
+			exit(EXIT_FAILURE);
+		}
+	}
+	if (do_bench) {
+		bench(*argv, loops);
+		return 0;
+	}
+
+	fail = check();
+	if (fail) {
+		printf("%s: %d failures\n", *argv, fail);
+		return 1;
+	}
+	printf("%s: all checks passed\n", *argv);
+	return 0;
+}
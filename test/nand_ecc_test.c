@@ -0,0 +1,324 @@
+/*
+ * Host test and benchmark for the software Hamming ECC in
+ * drivers/mtd/nand/nand_ecc.c
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * The word parallel nand_calculate_ecc() must produce exactly the bytes
+ * of the classic table driven version, or pages written by an older
+ * U-Boot (or Linux) would read back as corrupted.  The old code is kept
+ * below as the reference; random and patterned blocks at every
+ * alignment are compared against it, then every single bit data and
+ * ECC error is injected and corrected.
+ *
+ * nand_ecc.c is built for the host board (test/board), once with the
+ * default byte order and once with CONFIG_MTD_NAND_ECC_SMC; this file
+ * is built to match.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "bench.h"
+
+struct mtd_info;
+
+extern int nand_calculate_ecc(struct mtd_info *mtd, const unsigned char *dat,
+			      unsigned char *ecc_code);
+extern int nand_correct_data(struct mtd_info *mtd, unsigned char *dat,
+			     unsigned char *read_ecc, unsigned char *calc_ecc);
+
+#ifdef CONFIG_MTD_NAND_ECC_SMC
+#define NAME	"nand_ecc_test_smc"
+#else
+#define NAME	"nand_ecc_test"
+#endif
+
+/* Reference: nand_calculate_ecc() as it was before the word version */
+static const unsigned char nand_ecc_precalc_table[] = {
+	0x00, 0x55, 0x56, 0x03, 0x59, 0x0c, 0x0f, 0x5a, 0x5a, 0x0f, 0x0c, 0x59, 0x03, 0x56, 0x55, 0x00,
+	0x65, 0x30, 0x33, 0x66, 0x3c, 0x69, 0x6a, 0x3f, 0x3f, 0x6a, 0x69, 0x3c, 0x66, 0x33, 0x30, 0x65,
+	0x66, 0x33, 0x30, 0x65, 0x3f, 0x6a, 0x69, 0x3c, 0x3c, 0x69, 0x6a, 0x3f, 0x65, 0x30, 0x33, 0x66,
+	0x03, 0x56, 0x55, 0x00, 0x5a, 0x0f, 0x0c, 0x59, 0x59, 0x0c, 0x0f, 0x5a, 0x00, 0x55, 0x56, 0x03,
+	0x69, 0x3c, 0x3f, 0x6a, 0x30, 0x65, 0x66, 0x33, 0x33, 0x66, 0x65, 0x30, 0x6a, 0x3f, 0x3c, 0x69,
+	0x0c, 0x59, 0x5a, 0x0f, 0x55, 0x00, 0x03, 0x56, 0x56, 0x03, 0x00, 0x55, 0x0f, 0x5a, 0x59, 0x0c,
+	0x0f, 0x5a, 0x59, 0x0c, 0x56, 0x03, 0x00, 0x55, 0x55, 0x00, 0x03, 0x56, 0x0c, 0x59, 0x5a, 0x0f,
+	0x6a, 0x3f, 0x3c, 0x69, 0x33, 0x66, 0x65, 0x30, 0x30, 0x65, 0x66, 0x33, 0x69, 0x3c, 0x3f, 0x6a,
+	0x6a, 0x3f, 0x3c, 0x69, 0x33, 0x66, 0x65, 0x30, 0x30, 0x65, 0x66, 0x33, 0x69, 0x3c, 0x3f, 0x6a,
+	0x0f, 0x5a, 0x59, 0x0c, 0x56, 0x03, 0x00, 0x55, 0x55, 0x00, 0x03, 0x56, 0x0c, 0x59, 0x5a, 0x0f,
+	0x0c, 0x59, 0x5a, 0x0f, 0x55, 0x00, 0x03, 0x56, 0x56, 0x03, 0x00, 0x55, 0x0f, 0x5a, 0x59, 0x0c,
+	0x69, 0x3c, 0x3f, 0x6a, 0x30, 0x65, 0x66, 0x33, 0x33, 0x66, 0x65, 0x30, 0x6a, 0x3f, 0x3c, 0x69,
+	0x03, 0x56, 0x55, 0x00, 0x5a, 0x0f, 0x0c, 0x59, 0x59, 0x0c, 0x0f, 0x5a, 0x00, 0x55, 0x56, 0x03,
+	0x66, 0x33, 0x30, 0x65, 0x3f, 0x6a, 0x69, 0x3c, 0x3c, 0x69, 0x6a, 0x3f, 0x65, 0x30, 0x33, 0x66,
+	0x65, 0x30, 0x33, 0x66, 0x3c, 0x69, 0x6a, 0x3f, 0x3f, 0x6a, 0x69, 0x3c, 0x66, 0x33, 0x30, 0x65,
+	0x00, 0x55, 0x56, 0x03, 0x59, 0x0c, 0x0f, 0x5a, 0x5a, 0x0f, 0x0c, 0x59, 0x03, 0x56, 0x55, 0x00
+};
+
+static void ref_calculate_ecc(const unsigned char *dat, unsigned char *ecc_code)
+{
+	uint8_t idx, reg1, reg2, reg3, tmp1, tmp2;
+	int i;
+
+	reg1 = reg2 = reg3 = 0;
+
+	for (i = 0; i < 256; i++) {
+		idx = nand_ecc_precalc_table[*dat++];
+		reg1 ^= (idx & 0x3f);
+
+		if (idx & 0x40) {
+			reg3 ^= (uint8_t) i;
+			reg2 ^= ~((uint8_t) i);
+		}
+	}
+
+	tmp1  = (reg3 & 0x80) >> 0;
+	tmp1 |= (reg2 & 0x80) >> 1;
+	tmp1 |= (reg3 & 0x40) >> 1;
+	tmp1 |= (reg2 & 0x40) >> 2;
+	tmp1 |= (reg3 & 0x20) >> 2;
+	tmp1 |= (reg2 & 0x20) >> 3;
+	tmp1 |= (reg3 & 0x10) >> 3;
+	tmp1 |= (reg2 & 0x10) >> 4;
+
+	tmp2  = (reg3 & 0x08) << 4;
+	tmp2 |= (reg2 & 0x08) << 3;
+	tmp2 |= (reg3 & 0x04) << 3;
+	tmp2 |= (reg2 & 0x04) << 2;
+	tmp2 |= (reg3 & 0x02) << 2;
+	tmp2 |= (reg2 & 0x02) << 1;
+	tmp2 |= (reg3 & 0x01) << 1;
+	tmp2 |= (reg2 & 0x01) << 0;
+
+#ifdef CONFIG_MTD_NAND_ECC_SMC
+	ecc_code[0] = ~tmp2;
+	ecc_code[1] = ~tmp1;
+#else
+	ecc_code[0] = ~tmp1;
+	ecc_code[1] = ~tmp2;
+#endif
+	ecc_code[2] = ((~reg1) << 2) | 0x03;
+}
+
+static int compare_block(const unsigned char *dat, const char *what,
+			 unsigned int seed)
+{
+	unsigned char ref[3], ecc[3];
+
+	ref_calculate_ecc(dat, ref);
+	nand_calculate_ecc(NULL, dat, ecc);
+	if (memcmp(ref, ecc, 3)) {
+		printf("  %s (seed %u): ecc %02x%02x%02x, expected "
+		       "%02x%02x%02x\n", what, seed, ecc[0], ecc[1], ecc[2],
+		       ref[0], ref[1], ref[2]);
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * Patterned blocks (all zeroes, all ones, every single bit set and every
+ * single bit clear) and random blocks, each at all four word alignments
+ * since misaligned input takes the bounce buffer path.
+ */
+static int check_equivalence(unsigned int seed, int rounds)
+{
+	unsigned char buf[256 + 4], *dat;
+	int n, bit, off, fail = 0;
+
+	for (off = 0; off < 4; off++) {
+		dat = buf + off;
+
+		memset(dat, 0, 256);
+		fail += compare_block(dat, "zeroes", 0);
+		memset(dat, 0xff, 256);
+		fail += compare_block(dat, "ones", 0);
+
+		for (bit = 0; bit < 256 * 8; bit++) {
+			memset(dat, 0, 256);
+			dat[bit >> 3] = 1 << (bit & 7);
+			fail += compare_block(dat, "single bit set", bit);
+			memset(dat, 0xff, 256);
+			dat[bit >> 3] = ~(1 << (bit & 7));
+			fail += compare_block(dat, "single bit clear", bit);
+		}
+
+		for (n = 0; n < rounds; n++) {
+			unsigned int s = seed;
+
+			bench_fill(dat, 256, &seed);
+			fail += compare_block(dat, "random", s);
+		}
+		if (fail)
+			break;
+	}
+	return fail;
+}
+
+/*
+ * Every single bit data error must be located and repaired, every single
+ * bit ECC error reported as corrected without touching the data, and
+ * double bit data errors refused.
+ */
+static int check_correction(unsigned int seed, int rounds)
+{
+	unsigned char good[256], dat[256], read_ecc[3], calc_ecc[3];
+	int n, bit, bit2, ret, fail = 0;
+
+	for (n = 0; n < rounds && !fail; n++) {
+		bench_fill(good, sizeof(good), &seed);
+		nand_calculate_ecc(NULL, good, read_ecc);
+
+		for (bit = 0; bit < 256 * 8; bit++) {
+			memcpy(dat, good, sizeof(dat));
+			dat[bit >> 3] ^= 1 << (bit & 7);
+			nand_calculate_ecc(NULL, dat, calc_ecc);
+			ret = nand_correct_data(NULL, dat, read_ecc, calc_ecc);
+			if (ret != 1 || memcmp(dat, good, sizeof(dat))) {
+				printf("  data bit %d (seed %u): not corrected, "
+				       "ret %d\n", bit, seed, ret);
+				fail++;
+			}
+
+			/* a second flip 1..8 bytes away */
+			bit2 = (bit + 8 * (1 + bench_rand(&seed) % 8)) % 2048;
+			memcpy(dat, good, sizeof(dat));
+			dat[bit >> 3] ^= 1 << (bit & 7);
+			dat[bit2 >> 3] ^= 1 << (bit2 & 7);
+			nand_calculate_ecc(NULL, dat, calc_ecc);
+			ret = nand_correct_data(NULL, dat, read_ecc, calc_ecc);
+			if (ret >= 0) {
+				printf("  data bits %d,%d (seed %u): double "
+				       "error not detected, ret %d\n", bit,
+				       bit2, seed, ret);
+				fail++;
+			}
+		}
+
+		/* The two low bits of the third byte are always set */
+		for (bit = 0; bit < 24; bit++) {
+			if (bit == 16 || bit == 17)
+				continue;
+			memcpy(dat, good, sizeof(dat));
+			memcpy(calc_ecc, read_ecc, 3);
+			calc_ecc[bit >> 3] ^= 1 << (bit & 7);
+			ret = nand_correct_data(NULL, dat, read_ecc, calc_ecc);
+			if (ret != 1 || memcmp(dat, good, sizeof(dat))) {
+				printf("  ecc bit %d (seed %u): ret %d\n", bit,
+				       seed, ret);
+				fail++;
+			}
+		}
+	}
+	return fail;
+}
+
+static void ecc_pass(const unsigned char *buf, size_t size, int ref)
+{
+	unsigned char ecc[3];
+	size_t pos;
+
+	for (pos = 0; pos + 256 <= size; pos += 256) {
+		if (ref)
+			ref_calculate_ecc(buf + pos, ecc);
+		else
+			nand_calculate_ecc(NULL, buf + pos, ecc);
+	}
+}
+
+static void bench(size_t size, int loops)
+{
+	unsigned char *buf;
+	unsigned long long ns, cyc;
+	unsigned int seed = 1;
+	int l, off, ref;
+
+	buf = malloc(size + 4);
+	if (!buf) {
+		perror("malloc");
+		exit(EXIT_FAILURE);
+	}
+	bench_fill(buf, size + 4, &seed);
+
+	printf(NAME ": %lu bytes, %d loops\n", (unsigned long)size, loops);
+	for (ref = 1; ref >= 0; ref--) {
+		for (off = 0; off < 2; off++) {
+			char name[32];
+
+			/* One untimed pass to warm up caches */
+			ecc_pass(buf + off, size, ref);
+
+			ns = bench_ns();
+			cyc = bench_cycles();
+			for (l = 0; l < loops; l++)
+				ecc_pass(buf + off, size, ref);
+			cyc = bench_cycles() - cyc;
+			ns = bench_ns() - ns;
+
+			sprintf(name, "%s%s", ref ? "table (old)" : "word",
+				off ? " (unaligned)" : "");
+			bench_report(name, (unsigned long long)size * loops,
+				     ns, cyc);
+		}
+	}
+	free(buf);
+}
+
+int main(int argc, char **argv)
+{
+	unsigned long size = 1 << 20;
+	int opt, loops = 16, rounds = 100000, do_bench = 0, fail;
+
+	while ((opt = getopt(argc, argv, "bs:l:n:")) != -1) {
+		switch (opt) {
+		case 'b':
+			do_bench = 1;
+			break;
+		case 's':
+			size = strtoul(optarg, NULL, 0);
+			break;
+		case 'l':
+			loops = strtoul(optarg, NULL, 0);
+			break;
+		case 'n':
+			rounds = strtoul(optarg, NULL, 0);
+			break;
+		default:
+			fprintf(stderr, "Usage: %s [-n rounds] "
+				"[-b [-s size] [-l loops]]\n", *argv);
+			exit(EXIT_FAILURE);
+		}
+	}
+	if (do_bench) {
+		bench(size, loops);
+		return 0;
+	}
+
+	fail = check_equivalence(1, rounds);
+	fail += check_correction(1, rounds / 1000 + 1);
+	if (fail) {
+		printf(NAME ": %d failures\n", fail);
+		return 1;
+	}
+	printf(NAME ": all checks passed\n");
+	return 0;
+}
@@ -0,0 +1,584 @@
+/*
+ * NAND stack test and benchmark on the host board's simulated chip
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * Runs nand_base, nand_bbt, nand_util and the "nand" command against
+ * drivers/mtd/nand/nand_sim.c, built for the host board in test/board
+ * (see its config.h for the chip).  The checks write, read back and
+ * compare with and without the cache program, two-plane and cache read
+ * paths, with injected bit flips, bad blocks and program/erase
+ * failures.  With -b every step is timed instead and followed by the
+ * simulator's statistics, the flash time the real chip would need.
+ */
+
+#include <common.h>
+#include <command.h>
+#include <malloc.h>
+#include <nand.h>
+#include <environment.h>
+#include <jffs2/jffs2.h>
+
+extern int board_run(const char *fmt, ...);
+extern int env_init(void);
+extern void env_relocate(void);
+extern void make_a_file(char *yaffsName, char bval, int sizeOfFile);
+extern void cmd_yaffs_drop(void);
+extern int cmd_yaffs_checkpointed(void);
+
+/*
+ * From the start of the chip, across the factory bad block 3, and from
+ * an odd block with no bad ones, where writes are not split per block
+ */
+#define TEST_SIZE	(8 << 20)
+#define RW_BLOCK	5
+#define BENCH_SIZE	(32 << 20)
+/* Even and past bad block 3: nand_write() splits writes at bad blocks */
+#define BENCH_BLOCK	4
+
+/* One file or volume on each filesystem, see MTDPARTS_DEFAULT */
+#define FS_SIZE		(1 << 20)
+#define JFFS2_OFFSET	(2 << 20)
+#define JFFS2_CHUNK	4096
+
+/* In the "env" partition, away from the environment itself */
+#define MARKBAD_BLOCK	10
+#define FAIL_BLOCK	12
+
+#define FAST_PATHS	(NAND_CACHEPRG | NAND_MULTIPLANE | NAND_CACHERD)
+
+static nand_info_t *nand;
+static struct nand_chip *chip;
+static unsigned int chip_options;
+static u_char *wbuf, *rbuf;
+static unsigned int seed = 1;
+static int fails;
+
+#define check(cond, fmt, args...) do {					\
+		if (!(cond)) {						\
+			printf("  FAIL %s:%d: " fmt "\n", __func__,	\
+			       __LINE__, ##args);			\
+			fails++;					\
+		}							\
+	} while (0)
+
+static void fill(u_char *buf, size_t len)
+{
+	while (len--) {
+		seed = seed * 1103515245 + 12345;
+		*buf++ = seed >> 16;
+	}
+}
+
+static int nand_cmd_erase(loff_t off, size_t len)
+{
+	return board_run("nand erase %llx %zx", (unsigned long long)off, len);
+}
+
+/* "nand" read/write command with the buffer address filled in */
+static int nand_cmd(const char *op, u_char *buf, loff_t off, size_t len)
+{
+	return board_run("nand %s %lx %llx %zx", op, (ulong)buf,
+			 (unsigned long long)off, len);
+}
+
+/* Cache program, two-plane program and cache read as in 'mask' */
+static void set_fast_paths(unsigned int mask)
+{
+	chip->options &= ~FAST_PATHS;
+	chip->options |= chip_options & mask;
+}
+
+static void check_scan(void)
+{
+	check(nand->size == 256 << 20, "size %llx", (unsigned long long)nand->size);
+	check(nand->writesize == 2048 && nand->oobsize == 64 &&
+	      nand->erasesize == 128 << 10, "geometry %u/%u/%u",
+	      nand->writesize, nand->oobsize, nand->erasesize);
+	check((chip_options & FAST_PATHS) == FAST_PATHS, "options %x",
+	      chip_options);
+	check(!nand_block_isbad(nand, 0), "block 0 bad");
+	check(nand_block_isbad(nand, 3 * nand->erasesize), "block 3 good");
+	check(nand_block_isbad(nand, 1000 * nand->erasesize),
+	      "block 1000 good");
+}
+
+/* Write at 'off' and read back, with the fast paths in 'wfast', 'rfast' */
+static void check_rw(loff_t off, unsigned int wfast, unsigned int rfast)
+{
+	size_t len;
+	int ret;
+
+	ret = nand_cmd_erase(off, TEST_SIZE + 2 * nand->erasesize);
+	check(ret == 0, "erase: %d", ret);
+
+	fill(wbuf, TEST_SIZE);
+	set_fast_paths(wfast);
+	ret = nand_cmd("write", wbuf, off, TEST_SIZE);
+	check(ret == 0, "write: %d", ret);
+	check(!chip->cacheprg, "cache program sequence left open");
+
+	set_fast_paths(rfast);
+	memset(rbuf, 0, TEST_SIZE);
+	ret = nand_cmd("read", rbuf, off, TEST_SIZE);
+	check(ret == 0, "read: %d", ret);
+	check(!memcmp(wbuf, rbuf, TEST_SIZE), "at %llx, write %x, read %x: "
+	      "differs", (unsigned long long)off, wfast, rfast);
+
+	/* unaligned, partial pages, through the MTD interface */
+	len = 10000;
+	memset(rbuf, 0, len);
+	ret = nand_read(nand, off + 5000, &len, rbuf);
+	check(ret == 0 && len == 10000, "read at 5000: %d", ret);
+	check(!memcmp(wbuf + 5000, rbuf, 10000), "read at 5000: differs");
+
+	set_fast_paths(FAST_PATHS);
+}
+
+/*
+ * A short read leaves its page in the page buffer. A cache read of the
+ * whole block which starts below it must still read that page from the
+ * chip: the chip has it in its data register already, and serving it
+ * from the buffer leaves every later page one behind.
+ */
+static void check_pagebuf(loff_t off)
+{
+	nand_ecc_modes_t mode = chip->ecc.mode;
+	int page = 3;
+	int ret;
+
+	/* no subpage reads, as with the e2440's hardware ECC */
+	chip->ecc.mode = NAND_ECC_HW;
+	set_fast_paths(FAST_PATHS);
+	ret = nand_cmd("read", rbuf, off + page * nand->writesize, 0x40);
+	check(ret == 0 && !memcmp(wbuf + page * nand->writesize, rbuf, 0x40),
+	      "short read: %d", ret);
+	check(chip->pagebuf == (int)(off >> chip->page_shift) + page,
+	      "page %d not in the page buffer", page);
+
+	memset(rbuf, 0, nand->erasesize);
+	ret = nand_cmd("read", rbuf, off, nand->erasesize);
+	check(ret == 0, "block read: %d", ret);
+	check(!memcmp(wbuf, rbuf, nand->erasesize), "block read differs");
+	chip->ecc.mode = mode;
+}
+
+/* Reads with injected bit flips must be corrected by the ECC */
+static void check_bitflips(void)
+{
+	unsigned int corrected = nand->ecc_stats.corrected;
+	int ret;
+
+	board_run("nandsim bitflip 3");
+	memset(rbuf, 0, TEST_SIZE);
+	ret = nand_cmd("read", rbuf, 0, TEST_SIZE);
+	board_run("nandsim bitflip 0");
+
+	check(ret == 0, "read: %d", ret);
+	check(!memcmp(wbuf, rbuf, TEST_SIZE), "differs");
+	check(nand->ecc_stats.corrected > corrected, "nothing corrected");
+}
+
+/* Writes skip a block marked bad; program and erase failures show */
+static void check_bad_blocks(void)
+{
+	loff_t bad = MARKBAD_BLOCK * nand->erasesize;
+	loff_t failing = FAIL_BLOCK * nand->erasesize;
+	size_t len = 3 * nand->erasesize;
+	int ret;
+
+	ret = board_run("nand markbad %llx", (unsigned long long)bad);
+	check(ret == 0 && nand_block_isbad(nand, bad), "markbad: %d", ret);
+
+	ret = nand_cmd_erase(bad - nand->erasesize, 4 * nand->erasesize);
+	check(ret == 0, "erase: %d", ret);
+	fill(wbuf, len);
+	ret = nand_cmd("write", wbuf, bad - nand->erasesize, len);
+	check(ret == 0, "write across bad block: %d", ret);
+	memset(rbuf, 0, len);
+	ret = nand_cmd("read", rbuf, bad - nand->erasesize, len);
+	check(ret == 0 && !memcmp(wbuf, rbuf, len),
+	      "read across bad block: %d", ret);
+
+	board_run("nandsim fail %llx", (unsigned long long)failing);
+	ret = nand_write(nand, failing, &len, wbuf);
+	check(ret != 0, "program failure not reported");
+	ret = nand_erase(nand, failing, nand->erasesize);
+	check(ret != 0, "erase failure not reported");
+}
+
+/* Saved, then read back as after a reset */
+static int env_save_load(int arg)
+{
+	char val[16];
+	char *s;
+
+	sprintf(val, "%x", arg);
+	setenv("nandtest", val);
+	if (board_run("saveenv"))
+		return 1;
+	setenv("nandtest", NULL);
+
+	env_init();
+	env_relocate();
+	s = getenv("nandtest");
+	return !s || strcmp(s, val);
+}
+
+static void check_env(void)
+{
+	check(env_save_load(0x1234) == 0, "not saved");
+	check(env_save_load(0x5678) == 0, "not saved twice");
+}
+
+static void jffs2_hdr(void *node, u16 type, size_t len)
+{
+	struct jffs2_unknown_node *hdr = node;
+
+	hdr->magic = JFFS2_MAGIC_BITMASK;
+	hdr->nodetype = type;
+	hdr->totlen = len;
+	hdr->hdr_crc = crc32_no_comp(0, node, sizeof(*hdr) - 4);
+}
+
+/*
+ * A JFFS2 image with a single uncompressed file "/nandtest" holding
+ * 'len' bytes of 'data', one node per page, none across an erase block
+ */
+static size_t jffs2_image(u_char *img, const u_char *data, size_t len)
+{
+	struct {
+		struct jffs2_raw_inode ri;
+		u_char data[JFFS2_CHUNK];
+	} inode;
+	struct {
+		struct jffs2_raw_dirent rd;
+		char name[8];
+	} dirent;
+	u_char *p = img;
+	size_t off, n;
+
+	memset(img, 0xff, len + len / 16 + nand->erasesize);
+	memset(&dirent, 0, sizeof(dirent));
+	jffs2_hdr(&dirent, JFFS2_NODETYPE_DIRENT, sizeof(dirent));
+	dirent.rd.pino = 1;
+	dirent.rd.version = 1;
+	dirent.rd.ino = 2;
+	dirent.rd.nsize = 8;
+	dirent.rd.type = DT_REG;
+	memcpy(dirent.name, "nandtest", 8);
+	dirent.rd.node_crc = crc32_no_comp(0, (u_char *)&dirent.rd,
+					   sizeof(dirent.rd) - 8);
+	dirent.rd.name_crc = crc32_no_comp(0, (u_char *)dirent.name, 8);
+	memcpy(p, &dirent, sizeof(dirent));
+	p += sizeof(dirent);
+
+	for (off = 0; off < len; off += n) {
+		n = min(len - off, JFFS2_CHUNK);
+		if ((p - img) / nand->erasesize !=
+		    (p - img + sizeof(inode.ri) + n - 1) / nand->erasesize)
+			p = img + roundup(p - img, nand->erasesize);
+
+		memset(&inode.ri, 0, sizeof(inode.ri));
+		jffs2_hdr(&inode, JFFS2_NODETYPE_INODE, sizeof(inode.ri) + n);
+		inode.ri.ino = 2;
+		inode.ri.version = off / JFFS2_CHUNK + 1;
+		inode.ri.mode = 0100644;
+		inode.ri.isize = len;
+		inode.ri.offset = off;
+		inode.ri.csize = n;
+		inode.ri.dsize = n;
+		inode.ri.compr = JFFS2_COMPR_NONE;
+		memcpy(inode.data, data + off, n);
+		inode.ri.data_crc = crc32_no_comp(0, inode.data, n);
+		inode.ri.node_crc = crc32_no_comp(0, (u_char *)&inode.ri,
+						  sizeof(inode.ri) - 8);
+		memcpy(p, &inode, sizeof(inode.ri) + n);
+		p += ALIGN(sizeof(inode.ri) + n, 4);
+	}
+
+	return roundup(p - img, nand->erasesize);
+}
+
+static int jffs2_store(void)
+{
+	size_t len;
+
+	fill(wbuf, FS_SIZE);
+	len = jffs2_image(rbuf, wbuf, FS_SIZE);
+	if (nand_cmd_erase(JFFS2_OFFSET, 64 << 20))
+		return 1;
+	return nand_cmd("write", rbuf, JFFS2_OFFSET, len);
+}
+
+static int jffs2_load(int arg)
+{
+	char *s;
+
+	memset(rbuf, 0, FS_SIZE);
+	if (board_run("chpart nand0,1") ||
+	    board_run("fsload %lx /nandtest", (ulong)rbuf))
+		return 1;
+	s = getenv("filesize");
+	return !s || simple_strtoul(s, NULL, 16) != FS_SIZE;
+}
+
+static void check_jffs2(void)
+{
+	int ret;
+
+	ret = jffs2_store();
+	check(ret == 0, "image not written: %d", ret);
+	ret = jffs2_load(0);
+	check(ret == 0, "fsload: %d", ret);
+	check(!memcmp(wbuf, rbuf, FS_SIZE), "differs");
+}
+
+static int ubi_write(int arg)
+{
+	return board_run("ubi write %lx nandtest %x", (ulong)wbuf, FS_SIZE);
+}
+
+static int ubi_read(int arg)
+{
+	memset(rbuf, 0, FS_SIZE);
+	return board_run("ubi read %lx nandtest %x", (ulong)rbuf, FS_SIZE);
+}
+
+static int ubi_attach(void)
+{
+	if (nand_cmd_erase(66 << 20, 64 << 20) || board_run("ubi part ubi"))
+		return 1;
+	return board_run("ubi create nandtest %x", FS_SIZE);
+}
+
+static void check_ubi(void)
+{
+	int ret;
+
+	ret = ubi_attach();
+	check(ret == 0, "attach: %d", ret);
+	fill(wbuf, FS_SIZE);
+	ret = ubi_write(0);
+	check(ret == 0, "write: %d", ret);
+	ret = ubi_read(0);
+	check(ret == 0, "read: %d", ret);
+	check(!memcmp(wbuf, rbuf, FS_SIZE), "differs");
+}
+
+/*
+ * fs/yaffs2/yaffscfg.c puts /flash on the whole chip, so this has to
+ * come last and starts from an erased chip.
+ */
+static int yaffs_write(int arg)
+{
+	return board_run("ywrm /flash/nandtest %lx %x", (ulong)wbuf, FS_SIZE);
+}
+
+static int yaffs_read(int arg)
+{
+	memset(rbuf, 0, FS_SIZE);
+	return board_run("yrdm /flash/nandtest %lx", (ulong)rbuf);
+}
+
+static int yaffs_mount(int arg)
+{
+	return board_run("ymount /flash");
+}
+
+static int yaffs_remount(int arg)
+{
+	return board_run("yumount /flash") || board_run("ymount /flash");
+}
+
+static void check_yaffs2(void)
+{
+	int ret, i;
+
+	ret = board_run("nand erase");
+	check(ret == 0, "erase: %d", ret);
+	ret = yaffs_mount(0);
+	check(ret == 0, "mount: %d", ret);
+	fill(wbuf, FS_SIZE);
+	ret = yaffs_write(0);
+	check(ret == 0, "write: %d", ret);
+	check(cmd_yaffs_checkpointed(), "no checkpoint after write");
+
+	/* reset without unmounting: the checkpoint left by ywrm is used */
+	cmd_yaffs_drop();
+	ret = yaffs_mount(0);
+	check(ret == 0, "mount after reset: %d", ret);
+	check(cmd_yaffs_checkpointed(), "mount after reset did a full scan");
+	ret = yaffs_read(0);
+	check(ret == 0, "read after reset: %d", ret);
+	check(!memcmp(wbuf, rbuf, FS_SIZE), "differs after reset");
+
+	ret = yaffs_remount(0);
+	check(ret == 0, "remount: %d", ret);
+	check(cmd_yaffs_checkpointed(), "remount did not use the checkpoint");
+	ret = yaffs_read(0);
+	check(ret == 0, "read: %d", ret);
+	check(!memcmp(wbuf, rbuf, FS_SIZE), "differs");
+
+	/*
+	 * A change which left no checkpoint, then a reset: the mount scans
+	 * the tags of every chunk, a block at a time (yaffs_mtdif2.c).
+	 * FAIL_BLOCK still fails to erase: yaffs finds it not erased when
+	 * it allocates from there and moves on.
+	 */
+	make_a_file("/flash/nandtest2", 0x5a, FS_SIZE / 2);
+	check(!cmd_yaffs_checkpointed(), "checkpoint still valid");
+	cmd_yaffs_drop();
+	ret = yaffs_mount(0);
+	check(ret == 0, "mount after reset: %d", ret);
+	check(!cmd_yaffs_checkpointed(), "mount used a stale checkpoint");
+	ret = yaffs_read(0);
+	check(ret == 0, "read after scan: %d", ret);
+	check(!memcmp(wbuf, rbuf, FS_SIZE), "differs after scan");
+	memset(rbuf, 0, FS_SIZE);
+	ret = board_run("yrdm /flash/nandtest2 %lx", (ulong)rbuf);
+	check(ret == 0, "read of the second file: %d", ret);
+	for (i = 0; i < FS_SIZE / 2 && rbuf[i] == 0x5a; i++)
+		;
+	check(i == FS_SIZE / 2 && rbuf[i] == 0,
+	      "second file differs at %d", i);
+}
+
+/* -b: time one step, then show what it cost on the chip */
+static void bench_step(const char *name, int (*fn)(int), int arg)
+{
+	unsigned long long t;
+	int ret;
+
+	board_run("nandsim reset");
+	t = get_ticks();
+	ret = fn(arg);
+	t = get_ticks() - t;
+	printf("%s%s: %llu ms on the host\n", name, ret ? " FAILED" : "",
+	       t / (get_tbclk() / 1000));
+	board_run("nandsim info");
+}
+
+static int bench_erase(int arg)
+{
+	return nand_cmd_erase(BENCH_BLOCK * nand->erasesize,
+			      BENCH_SIZE + 2 * nand->erasesize);
+}
+
+static int bench_write(int fast)
+{
+	set_fast_paths(fast);
+	return nand_cmd("write", wbuf, BENCH_BLOCK * nand->erasesize,
+			BENCH_SIZE);
+}
+
+static int bench_read(int fast)
+{
+	set_fast_paths(fast);
+	return nand_cmd("read", rbuf, BENCH_BLOCK * nand->erasesize,
+			BENCH_SIZE);
+}
+
+static void bench(void)
+{
+	fill(wbuf, BENCH_SIZE);
+
+	bench_step("erase 32 MiB", bench_erase, 0);
+	bench_step("write 32 MiB, page by page", bench_write, 0);
+	bench_step("read 32 MiB, page by page", bench_read, 0);
+	bench_step("read 32 MiB, cache read", bench_read, NAND_CACHERD);
+	bench_erase(0);
+	bench_step("write 32 MiB, cache program", bench_write, NAND_CACHEPRG);
+	bench_erase(0);
+	bench_step("write 32 MiB, two-plane", bench_write, NAND_MULTIPLANE);
+	bench_erase(0);
+	bench_step("write 32 MiB, both", bench_write, FAST_PATHS);
+	set_fast_paths(FAST_PATHS);
+
+	bench_step("saveenv and reload", env_save_load, 1);
+	jffs2_store();
+	bench_step("JFFS2 scan and load 1 MiB", jffs2_load, 0);
+	ubi_attach();
+	fill(wbuf, FS_SIZE);
+	bench_step("UBI write 1 MiB", ubi_write, 0);
+	bench_step("UBI read 1 MiB", ubi_read, 0);
+	board_run("nand erase");
+	bench_step("YAFFS2 mount erased chip", yaffs_mount, 0);
+	bench_step("YAFFS2 write 1 MiB", yaffs_write, 0);
+	bench_step("YAFFS2 remount from checkpoint", yaffs_remount, 0);
+	bench_step("YAFFS2 read 1 MiB", yaffs_read, 0);
+}
+
+int main(int argc, char **argv)
+{
+	int do_bench = argc > 1 && !strcmp(argv[1], "-b");
+	loff_t rw;
+
+	env_init();
+	puts("NAND:  ");
+	nand_init();
+	env_relocate();
+	board_run("mtdparts default");
+	nand = &nand_info[0];
+	chip = nand->priv;
+	chip_options = chip->options;
+	if (!nand->size) {
+		puts("nand_test: no NAND device\n");
+		return 1;
+	}
+
+	wbuf = malloc(BENCH_SIZE);
+	rbuf = malloc(BENCH_SIZE);
+	if (!wbuf || !rbuf) {
+		puts("nand_test: out of memory\n");
+		return 1;
+	}
+
+	if (do_bench) {
+		bench();
+		return 0;
+	}
+
+	check_scan();
+	rw = RW_BLOCK * nand->erasesize;
+	check_rw(rw, FAST_PATHS, FAST_PATHS);
+	check_rw(rw, NAND_CACHEPRG, 0);
+	check_rw(rw, NAND_MULTIPLANE, NAND_CACHERD);
+	check_rw(rw, 0, FAST_PATHS);
+	check_rw(rw, FAST_PATHS, 0);
+	check_rw(rw, 0, 0);
+	/* the bit flip check reads this one again */
+	check_rw(0, FAST_PATHS, FAST_PATHS);
+	check_pagebuf(0);
+	check_bitflips();
+	check_bad_blocks();
+	check_env();
+	check_jffs2();
+	check_ubi();
+	check_yaffs2();
+
+	if (fails) {
+		printf("nand_test: %d failures\n", fails);
+		return 1;
+	}
+	puts("nand_test: all checks passed\n");
+	return 0;
+}
@@ -0,0 +1,407 @@
+/*
+ * Sparse image writer test and benchmark
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * The images are made by tools/mksparse, linked in as mksparse_main(),
+ * from raw data with random, erased, filled and zero blocks, once as
+ * for NAND (-e 0xff) and once as for MMC.  common/sparse.c, built for
+ * the test board, writes them to a RAM "flash", which must then hold
+ * the raw data.  Every truncation of the image and chunk headers whose
+ * sizes point past its end or overflow 32 bits must be rejected before
+ * anything is written.  The image always ends just before an
+ * inaccessible page, so that reading past it crashes the test.  With
+ * -b a large, mostly empty image is timed.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "bench.h"
+
+/* The backend interface is hidden from host tools */
+#undef USE_HOSTCC
+#include <sparse_format.h>
+
+#define RAW_BLKS	40
+#define RAW_TAIL	300		/* bytes in the last, partial block */
+#define BENCH_SIZE	(32 << 20)
+
+extern int mksparse_main(int argc, char **argv);
+
+static int fails;
+
+#define check(cond, fmt, args...) do {					\
+		if (!(cond)) {						\
+			printf("  FAIL %s:%d: " fmt "\n", __func__,	\
+			       __LINE__, ##args);			\
+			fails++;					\
+		}							\
+	} while (0)
+
+/* RAM flash; skip() leaves what was there */
+struct ram_flash {
+	unsigned char *buf;
+	unsigned long pos;
+	int calls;
+};
+
+static int ram_write(struct sparse_storage *info, const void *buf, ulong len)
+{
+	struct ram_flash *rf = info->priv;
+
+	memcpy(rf->buf + rf->pos, buf, len);
+	rf->pos += len;
+	rf->calls++;
+	return 0;
+}
+
+static int ram_skip(struct sparse_storage *info, ulong len)
+{
+	struct ram_flash *rf = info->priv;
+
+	rf->pos += len;
+	rf->calls++;
+	return 0;
+}
+
+static void ram_init(struct sparse_storage *info, struct ram_flash *rf,
+		     unsigned char *buf, size_t size, int fill_erased)
+{
+	memset(rf, 0, sizeof(*rf));
+	rf->buf = buf;
+	memset(info, 0, sizeof(*info));
+	info->priv = rf;
+	info->size = size;
+	info->align = 512;
+	info->fill_erased = fill_erased;
+	info->write = ram_write;
+	info->skip = ram_skip;
+}
+
+/* Blocks of every kind mksparse knows, in runs and alone */
+static void fill_raw(unsigned char *buf, size_t blk_sz, unsigned int seed)
+{
+	static const char kind[RAW_BLKS + 1] =
+		"rrrEEEff0rErrrrfffEE00rEEEEEEEErrffrf0rE";
+	uint32_t word;
+	size_t i, j;
+
+	for (i = 0; i < RAW_BLKS; i++) {
+		unsigned char *b = buf + i * blk_sz;
+
+		switch (kind[i]) {
+		case 'r':
+			bench_fill(b, blk_sz, &seed);
+			break;
+		case 'E':
+			memset(b, 0xff, blk_sz);
+			break;
+		case 'f':
+			word = 0x12345678 + (i & 1);
+			for (j = 0; j < blk_sz; j += sizeof(word))
+				memcpy(b + j, &word, sizeof(word));
+			break;
+		default:
+			memset(b, 0, blk_sz);
+			break;
+		}
+	}
+	bench_fill(buf + RAW_BLKS * blk_sz, RAW_TAIL, &seed);
+}
+
+/* A copy of len bytes which ends just before an inaccessible page */
+static unsigned char *guarded_copy(const void *data, size_t len)
+{
+	long page = sysconf(_SC_PAGESIZE);
+	size_t size = (len + page - 1) / page * page;
+	unsigned char *map;
+
+	map = mmap(NULL, size + page, PROT_READ | PROT_WRITE,
+		   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (map == MAP_FAILED || mprotect(map + size, page, PROT_NONE)) {
+		perror("sparse_test");
+		exit(EXIT_FAILURE);
+	}
+	return memcpy(map + size - len, data, len);
+}
+
+static void guarded_free(unsigned char *p, size_t len)
+{
+	long page = sysconf(_SC_PAGESIZE);
+	size_t size = (len + page - 1) / page * page;
+
+	munmap(p + len - size, size + page);
+}
+
+/* Run mksparse on len bytes of raw data, return a guarded image */
+static unsigned char *mksparse(const unsigned char *raw, size_t len,
+			       const char *opts, size_t *img_len)
+{
+	char in[] = "/tmp/sparse_testXXXXXX";
+	char out[] = "/tmp/sparse_testXXXXXX";
+	char args[64], *argv[12], *p;
+	unsigned char *buf, *img;
+	struct stat st;
+	int argc = 0, fd, ofd;
+
+	fd = mkstemp(in);
+	ofd = mkstemp(out);
+	if (fd < 0 || ofd < 0 || write(fd, raw, len) != len) {
+		perror("sparse_test");
+		exit(EXIT_FAILURE);
+	}
+	close(fd);
+
+	snprintf(args, sizeof(args), "mksparse -q %s", opts);
+	for (p = strtok(args, " "); p; p = strtok(NULL, " "))
+		argv[argc++] = p;
+	argv[argc++] = in;
+	argv[argc++] = out;
+	argv[argc] = NULL;
+	optind = 1;
+	if (mksparse_main(argc, argv) != 0 || fstat(ofd, &st)) {
+		fprintf(stderr, "sparse_test: mksparse %s failed\n", opts);
+		exit(EXIT_FAILURE);
+	}
+	unlink(in);
+	unlink(out);
+
+	buf = malloc(st.st_size);
+	if (!buf || pread(ofd, buf, st.st_size, 0) != st.st_size) {
+		perror("sparse_test");
+		exit(EXIT_FAILURE);
+	}
+	close(ofd);
+	img = guarded_copy(buf, st.st_size);
+	free(buf);
+	*img_len = st.st_size;
+	return img;
+}
+
+/* Hide flash_sparse()'s complaints about the broken images */
+static int stdout_fd = -1;
+
+static void quiet(int on)
+{
+	fflush(stdout);
+	if (on) {
+		int null = open("/dev/null", O_WRONLY);
+
+		stdout_fd = dup(1);
+		dup2(null, 1);
+		close(null);
+	} else {
+		dup2(stdout_fd, 1);
+		close(stdout_fd);
+	}
+}
+
+static void put_le32(unsigned char *p, uint32_t v)
+{
+	p[0] = v;
+	p[1] = v >> 8;
+	p[2] = v >> 16;
+	p[3] = v >> 24;
+}
+
+/* The chunk header of the first chunk of the given type */
+static unsigned char *find_chunk(unsigned char *img, uint16_t type)
+{
+	struct sparse_header *hdr = (struct sparse_header *)img;
+	unsigned char *p = img + hdr->file_hdr_sz;
+	uint32_t i;
+
+	for (i = 0; i < hdr->total_chunks; i++) {
+		struct sparse_chunk *c = (struct sparse_chunk *)p;
+
+		if (c->chunk_type == type)
+			return p;
+		p += c->total_sz;
+	}
+	return NULL;
+}
+
+/* Write a copy of img with one 32 bit field changed, which must fail */
+static void check_broken(const unsigned char *img, size_t len,
+			 size_t field, uint32_t val, const char *what)
+{
+	size_t flash_len = (RAW_BLKS + 1) * 2048;
+	unsigned char *copy = guarded_copy(img, len);
+	unsigned char *flash = malloc(flash_len);
+	struct sparse_storage info;
+	struct ram_flash rf;
+	int ret;
+
+	put_le32(copy + field, val);
+	ram_init(&info, &rf, flash, flash_len, 1);
+	quiet(1);
+	ret = flash_sparse(&info, copy, len);
+	quiet(0);
+	check(ret != 0 && rf.calls == 0, "%s: %d, %d backend calls", what,
+	      ret, rf.calls);
+
+	guarded_free(copy, len);
+	free(flash);
+}
+
+static void check_image(const char *opts, size_t blk_sz, int fill_erased,
+			int old)
+{
+	size_t raw_len = RAW_BLKS * blk_sz + RAW_TAIL;
+	size_t flash_len = (RAW_BLKS + 1) * blk_sz;
+	unsigned char *raw = malloc(flash_len);
+	unsigned char *flash = malloc(flash_len);
+	struct sparse_storage info;
+	struct ram_flash rf;
+	unsigned char *img;
+	size_t len, i, bad = 0;
+	int ret;
+
+	fill_raw(raw, blk_sz, 1);
+	img = mksparse(raw, raw_len, opts, &len);
+	/* mksparse pads the last block with the erased byte or zeros */
+	memset(raw + raw_len, fill_erased ? 0xff : 0, flash_len - raw_len);
+
+	memset(flash, old, flash_len);
+	ram_init(&info, &rf, flash, flash_len, fill_erased);
+	quiet(1);
+	ret = flash_sparse(&info, img, len);
+	quiet(0);
+	check(ret == 0, "%s: write failed: %d", opts, ret);
+	check(rf.pos == flash_len, "%s: %lu of %zu bytes", opts, rf.pos,
+	      flash_len);
+	check(!memcmp(raw, flash, flash_len), "%s: flash differs", opts);
+
+	/* any shorter length: rejected, nothing written */
+	quiet(1);
+	for (i = 0; i < len; i++) {
+		ram_init(&info, &rf, flash, flash_len, fill_erased);
+		ret = flash_sparse(&info, img, i);
+		if ((ret == 0 || rf.calls) && !bad)
+			bad = i + 1;
+	}
+	quiet(0);
+	check(!bad, "%s: %zu of %zu bytes accepted", opts, bad - 1, len);
+
+	guarded_free(img, len);
+	free(raw);
+	free(flash);
+}
+
+/* Chunk headers whose sizes don't add up, with the NAND image */
+static void check_headers(void)
+{
+	size_t blk_sz = 2048, raw_len = RAW_BLKS * blk_sz + RAW_TAIL;
+	unsigned char *raw = malloc(raw_len);
+	unsigned char *img, *c;
+	size_t len;
+
+	fill_raw(raw, blk_sz, 2);
+	img = mksparse(raw, raw_len, "-b 2048 -e 0xff", &len);
+
+	/* one chunk more than there are */
+	check_broken(img, len, offsetof(struct sparse_header, total_chunks),
+		     ((struct sparse_header *)img)->total_chunks + 1,
+		     "extra chunk");
+
+	/*
+	 * 2^21 blocks of 2 KiB are 4 GiB, 0 in 32 bits: the total size a
+	 * chunk with no data has would match.
+	 */
+	c = find_chunk(img, SPARSE_CHUNK_RAW);
+	check_broken(img, len, c - img + offsetof(struct sparse_chunk,
+						   chunk_sz),
+		     1 << 21, "4 GiB raw chunk");
+	check_broken(img, len, c - img + offsetof(struct sparse_chunk,
+						   total_sz),
+		     0xffffffff, "raw chunk past the end");
+
+	c = find_chunk(img, SPARSE_CHUNK_DONT_CARE);
+	check_broken(img, len, c - img + offsetof(struct sparse_chunk,
+						   chunk_sz),
+		     0xffffffff, "2^32 - 1 blocks don't care");
+
+	c = find_chunk(img, SPARSE_CHUNK_FILL);
+	check_broken(img, len, c - img + offsetof(struct sparse_chunk,
+						   total_sz),
+		     0xfffffff0, "fill chunk past the end");
+
+	guarded_free(img, len);
+	free(raw);
+}
+
+/* 1/8 random data, the rest erased: a typical filesystem image */
+static void bench(void)
+{
+	unsigned char *raw = malloc(BENCH_SIZE), *flash = malloc(BENCH_SIZE);
+	struct sparse_storage info;
+	struct ram_flash rf;
+	unsigned long long t, c;
+	unsigned char *img;
+	unsigned int seed = 1;
+	size_t len, i;
+
+	memset(raw, 0xff, BENCH_SIZE);
+	for (i = 0; i < BENCH_SIZE; i += 64 << 10)
+		bench_fill(raw + i, 8 << 10, &seed);
+	img = mksparse(raw, BENCH_SIZE, "-b 4096 -e 0xff", &len);
+
+	ram_init(&info, &rf, flash, BENCH_SIZE, 1);
+	quiet(1);
+	t = bench_ns();
+	c = bench_cycles();
+	flash_sparse(&info, img, len);
+	c = bench_cycles() - c;
+	t = bench_ns() - t;
+	quiet(0);
+	guarded_free(img, len);
+
+	printf("%u MiB image, %zu bytes sparse:\n", BENCH_SIZE >> 20, len);
+	bench_report("flash_sparse to RAM", BENCH_SIZE, t, c);
+}
+
+int main(int argc, char **argv)
+{
+	if (argc > 1 && !strcmp(argv[1], "-b")) {
+		bench();
+		return 0;
+	}
+
+	/* NAND: erased blocks are skipped; MMC: every block is written */
+	check_image("-b 2048 -e 0xff", 2048, 1, 0xff);
+	check_image("-b 512", 512, 0, 0xa5);
+	check_headers();
+
+	if (fails) {
+		printf("sparse_test: %d failures\n", fails);
+		return 1;
+	}
+	printf("sparse_test: all checks passed\n");
+	return 0;
+}
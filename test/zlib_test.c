@@ -0,0 +1,383 @@
+/*
+ * Host test and benchmark for the lib_generic inflate code
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+/*
+ * The reference streams are produced by the host's gzip(1). Each one is
+ * inflated the way zunzip() does it (raw deflate, one Z_FINISH call
+ * into the whole destination) and again through a small output buffer,
+ * which goes through the sliding window, and compared with the input.
+ * The one call must not allocate a window at all.
+ *
+ * zlib_test_bytecopy is the same program without CONFIG_ZLIB_WORD_COPY.
+ * With -b -f file both time the inflate of that file, so that the word
+ * copies can be compared on a real image.
+ */
+
+#include <common.h>
+#include <unistd.h>
+#include <u-boot/zlib.h>
+#include "bench.h"
+
+#define DATA_SIZE	(2 << 20)
+
+struct sample {
+	const char *name;
+	void (*fill)(unsigned char *buf, size_t len, unsigned int seed);
+};
+
+/* Incompressible: inflate is mostly stored blocks */
+static void fill_random(unsigned char *buf, size_t len, unsigned int seed)
+{
+	bench_fill(buf, len, &seed);
+}
+
+/* Words from a small dictionary: many medium distance matches */
+static void fill_text(unsigned char *buf, size_t len, unsigned int seed)
+{
+	static const char *words[] = {
+		"nand ", "erase ", "bootm ", "0x30008000 ", "setenv ",
+		"bootargs ", "console=ttySAC0,115200 ", "root=/dev/mtdblock3 ",
+		"\n", "tftp ", "uImage ", "saveenv ", "ubi ", "part ",
+	};
+	size_t n;
+	const char *w;
+
+	while (len) {
+		w = words[bench_rand(&seed) % ARRAY_SIZE(words)];
+		n = strlen(w);
+		if (n > len)
+			n = len;
+		memcpy(buf, w, n);
+		buf += n;
+		len -= n;
+	}
+}
+
+/*
+ * Machine code like: runs of zeros and short periodic patterns, which
+ * give the 1, 2, 3 and 4 byte distance matches the word copy handles.
+ */
+static void fill_mixed(unsigned char *buf, size_t len, unsigned int seed)
+{
+	size_t run, i;
+	unsigned int period;
+
+	while (len) {
+		run = 16 + bench_rand(&seed) % 512;
+		if (run > len)
+			run = len;
+		switch (bench_rand(&seed) % 4) {
+		case 0:
+			memset(buf, 0, run);
+			break;
+		case 1:
+			period = 1 + bench_rand(&seed) % 8;
+			bench_fill(buf, period, &seed);
+			for (i = period; i < run; i++)
+				buf[i] = buf[i - period];
+			break;
+		case 2:
+			bench_fill(buf, run, &seed);
+			break;
+		default:
+			for (i = 0; i < run; i++)
+				buf[i] = (i & 3) ? 0 : bench_rand(&seed);
+			break;
+		}
+		buf += run;
+		len -= run;
+	}
+}
+
+static const struct sample samples[] = {
+	{ "random", fill_random },
+	{ "text", fill_text },
+	{ "mixed", fill_mixed },
+};
+
+/* inflate_state, and the sliding window if the stream needs one */
+static int allocs;
+
+static void *zalloc(void *x, unsigned items, unsigned size)
+{
+	allocs++;
+	return malloc(items * size);
+}
+
+static void zfree(void *x, void *addr, unsigned nb)
+{
+	free(addr);
+}
+
+/* gzip -9 -n the buffer, return the raw deflate stream */
+static unsigned char *gzip(const unsigned char *data, size_t len,
+			   size_t *zlen)
+{
+	char name[] = "/tmp/zlib_testXXXXXX";
+	char cmd[64];
+	unsigned char *z;
+	size_t size = len + len / 8 + 1024;
+	FILE *f;
+	int fd;
+
+	fd = mkstemp(name);
+	if (fd < 0 || write(fd, data, len) != len) {
+		perror(name);
+		exit(EXIT_FAILURE);
+	}
+	close(fd);
+
+	snprintf(cmd, sizeof(cmd), "gzip -9 -n -c %s", name);
+	f = popen(cmd, "r");
+	z = malloc(size);
+	if (!f || !z) {
+		perror("gzip");
+		exit(EXIT_FAILURE);
+	}
+	*zlen = fread(z, 1, size, f);
+	if (pclose(f) || *zlen <= 18) {
+		fprintf(stderr, "gzip failed\n");
+		exit(EXIT_FAILURE);
+	}
+	unlink(name);
+
+	/* -n: fixed 10 byte header, no name; 8 byte crc/size trailer */
+	*zlen -= 18;
+	memmove(z, z + 10, *zlen);
+	return z;
+}
+
+/* Inflate with out_chunk bytes of output per call, 0 for one Z_FINISH */
+static int inflate_buf(unsigned char *dst, size_t dstlen,
+		       unsigned char *src, size_t srclen, size_t out_chunk,
+		       size_t *outlen)
+{
+	z_stream s;
+	int r;
+
+	memset(&s, 0, sizeof(s));
+	allocs = 0;
+	s.zalloc = zalloc;
+	s.zfree = zfree;
+	s.outcb = Z_NULL;
+	r = inflateInit2(&s, -MAX_WBITS);
+	if (r != Z_OK)
+		return r;
+	s.next_in = src;
+	s.avail_in = srclen;
+	s.next_out = dst;
+
+	if (!out_chunk) {
+		s.avail_out = dstlen;
+		r = inflate(&s, Z_FINISH);
+	} else {
+		do {
+			s.avail_out = out_chunk;
+			if (s.avail_out > dstlen - (s.next_out - dst))
+				s.avail_out = dstlen - (s.next_out - dst);
+			r = inflate(&s, Z_NO_FLUSH);
+		} while (r == Z_OK && s.avail_out == 0 &&
+			 s.next_out < dst + dstlen);
+	}
+	*outlen = s.next_out - dst;
+	inflateEnd(&s);
+	return r;
+}
+
+static int check(void)
+{
+	static const size_t chunks[] = { 0, 1, 4093, 65536 };
+	unsigned char *data, *z, *out;
+	size_t zlen, outlen;
+	int i, c, r, fail = 0;
+
+	data = malloc(DATA_SIZE);
+	out = malloc(DATA_SIZE);
+	if (!data || !out) {
+		perror("malloc");
+		exit(EXIT_FAILURE);
+	}
+
+	for (i = 0; i < ARRAY_SIZE(samples); i++) {
+		samples[i].fill(data, DATA_SIZE, i + 1);
+		z = gzip(data, DATA_SIZE, &zlen);
+
+		for (c = 0; c < ARRAY_SIZE(chunks); c++) {
+			/* Byte at a time output is slow, keep it short */
+			size_t len = chunks[c] == 1 ? 65536 : DATA_SIZE;
+
+			memset(out, 0xa5, DATA_SIZE);
+			r = inflate_buf(out, len, z, zlen, chunks[c], &outlen);
+			if ((len == DATA_SIZE && r != Z_STREAM_END) ||
+			    outlen != len || memcmp(out, data, len)) {
+				printf("  %s, %lu byte chunks: returned %d, "
+				       "%lu bytes\n", samples[i].name,
+				       (unsigned long)chunks[c], r,
+				       (unsigned long)outlen);
+				fail++;
+			}
+			/* Output larger than the window keeps one */
+			if (allocs != (chunks[c] ? 2 : 1)) {
+				printf("  %s, %lu byte chunks: %d allocations\n",
+				       samples[i].name,
+				       (unsigned long)chunks[c], allocs);
+				fail++;
+			}
+		}
+
+		/* Destination too small must fail, not overrun */
+		memset(out, 0xa5, DATA_SIZE);
+		r = inflate_buf(out, DATA_SIZE / 2, z, zlen, 0, &outlen);
+		if (r == Z_STREAM_END || outlen != DATA_SIZE / 2 ||
+		    out[DATA_SIZE / 2] != 0xa5) {
+			printf("  %s: short destination returned %d\n",
+			       samples[i].name, r);
+			fail++;
+		}
+		free(z);
+	}
+	free(data);
+	free(out);
+	return fail;
+}
+
+static void bench_one(const char *name, unsigned char *data, size_t size,
+		      int loops)
+{
+	unsigned char *z, *out;
+	unsigned long long ns, cyc;
+	size_t zlen, outlen;
+	int l;
+
+	out = malloc(size);
+	if (!out) {
+		perror("malloc");
+		exit(EXIT_FAILURE);
+	}
+	z = gzip(data, size, &zlen);
+	inflate_buf(out, size, z, zlen, 0, &outlen);
+	if (outlen != size || memcmp(out, data, size)) {
+		fprintf(stderr, "%s: inflate failed\n", name);
+		exit(EXIT_FAILURE);
+	}
+
+	ns = bench_ns();
+	cyc = bench_cycles();
+	for (l = 0; l < loops; l++)
+		inflate_buf(out, size, z, zlen, 0, &outlen);
+	cyc = bench_cycles() - cyc;
+	ns = bench_ns() - ns;
+
+	bench_report(name, (unsigned long long)size * loops, ns, cyc);
+	free(z);
+	free(out);
+}
+
+static unsigned char *read_file(const char *name, size_t *size)
+{
+	unsigned char *buf;
+	FILE *f;
+	long len;
+
+	f = fopen(name, "rb");
+	if (!f || fseek(f, 0, SEEK_END) || (len = ftell(f)) <= 0) {
+		perror(name);
+		exit(EXIT_FAILURE);
+	}
+	rewind(f);
+	buf = malloc(len);
+	if (!buf || fread(buf, 1, len, f) != len) {
+		perror(name);
+		exit(EXIT_FAILURE);
+	}
+	fclose(f);
+	*size = len;
+	return buf;
+}
+
+static void bench(int loops, const char *file)
+{
+	unsigned char *data;
+	size_t size;
+	int i;
+
+	printf("zlib_test: inflate, word copies %s, %d loops\n",
+#ifdef CONFIG_ZLIB_WORD_COPY
+	       "on",
+#else
+	       "off",
+#endif
+	       loops);
+	if (file) {
+		data = read_file(file, &size);
+		bench_one(file, data, size, loops);
+		free(data);
+		return;
+	}
+
+	data = malloc(DATA_SIZE);
+	if (!data) {
+		perror("malloc");
+		exit(EXIT_FAILURE);
+	}
+	for (i = 0; i < ARRAY_SIZE(samples); i++) {
+		samples[i].fill(data, DATA_SIZE, i + 1);
+		bench_one(samples[i].name, data, DATA_SIZE, loops);
+	}
+	free(data);
+}
+
+int main(int argc, char **argv)
+{
+	const char *file = NULL;
+	int opt, loops = 16, do_bench = 0, fail;
+
+	while ((opt = getopt(argc, argv, "bf:l:")) != -1) {
+		switch (opt) {
+		case 'b':
+			do_bench = 1;
+			break;
+		case 'f':
+			file = optarg;
+			break;
+		case 'l':
+			loops = strtoul(optarg, NULL, 0);
+			break;
+		default:
+			fprintf(stderr, "Usage: %s [-b [-f file] [-l loops]]\n",
+				*argv);
+			exit(EXIT_FAILURE);
+		}
+	}
+	if (do_bench) {
+		bench(loops, file);
+		return 0;
+	}
+
+	fail = check();
+	if (fail) {
+		printf("zlib_test: %d failures\n", fail);
+		return 1;
+	}
+	printf("zlib_test: all checks passed\n");
+	return 0;
+}
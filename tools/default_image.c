@@ -104,10 +104,8 @@ static void image_set_header (void *ptr, struct stat *sbuf, int ifd,
 
 	image_header_t * hdr = (image_header_t *)ptr;
 
-	checksum = crc32 (0,
-			(const unsigned char *)(ptr +
-				sizeof(image_header_t)),
-			sbuf->st_size - sizeof(image_header_t));
+	/* the data crc is taken by the mkimage core while writing the data */
+	checksum = params->dcrc;
 
 	/* Build new header */
 	image_set_magic (hdr, IH_MAGIC);
@@ -29,6 +29,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 #include <sys/types.h>
 #include <sys/ioctl.h>
@@ -209,7 +210,6 @@ static char default_environment[] = {
 };
 
 static int flash_io (int mode);
-static char *envmatch (char * s1, char * s2);
 static int env_init (void);
 static int parse_config (void);
 
@@ -226,32 +226,171 @@ static inline ulong getenvsize (void)
 }
 
 /*
- * Search the environment for a variable.
- * Return the value, if found, or NULL, if not found.
+ * While the environment is open, its variables are kept in a list in
+ * environment order and hashed by name. Setting or deleting a variable
+ * only changes the list (a new value goes to the end, as in U-Boot);
+ * fw_env_commit() writes the list back to flash in one go, so a batch of
+ * changes costs one erase/write cycle instead of one per variable.
  */
-char *fw_getenv (char *name)
+#define ENV_HASH_SIZE	256
+
+struct env_var {
+	char		*str;		/* "name=value" */
+	int		namelen;
+	int		alloced;	/* str is malloced, not in environment */
+	struct env_var	*prev, *next;	/* environment order */
+	struct env_var	*hash_next;
+};
+
+static struct env_var *env_head, *env_tail;
+static struct env_var *env_hash[ENV_HASH_SIZE];
+static int env_opened;
+static int env_changed;
+static ulong env_used;		/* bytes used, incl. the final '\0' */
+static int env_all_or_nothing;	/* fw_setenv: a failure writes nothing */
+
+static struct env_var **env_hash_slot (const char *name, int len)
 {
-	char *env, *nxt;
+	unsigned int h = 0;
 
-	if (env_init ())
-		return NULL;
+	while (len--)
+		h = h * 31 + (unsigned char)*name++;
+	return &env_hash[h % ENV_HASH_SIZE];
+}
 
-	for (env = environment.data; *env; env = nxt + 1) {
-		char *val;
+static struct env_var *env_find (const char *name)
+{
+	struct env_var *var;
+	int len = strlen (name);
+
+	for (var = *env_hash_slot (name, len); var; var = var->hash_next)
+		if (var->namelen == len && !strncmp (var->str, name, len))
+			return var;
+	return NULL;
+}
+
+static int env_add (char *str, int alloced)
+{
+	struct env_var *var, **slot;
+	char *eq = strchr (str, '=');
 
+	var = malloc (sizeof (*var));
+	if (!var) {
+		fprintf (stderr, "Not enough memory for environment\n");
+		return -1;
+	}
+	var->str = str;
+	var->namelen = eq ? eq - str : strlen (str);
+	var->alloced = alloced;
+
+	var->prev = env_tail;
+	var->next = NULL;
+	if (env_tail)
+		env_tail->next = var;
+	else
+		env_head = var;
+	env_tail = var;
+
+	slot = env_hash_slot (str, var->namelen);
+	var->hash_next = *slot;
+	*slot = var;
+
+	env_used += strlen (str) + 1;
+	return 0;
+}
+
+static void env_del (struct env_var *var)
+{
+	struct env_var **p;
+
+	for (p = env_hash_slot (var->str, var->namelen); *p;
+	     p = &(*p)->hash_next) {
+		if (*p == var) {
+			*p = var->hash_next;
+			break;
+		}
+	}
+	if (var->prev)
+		var->prev->next = var->next;
+	else
+		env_head = var->next;
+	if (var->next)
+		var->next->prev = var->prev;
+	else
+		env_tail = var->prev;
+
+	env_used -= strlen (var->str) + 1;
+	if (var->alloced)
+		free (var->str);
+	free (var);
+}
+
+static void env_free_index (void)
+{
+	while (env_head)
+		env_del (env_head);
+}
+
+/* Build the list and the hash from environment.data */
+static int env_index (void)
+{
+	char *env, *nxt;
+
+	env_used = 1;
+	for (env = environment.data; *env; env = nxt + 1) {
 		for (nxt = env; *nxt; ++nxt) {
 			if (nxt >= &environment.data[ENV_SIZE]) {
 				fprintf (stderr, "## Error: "
 					"environment not terminated\n");
-				return NULL;
+				env_free_index ();
+				return -1;
 			}
 		}
-		val = envmatch (name, env);
-		if (!val)
-			continue;
-		return val;
+		if (env_add (env, 0)) {
+			env_free_index ();
+			return -1;
+		}
 	}
-	return NULL;
+	return 0;
+}
+
+/*
+ * Read the configuration and the environment, once. Returns 0 if the
+ * environment is open (also if it already was), -1 on error.
+ */
+int fw_env_open (void)
+{
+	if (env_opened)
+		return 0;
+
+	if (env_init ())
+		return -1;
+
+	if (env_index ())
+		return -1;
+
+	env_opened = 1;
+	/* after a bad CRC the default environment still has to be written */
+	env_changed = *environment.crc !=
+		crc32 (0, (uint8_t *) environment.data, ENV_SIZE);
+	return 0;
+}
+
+/*
+ * Search the environment for a variable.
+ * Return the value, if found, or NULL, if not found.
+ */
+char *fw_getenv (char *name)
+{
+	struct env_var *var;
+
+	if (fw_env_open ())
+		return NULL;
+
+	var = env_find (name);
+	if (!var || !var->str[var->namelen])
+		return NULL;
+	return var->str + var->namelen + 1;
 }
 
 /*
@@ -260,25 +399,16 @@ char *fw_getenv (char *name)
  */
 int fw_printenv (int argc, char *argv[])
 {
-	char *env, *nxt;
+	struct env_var *var;
 	int i, n_flag;
 	int rc = 0;
 
-	if (env_init ())
+	if (fw_env_open ())
 		return -1;
 
 	if (argc == 1) {		/* Print all env variables  */
-		for (env = environment.data; *env; env = nxt + 1) {
-			for (nxt = env; *nxt; ++nxt) {
-				if (nxt >= &environment.data[ENV_SIZE]) {
-					fprintf (stderr, "## Error: "
-						"environment not terminated\n");
-					return -1;
-				}
-			}
-
-			printf ("%s\n", env);
-		}
+		for (var = env_head; var; var = var->next)
+			printf ("%s\n", var->str);
 		return 0;
 	}
 
@@ -297,28 +427,15 @@ int fw_printenv (int argc, char *argv[])
 
 	for (i = 1; i < argc; ++i) {	/* print single env variables   */
 		char *name = argv[i];
-		char *val = NULL;
+		char *val = fw_getenv (name);
 
-		for (env = environment.data; *env; env = nxt + 1) {
-
-			for (nxt = env; *nxt; ++nxt) {
-				if (nxt >= &environment.data[ENV_SIZE]) {
-					fprintf (stderr, "## Error: "
-						"environment not terminated\n");
-					return -1;
-				}
-			}
-			val = envmatch (name, env);
-			if (val) {
-				if (!n_flag) {
-					fputs (name, stdout);
-					putc ('=', stdout);
-				}
-				puts (val);
-				break;
+		if (val) {
+			if (!n_flag) {
+				fputs (name, stdout);
+				putc ('=', stdout);
 			}
-		}
-		if (!val) {
+			puts (val);
+		} else {
 			fprintf (stderr, "## Error: \"%s\" not defined\n", name);
 			rc = -1;
 		}
@@ -328,50 +445,28 @@ int fw_printenv (int argc, char *argv[])
 }
 
 /*
- * Deletes or sets environment variables. Returns -1 and sets errno error codes:
- * 0	  - OK
- * EINVAL - need at least 1 argument
+ * Set (or with value == NULL delete) a variable in the open environment.
+ * Nothing is written until fw_env_commit(). Returns -1 and sets errno:
  * EROFS  - certain variables ("ethaddr", "serial#") cannot be
  *	    modified or deleted
- *
+ * ENOSPC - the environment is full, the variable is deleted (fw_setenv
+ *	    drops the whole change instead, so the flash keeps the old value)
  */
-int fw_setenv (int argc, char *argv[])
+int fw_env_write (char *name, char *value)
 {
-	int i, len;
-	char *env, *nxt;
-	char *oldval = NULL;
-	char *name;
+	struct env_var *var;
+	char *str;
+	ulong len;
+	int deleted = 0;
 
-	if (argc < 2) {
-		errno = EINVAL;
+	if (fw_env_open ())
 		return -1;
-	}
-
-	if (env_init ())
-		return -1;
-
-	name = argv[1];
-
-	/*
-	 * search if variable with this name already exists
-	 */
-	for (nxt = env = environment.data; *env; env = nxt + 1) {
-		for (nxt = env; *nxt; ++nxt) {
-			if (nxt >= &environment.data[ENV_SIZE]) {
-				fprintf (stderr, "## Error: "
-					"environment not terminated\n");
-				errno = EINVAL;
-				return -1;
-			}
-		}
-		if ((oldval = envmatch (name, env)) != NULL)
-			break;
-	}
 
 	/*
 	 * Delete any existing definition
 	 */
-	if (oldval) {
+	var = env_find (name);
+	if (var) {
 		/*
 		 * Ethernet Address and serial# can be set only once
 		 */
@@ -381,58 +476,67 @@ int fw_setenv (int argc, char *argv[])
 			errno = EROFS;
 			return -1;
 		}
-
-		if (*++nxt == '\0') {
-			*env = '\0';
-		} else {
-			for (;;) {
-				*env = *nxt++;
-				if ((*env == '\0') && (*nxt == '\0'))
-					break;
-				++env;
-			}
-		}
-		*++env = '\0';
+		env_del (var);
+		env_changed = 1;
+		deleted = 1;
 	}
 
 	/* Delete only ? */
-	if (argc < 3)
-		goto WRITE_FLASH;
+	if (!value)
+		return 0;
 
 	/*
 	 * Append new definition at the end
 	 */
-	for (env = environment.data; *env || *(env + 1); ++env);
-	if (env > environment.data)
-		++env;
-	/*
-	 * Overflow when:
-	 * "name" + "=" + "val" +"\0\0"  > CONFIG_ENV_SIZE - (env-environment)
-	 */
-	len = strlen (name) + 2;
-	/* add '=' for first arg, ' ' for all others */
-	for (i = 2; i < argc; ++i) {
-		len += strlen (argv[i]) + 1;
+	len = strlen (name) + 1 + strlen (value) + 1;
+	if (env_used + len > ENV_SIZE) {
+		fprintf (stderr, "Error: environment overflow, \"%s\" %s\n",
+			name, deleted && !env_all_or_nothing ?
+			"deleted" : "not set");
+		errno = ENOSPC;
+		return -1;
 	}
-	if (len > (&environment.data[ENV_SIZE] - env)) {
-		fprintf (stderr,
-			"Error: environment overflow, \"%s\" deleted\n",
-			name);
+	str = malloc (len);
+	if (!str) {
+		fprintf (stderr, "Not enough memory for environment\n");
 		return -1;
 	}
-	while ((*env = *name++) != '\0')
-		env++;
-	for (i = 2; i < argc; ++i) {
-		char *val = argv[i];
-
-		*env = (i == 2) ? '=' : ' ';
-		while ((*++env = *val++) != '\0');
+	sprintf (str, "%s=%s", name, value);
+	if (env_add (str, 1)) {
+		free (str);
+		return -1;
 	}
+	env_changed = 1;
+
+	return 0;
+}
+
+/*
+ * Write the open environment back to flash if anything was changed
+ * since it was opened or last committed.
+ */
+int fw_env_commit (void)
+{
+	struct env_var *var;
+	char *data, *env;
 
+	if (!env_opened || !env_changed)
+		return 0;
+
+	data = calloc (1, ENV_SIZE);
+	if (!data) {
+		fprintf (stderr, "Not enough memory for environment\n");
+		return -1;
+	}
+	for (env = data, var = env_head; var; var = var->next)
+		env = stpcpy (env, var->str) + 1;
 	/* end is marked with double '\0' */
-	*++env = '\0';
 
-  WRITE_FLASH:
+	env_free_index ();
+	memcpy (environment.data, data, ENV_SIZE);
+	free (data);
+	if (env_index ())
+		return -1;
 
 	/*
 	 * Update CRC
@@ -445,9 +549,153 @@ int fw_setenv (int argc, char *argv[])
 		return -1;
 	}
 
+	env_changed = 0;
 	return 0;
 }
 
+/*
+ * Forget the open environment, including changes not committed.
+ */
+void fw_env_close (void)
+{
+	if (!env_opened)
+		return;
+
+	env_free_index ();
+	free (environment.image);
+	environment.image = NULL;
+	env_opened = 0;
+}
+
+/*
+ * Apply "name [value ...]" lines from a file ("-": stdin), as if each
+ * was given to fw_setenv, and commit them at once. Empty lines and
+ * lines starting with '#' are ignored. On any error nothing is written.
+ */
+static int fw_env_script (const char *fname)
+{
+	FILE *fp;
+	char *line = NULL, *name, *val, *p;
+	size_t size = 0;
+	ssize_t len;
+	int lineno = 0;
+	int rc = 0;
+
+	if (strcmp (fname, "-") == 0) {
+		fp = stdin;
+	} else {
+		fp = fopen (fname, "r");
+		if (fp == NULL) {
+			fprintf (stderr, "Can't open %s: %s\n",
+				fname, strerror (errno));
+			return -1;
+		}
+	}
+
+	while ((len = getline (&line, &size, fp)) >= 0) {
+		lineno++;
+		while (len > 0 &&
+		       (line[len - 1] == '\n' || line[len - 1] == '\r'))
+			line[--len] = '\0';
+
+		for (name = line; *name == ' ' || *name == '\t'; name++)
+			;
+		if (*name == '\0' || *name == '#')
+			continue;
+
+		for (p = name; *p && *p != ' ' && *p != '\t'; p++)
+			;
+		for (val = p; *val == ' ' || *val == '\t'; val++)
+			;
+		*p = '\0';
+
+		if (fw_env_write (name, *val ? val : NULL)) {
+			fprintf (stderr, "%s:%d: can't set \"%s\", "
+				"nothing written\n", fname, lineno, name);
+			rc = -1;
+			break;
+		}
+	}
+	if (rc == 0 && ferror (fp)) {
+		fprintf (stderr, "Read error on %s\n", fname);
+		rc = -1;
+	}
+
+	free (line);
+	if (fp != stdin)
+		fclose (fp);
+
+	if (rc == 0)
+		rc = fw_env_commit ();
+	return rc;
+}
+
+/*
+ * Deletes or sets environment variables. Returns -1 and sets errno error codes:
+ * 0	  - OK
+ * EINVAL - need at least 1 argument
+ * EROFS  - certain variables ("ethaddr", "serial#") cannot be
+ *	    modified or deleted
+ *
+ * "fw_setenv -s file" applies a whole script of changes, see
+ * fw_env_script().
+ */
+int fw_setenv (int argc, char *argv[])
+{
+	int i, rc;
+	ulong len;
+	char *value = NULL;
+
+	if (argc < 2) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (strcmp (argv[1], "-s") == 0) {
+		if (argc != 3) {
+			errno = EINVAL;
+			return -1;
+		}
+		if (fw_env_open ())
+			return -1;
+		env_all_or_nothing = 1;
+		rc = fw_env_script (argv[2]);
+		env_all_or_nothing = 0;
+		fw_env_close ();
+		return rc;
+	}
+
+	if (argc > 2) {
+		/* all values, separated by single blanks */
+		for (len = 0, i = 2; i < argc; ++i)
+			len += strlen (argv[i]) + 1;
+		value = malloc (len);
+		if (!value) {
+			fprintf (stderr, "Not enough memory for value\n");
+			return -1;
+		}
+		strcpy (value, argv[2]);
+		for (i = 3; i < argc; ++i) {
+			strcat (value, " ");
+			strcat (value, argv[i]);
+		}
+	}
+
+	if (fw_env_open ()) {
+		free (value);
+		return -1;
+	}
+	env_all_or_nothing = 1;
+	rc = fw_env_write (argv[1], value);
+	env_all_or_nothing = 0;
+	if (rc == 0)
+		rc = fw_env_commit ();
+	fw_env_close ();
+	free (value);
+
+	return rc;
+}
+
 /*
  * Test for bad block on NAND, just returns 0 on NOR, on NAND:
  * 0	- block is good
@@ -857,24 +1105,11 @@ exit:
 		return -1;
 	}
 
-	return rc;
-}
-
-/*
- * s1 is either a simple 'name', or a 'name=value' pair.
- * s2 is a 'name=value' pair.
- * If the names match, return the value of s2, else NULL.
- */
-
-static char *envmatch (char * s1, char * s2)
-{
+	/* the copy just written is the current one for the next commit */
+	if (mode == O_RDWR && rc == 0)
+		dev_current = dev_target;
 
-	while (*s1 == *s2++)
-		if (*s1++ == '=')
-			return s2;
-	if (*s1 == '\0' && *(s2 - 1) == '=')
-		return s2;
-	return NULL;
+	return rc;
 }
 
 /*
@@ -917,6 +1152,8 @@ static int env_init (void)
 		environment.crc		= &single->crc;
 		environment.flags	= NULL;
 		environment.data	= single->data;
+		/* a redundant setup opened before may have left its scheme */
+		environment.flag_scheme = FLAG_NONE;
 	}
 
 	dev_current = 0;
@@ -27,7 +27,9 @@
  * See included "fw_env.config" sample file (TRAB board)
  * for notes on configuration.
  */
+#ifndef CONFIG_FILE	/* test/fw_env_test.c uses its own */
 #define CONFIG_FILE     "/etc/fw_env.config"
+#endif
 
 #define HAVE_REDUND /* For systems with 2 env sectors */
 #define DEVICE1_NAME      "/dev/mtd1"
@@ -51,4 +53,15 @@ extern int   fw_printenv(int argc, char *argv[]);
 extern char *fw_getenv  (char *name);
 extern int fw_setenv  (int argc, char *argv[]);
 
+/*
+ * Library use: fw_env_open() reads the environment once, fw_getenv()
+ * and fw_env_write() (value NULL deletes) work on the copy in memory,
+ * fw_env_commit() writes all changes to flash in one go and
+ * fw_env_close() drops the copy, including changes not committed.
+ */
+extern int   fw_env_open  (void);
+extern int   fw_env_write (char *name, char *value);
+extern int   fw_env_commit(void);
+extern void  fw_env_close (void);
+
 extern unsigned	long  crc32	 (unsigned long, const unsigned char *, unsigned);
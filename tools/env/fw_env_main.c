@@ -37,6 +37,12 @@
  *		  separated by single blank characters, and the
  *		  resulting string is assigned to the environment
  *		  variable "name"
+ *	fw_setenv -s file
+ *		- Applies one "name [ value ... ]" line of "file" ("-"
+ *		  for stdin) after the other like the above, and writes
+ *		  the environment to flash once at the end. Empty lines
+ *		  and lines starting with '#' are skipped. If any line
+ *		  fails, nothing is written.
  */
 
 #include <stdio.h>
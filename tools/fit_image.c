@@ -29,10 +29,201 @@
 
 #include "mkimage.h"
 #include <image.h>
+#ifdef MKIMAGE_PTHREAD
+#include <pthread.h>
+#endif
 #include <u-boot/crc.h>
 
 static image_header_t header;
 
+#ifdef MKIMAGE_PTHREAD
+/* one hash subnode of a component image */
+struct fit_hash_job {
+	int		noffset;
+	int		image_noffset;
+	const void	*data;
+	size_t		size;
+	char		*algo;
+	uint8_t		value[FIT_MAX_HASH_LEN];
+	int		value_len;
+	int		ret;
+};
+
+struct fit_hash_pool {
+	struct fit_hash_job	*jobs;
+	int			njobs;
+	int			next;	/* next job to be taken */
+	pthread_mutex_t		lock;
+};
+
+static void *fit_hash_worker (void *arg)
+{
+	struct fit_hash_pool *pool = arg;
+	struct fit_hash_job *job;
+	int i;
+
+	for (;;) {
+		pthread_mutex_lock (&pool->lock);
+		i = pool->next++;
+		pthread_mutex_unlock (&pool->lock);
+		if (i >= pool->njobs)
+			return NULL;
+
+		job = &pool->jobs[i];
+		job->ret = calculate_hash (job->data, job->size, job->algo,
+					job->value, &job->value_len);
+	}
+}
+
+/* biggest first, so that no thread is left with a big one at the end */
+static int fit_hash_job_by_size (const void *a, const void *b)
+{
+	const struct fit_hash_job *ja = a, *jb = b;
+
+	return (ja->size < jb->size) - (ja->size > jb->size);
+}
+
+static int fit_hash_job_by_offset (const void *a, const void *b)
+{
+	const struct fit_hash_job *ja = a, *jb = b;
+
+	return (ja->noffset < jb->noffset) - (ja->noffset > jb->noffset);
+}
+
+/**
+ * fit_set_hashes_parallel - fit_set_hashes() with a pool of threads
+ * @fit: pointer to the FIT format image header
+ * @nthreads: number of hashing threads
+ *
+ * All hash subnodes are collected first and hashed concurrently while
+ * the blob is left alone, so the data pointers stay valid. The values
+ * are then set from the last hash node to the first: setting a value
+ * only moves what follows that node, so the offsets of the remaining
+ * nodes don't change. The resulting blob is the same as the one
+ * fit_set_hashes() produces.
+ *
+ * returns:
+ *     0, on success
+ *    <0, on failure
+ */
+static int fit_set_hashes_parallel (void *fit, int nthreads)
+{
+	struct fit_hash_pool pool;
+	struct fit_hash_job *job;
+	pthread_t *threads;
+	const void *data;
+	size_t size;
+	int images_noffset, image_noffset, noffset;
+	int idepth, ndepth, max = 0;
+	int i, ret = 0;
+
+	images_noffset = fdt_path_offset (fit, FIT_IMAGES_PATH);
+	if (images_noffset < 0) {
+		printf ("Can't find images parent node '%s' (%s)\n",
+			FIT_IMAGES_PATH, fdt_strerror (images_noffset));
+		return images_noffset;
+	}
+
+	memset (&pool, 0, sizeof(pool));
+	for (idepth = 0,
+	     image_noffset = fdt_next_node (fit, images_noffset, &idepth);
+	     (image_noffset >= 0) && (idepth > 0);
+	     image_noffset = fdt_next_node (fit, image_noffset, &idepth)) {
+		if (idepth != 1)
+			continue;
+
+		if (fit_image_get_data (fit, image_noffset, &data, &size)) {
+			printf ("Can't get image data/size\n");
+			ret = -1;
+			goto out;
+		}
+
+		for (ndepth = 0,
+		     noffset = fdt_next_node (fit, image_noffset, &ndepth);
+		     (noffset >= 0) && (ndepth > 0);
+		     noffset = fdt_next_node (fit, noffset, &ndepth)) {
+			if (ndepth != 1 ||
+			    strncmp (fit_get_name (fit, noffset, NULL),
+					FIT_HASH_NODENAME,
+					strlen (FIT_HASH_NODENAME)) != 0)
+				continue;
+
+			if (pool.njobs == max) {
+				max = max ? 2 * max : 16;
+				job = realloc (pool.jobs, max * sizeof(*job));
+				if (!job) {
+					printf ("Can't allocate hash jobs\n");
+					ret = -1;
+					goto out;
+				}
+				pool.jobs = job;
+			}
+			job = &pool.jobs[pool.njobs++];
+			memset (job, 0, sizeof(*job));
+			job->noffset = noffset;
+			job->image_noffset = image_noffset;
+			job->data = data;
+			job->size = size;
+
+			if (fit_image_hash_get_algo (fit, noffset,
+						&job->algo)) {
+				printf ("Can't get hash algo property for "
+					"'%s' hash node in '%s' image node\n",
+					fit_get_name (fit, noffset, NULL),
+					fit_get_name (fit, image_noffset,
+						NULL));
+				ret = -1;
+				goto out;
+			}
+		}
+	}
+
+	if (nthreads > pool.njobs)
+		nthreads = pool.njobs;
+	qsort (pool.jobs, pool.njobs, sizeof(*job), fit_hash_job_by_size);
+	pthread_mutex_init (&pool.lock, NULL);
+	threads = malloc (nthreads * sizeof(*threads));
+	for (i = 0; threads && i < nthreads - 1; i++)
+		if (pthread_create (&threads[i], NULL, fit_hash_worker,
+				&pool))
+			break;
+	/* the calling thread works too, alone if no thread could start */
+	fit_hash_worker (&pool);
+	while (i--)
+		pthread_join (threads[i], NULL);
+	free (threads);
+	pthread_mutex_destroy (&pool.lock);
+
+	qsort (pool.jobs, pool.njobs, sizeof(*job), fit_hash_job_by_offset);
+	for (job = pool.jobs; job < pool.jobs + pool.njobs; job++) {
+		if (job->ret) {
+			printf ("Unsupported hash algorithm (%s) for "
+				"'%s' hash node in '%s' image node\n",
+				job->algo,
+				fit_get_name (fit, job->noffset, NULL),
+				fit_get_name (fit, job->image_noffset, NULL));
+			ret = -1;
+			goto out;
+		}
+	}
+	for (job = pool.jobs; job < pool.jobs + pool.njobs; job++) {
+		if (fit_image_hash_set_value (fit, job->noffset, job->value,
+					job->value_len)) {
+			printf ("Can't set hash value for "
+				"'%s' hash node in '%s' image node\n",
+				fit_get_name (fit, job->noffset, NULL),
+				fit_get_name (fit, job->image_noffset, NULL));
+			ret = -1;
+			goto out;
+		}
+	}
+
+out:
+	free (pool.jobs);
+	return ret;
+}
+#endif /* MKIMAGE_PTHREAD */
+
 static int fit_verify_header (unsigned char *ptr, int image_size,
 			struct mkimage_params *params)
 {
@@ -63,7 +254,7 @@ static int fit_handle_file (struct mkimage_params *params)
 {
 	char tmpfile[MKIMAGE_MAX_TMPFILE_LEN];
 	char cmd[MKIMAGE_MAX_DTC_CMDLINE_LEN];
-	int tfd;
+	int tfd, ret;
 	struct stat sbuf;
 	unsigned char *ptr;
 
@@ -90,6 +281,7 @@ static int fit_handle_file (struct mkimage_params *params)
 		unlink (tmpfile);
 		return (EXIT_FAILURE);
 	}
+	mkimage_stage ("dtc");
 
 	/* load FIT blob into memory */
 	tfd = open (tmpfile, O_RDWR|O_BINARY);
@@ -125,12 +317,19 @@ static int fit_handle_file (struct mkimage_params *params)
 	}
 
 	/* set hashes for images in the blob */
-	if (fit_set_hashes (ptr)) {
+#ifdef MKIMAGE_PTHREAD
+	if (params->jobs > 1)
+		ret = fit_set_hashes_parallel (ptr, params->jobs);
+	else
+#endif
+		ret = fit_set_hashes (ptr);
+	if (ret) {
 		fprintf (stderr, "%s Can't add hashes to FIT blob",
 				params->cmdname);
 		unlink (tmpfile);
 		return (EXIT_FAILURE);
 	}
+	mkimage_stage ("hash");
 
 	/* add a timestamp at offset 0 i.e., root  */
 	if (fit_set_timestamp (ptr, 0, sbuf.st_mtime)) {
@@ -140,6 +339,7 @@ static int fit_handle_file (struct mkimage_params *params)
 		return (EXIT_FAILURE);
 	}
 	debug ("Added timestamp successfully\n");
+	mkimage_stage ("timestamp");
 
 	munmap ((void *)ptr, sbuf.st_size);
 	close (tfd);
@@ -0,0 +1,64 @@
+/*
+ * Host build of the "mbench" memory benchmark, see include/mbench.h
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <mbench.h>
+
+unsigned long long mbench_time_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+int main(int argc, char **argv)
+{
+	unsigned long size = 1 << 20;
+	unsigned int loops = 4;
+	void *buf;
+
+	if (argc > 3) {
+		fprintf(stderr, "Usage: %s [size [loops]]\n", *argv);
+		exit(EXIT_FAILURE);
+	}
+	if (argc > 1)
+		size = strtoul(argv[1], NULL, 0);
+	if (argc > 2)
+		loops = strtoul(argv[2], NULL, 0);
+
+	buf = malloc(size);
+	if (!buf) {
+		fprintf(stderr, "%s: out of memory\n", *argv);
+		exit(EXIT_FAILURE);
+	}
+
+	printf("mbench: host, 0x%lx bytes, %u loops\n", size, loops);
+	if (mbench(buf, size, loops))
+		exit(EXIT_FAILURE);
+
+	free(buf);
+	return EXIT_SUCCESS;
+}
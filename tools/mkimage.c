@@ -23,8 +23,11 @@
 
 #include "mkimage.h"
 #include <image.h>
+#include <sys/time.h>
+#include <u-boot/crc.h>
 
 static void copy_file(int, const char *, int);
+static void write_data(int, const void *, size_t);
 static void usage(void);
 
 /* image_type_params link list to maintain registered image type supports */
@@ -38,6 +41,7 @@ struct mkimage_params params = {
 	.comp = IH_COMP_GZIP,
 	.dtc = MKIMAGE_DEFAULT_DTC_OPTIONS,
 	.imagename = "",
+	.jobs = 1,
 };
 
 /*
@@ -140,6 +144,28 @@ int mkimage_verify_print_header (void *ptr, struct stat *sbuf)
 	return retval;
 }
 
+/*
+ * mkimage_stage -
+ *
+ * With -v, prints the time since the previous call (or since start)
+ * as the time taken by the named stage. NULL only restarts the clock.
+ */
+void mkimage_stage (const char *stage)
+{
+	static struct timeval last;
+	struct timeval now;
+	long us;
+
+	gettimeofday (&now, NULL);
+	if (stage && params.vflag) {
+		us = (now.tv_sec - last.tv_sec) * 1000000L +
+			(now.tv_usec - last.tv_usec);
+		fprintf (stderr, "%s: %-10s %6ld.%03ld ms\n", params.cmdname,
+			stage, us / 1000, us % 1000);
+	}
+	last = now;
+}
+
 int
 main (int argc, char **argv)
 {
@@ -160,6 +186,7 @@ main (int argc, char **argv)
 
 	params.cmdname = *argv;
 	params.addr = params.ep = 0;
+	mkimage_stage (NULL);
 
 	while (--argc > 0 && **++argv == '-') {
 		while (*++*argv) {
@@ -240,6 +267,18 @@ main (int argc, char **argv)
 				params.datafile = *++argv;
 				params.fflag = 1;
 				goto NXTARG;
+			case 'j':
+				if (--argc <= 0)
+					usage ();
+				params.jobs = strtoul (*++argv,
+						(char **)&ptr, 10);
+				if (*ptr) {
+					fprintf (stderr,
+						"%s: invalid number of jobs %s\n",
+						params.cmdname, *argv);
+					exit (EXIT_FAILURE);
+				}
+				goto NXTARG;
 			case 'n':
 				if (--argc <= 0)
 					usage ();
@@ -261,6 +300,15 @@ NXTARG:		;
 	if (argc != 1)
 		usage ();
 
+	/* -j 0: one hashing thread per CPU */
+	if (params.jobs <= 0) {
+#ifdef _SC_NPROCESSORS_ONLN
+		params.jobs = sysconf (_SC_NPROCESSORS_ONLN);
+#endif
+		if (params.jobs <= 0)
+			params.jobs = 1;
+	}
+
 	/* set tparams as per input type_id */
 	tparams = mkimage_get_type(params.type);
 	if (tparams == NULL) {
@@ -390,12 +438,7 @@ NXTARG:		;
 				size = 0;
 			}
 
-			if (write(ifd, (char *)&size, sizeof(size)) != sizeof(size)) {
-				fprintf (stderr, "%s: Write error on %s: %s\n",
-					params.cmdname, params.imagefile,
-					strerror(errno));
-				exit (EXIT_FAILURE);
-			}
+			write_data (ifd, &size, sizeof(size));
 
 			if (!file) {
 				break;
@@ -426,6 +469,7 @@ NXTARG:		;
 	} else {
 		copy_file (ifd, params.datafile, 0);
 	}
+	mkimage_stage ("copy");
 
 	/* We're a bit of paranoid */
 #if defined(_POSIX_SYNCHRONIZED_IO) && \
@@ -436,6 +480,7 @@ NXTARG:		;
 #else
 	(void) fsync (ifd);
 #endif
+	mkimage_stage ("sync");
 
 	if (fstat(ifd, &sbuf) < 0) {
 		fprintf (stderr, "%s: Can't stat %s: %s\n",
@@ -458,6 +503,7 @@ NXTARG:		;
 			params.cmdname, tparams->name, strerror(errno));
 		exit (EXIT_FAILURE);
 	}
+	mkimage_stage ("header");
 
 	/* Print the image information by processing image header */
 	if (tparams->print_header)
@@ -485,10 +531,37 @@ NXTARG:		;
 			params.cmdname, params.imagefile, strerror(errno));
 		exit (EXIT_FAILURE);
 	}
+	mkimage_stage ("finish");
 
 	exit (EXIT_SUCCESS);
 }
 
+/*
+ * Appends image data after the header, in chunks, taking the crc32 of
+ * each chunk just before it is written while it is still in the cache.
+ * This way the default image type gets ih_dcrc without a second pass
+ * over the output file.
+ */
+static void
+write_data (int ifd, const void *buf, size_t len)
+{
+	const unsigned char *p = buf;
+	size_t n;
+
+	while (len) {
+		n = len < MKIMAGE_COPY_CHUNK ? len : MKIMAGE_COPY_CHUNK;
+		params.dcrc = crc32 (params.dcrc, p, n);
+		if (write(ifd, p, n) != (ssize_t)n) {
+			fprintf (stderr, "%s: Write error on %s: %s\n",
+				params.cmdname, params.imagefile,
+				strerror(errno));
+			exit (EXIT_FAILURE);
+		}
+		p += n;
+		len -= n;
+	}
+}
+
 static void
 copy_file (int ifd, const char *datafile, int pad)
 {
@@ -552,21 +625,10 @@ copy_file (int ifd, const char *datafile, int pad)
 	}
 
 	size = sbuf.st_size - offset;
-	if (write(ifd, ptr + offset, size) != size) {
-		fprintf (stderr, "%s: Write error on %s: %s\n",
-			params.cmdname, params.imagefile, strerror(errno));
-		exit (EXIT_FAILURE);
-	}
+	write_data (ifd, ptr + offset, size);
 
-	if (pad && ((tail = size % 4) != 0)) {
-
-		if (write(ifd, (char *)&zero, 4-tail) != 4-tail) {
-			fprintf (stderr, "%s: Write error on %s: %s\n",
-				params.cmdname, params.imagefile,
-				strerror(errno));
-			exit (EXIT_FAILURE);
-		}
-	}
+	if (pad && ((tail = size % 4) != 0))
+		write_data (ifd, &zero, 4 - tail);
 
 	(void) munmap((void *)ptr, sbuf.st_size);
 	(void) close (dfd);
@@ -590,7 +652,14 @@ usage ()
 			 "          -d ==> use image data from 'datafile'\n"
 			 "          -x ==> set XIP (execute in place)\n",
 		params.cmdname);
-	fprintf (stderr, "       %s [-D dtc_options] -f fit-image.its fit-image\n",
+	fprintf (stderr, "       %s [-D dtc_options] [-j jobs] -f fit-image.its fit-image\n"
+#ifdef MKIMAGE_PTHREAD
+			 "          -j ==> hash images using 'jobs' threads "
+			 "(0: one per CPU)\n"
+#else
+			 "          -j ==> ignored, built without threads\n"
+#endif
+			 "          -v ==> verbose, report the time taken by each stage\n",
 		params.cmdname);
 
 	exit (EXIT_FAILURE);
@@ -47,6 +47,7 @@
 #define MKIMAGE_DEFAULT_DTC_OPTIONS	"-I dts -O dtb -p 500"
 #define MKIMAGE_MAX_DTC_CMDLINE_LEN	512
 #define MKIMAGE_DTC			"dtc"   /* assume dtc is in $PATH */
+#define MKIMAGE_COPY_CHUNK		(1 << 20)
 
 /*
  * This structure defines all such variables those are initialized by
@@ -60,6 +61,7 @@ struct mkimage_params {
 	int lflag;
 	int vflag;
 	int xflag;
+	int jobs;		/* threads for FIT hashing */
 	int os;
 	int arch;
 	int type;
@@ -71,6 +73,7 @@ struct mkimage_params {
 	char *datafile;
 	char *imagefile;
 	char *cmdname;
+	uint32_t dcrc;		/* crc32 of everything written after the header */
 };
 
 /*
@@ -130,6 +133,7 @@ struct image_type_params {
  * Exported functions
  */
 void mkimage_register (struct image_type_params *tparams);
+void mkimage_stage (const char *stage);
 
 /*
  * There is a c file associated with supported image type low level code
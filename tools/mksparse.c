@@ -0,0 +1,239 @@
+/*
+ * Create sparse flash images, see include/sparse_format.h
+ *
+ * See file CREDITS for list of people who contributed to this
+ * project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+ * MA 02111-1307 USA
+ */
+
+#include "os_support.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <compiler.h>
+#include <sparse_format.h>
+
+extern uint32_t crc32(uint32_t, const unsigned char *, unsigned int);
+
+static char *cmdname;
+
+enum { BLK_RAW, BLK_FILL, BLK_DONT_CARE };
+
+static void usage(void)
+{
+	fprintf(stderr, "Usage: %s [-b blksz] [-e byte] [-q] image sparse_image\n"
+		"          -b ==> block size, multiple of 512 and of the "
+		"flash page size (default 4096)\n"
+		"          -e ==> blocks filled with this byte are not written,\n"
+		"                 e.g. -e 0xff for NAND, which is erased anyway\n"
+		"          -q ==> quiet\n",
+		cmdname);
+	exit(EXIT_FAILURE);
+}
+
+static void xwrite(int fd, const void *buf, size_t len, uint32_t *crc)
+{
+	if (write(fd, buf, len) != (ssize_t)len) {
+		fprintf(stderr, "%s: write error: %s\n", cmdname,
+			strerror(errno));
+		exit(EXIT_FAILURE);
+	}
+	if (crc)
+		*crc = crc32(*crc, buf, len);
+}
+
+/* Classify one block; *val is the fill word for BLK_FILL */
+static int classify(const uint8_t *blk, uint32_t blk_sz, int erased,
+		    uint32_t *val)
+{
+	uint32_t first, w;
+	uint32_t i;
+
+	memcpy(&first, blk, sizeof(first));
+	for (i = sizeof(w); i < blk_sz; i += sizeof(w)) {
+		memcpy(&w, blk + i, sizeof(w));
+		if (w != first)
+			return BLK_RAW;
+	}
+
+	*val = le32_to_cpu(first);
+	if (erased >= 0 && *val == (uint32_t)erased * 0x01010101)
+		return BLK_DONT_CARE;
+
+	return BLK_FILL;
+}
+
+int main(int argc, char **argv)
+{
+	struct sparse_header hdr;
+	struct sparse_chunk chunk;
+	struct stat sbuf;
+	uint8_t *data;
+	uint32_t blk_sz = 4096, nblks, blk, crc = 0;
+	uint32_t chunks = 0, count[3] = { 0, 0, 0 };
+	unsigned long long out_sz;
+	int erased = -1, quiet = 0;
+	int ifd, ofd, c;
+
+	cmdname = *argv;
+
+	while ((c = getopt(argc, argv, "b:e:q")) != -1) {
+		switch (c) {
+		case 'b':
+			blk_sz = strtoul(optarg, NULL, 0);
+			break;
+		case 'e':
+			erased = strtoul(optarg, NULL, 0) & 0xff;
+			break;
+		case 'q':
+			quiet = 1;
+			break;
+		default:
+			usage();
+		}
+	}
+
+	if (argc - optind != 2 || !blk_sz || blk_sz % 512)
+		usage();
+
+	ifd = open(argv[optind], O_RDONLY | O_BINARY);
+	if (ifd < 0 || fstat(ifd, &sbuf) < 0) {
+		fprintf(stderr, "%s: Can't open %s: %s\n", cmdname,
+			argv[optind], strerror(errno));
+		exit(EXIT_FAILURE);
+	}
+
+	/* the last block is padded with the erased byte (or zeros) */
+	nblks = (sbuf.st_size + blk_sz - 1) / blk_sz;
+	if (!nblks) {
+		fprintf(stderr, "%s: %s is empty\n", cmdname, argv[optind]);
+		exit(EXIT_FAILURE);
+	}
+	data = malloc((size_t)nblks * blk_sz);
+	if (!data) {
+		fprintf(stderr, "%s: out of memory\n", cmdname);
+		exit(EXIT_FAILURE);
+	}
+	memset(data + (nblks - 1) * (size_t)blk_sz, erased >= 0 ? erased : 0,
+	       blk_sz);
+	if (read(ifd, data, sbuf.st_size) != sbuf.st_size) {
+		fprintf(stderr, "%s: Can't read %s: %s\n", cmdname,
+			argv[optind], strerror(errno));
+		exit(EXIT_FAILURE);
+	}
+	close(ifd);
+
+	ofd = open(argv[optind + 1], O_RDWR | O_CREAT | O_TRUNC | O_BINARY,
+		   0666);
+	if (ofd < 0) {
+		fprintf(stderr, "%s: Can't open %s: %s\n", cmdname,
+			argv[optind + 1], strerror(errno));
+		exit(EXIT_FAILURE);
+	}
+
+	/* header goes last, once the checksum is known */
+	memset(&hdr, 0, sizeof(hdr));
+	xwrite(ofd, &hdr, sizeof(hdr), NULL);
+	out_sz = sizeof(hdr);
+
+	for (blk = 0; blk < nblks; ) {
+		uint32_t val, next_val, run;
+		int type;
+
+		type = classify(data + (size_t)blk * blk_sz, blk_sz, erased,
+				&val);
+		for (run = 1; blk + run < nblks; run++) {
+			if (classify(data + (size_t)(blk + run) * blk_sz,
+				     blk_sz, erased, &next_val) != type)
+				break;
+			if (type == BLK_FILL && next_val != val)
+				break;
+		}
+
+		memset(&chunk, 0, sizeof(chunk));
+		chunk.chunk_sz = cpu_to_le32(run);
+		switch (type) {
+		case BLK_RAW:
+			chunk.chunk_type = cpu_to_le16(SPARSE_CHUNK_RAW);
+			chunk.total_sz = cpu_to_le32(sizeof(chunk) +
+						     run * blk_sz);
+			xwrite(ofd, &chunk, sizeof(chunk), &crc);
+			xwrite(ofd, data + (size_t)blk * blk_sz,
+			       (size_t)run * blk_sz, &crc);
+			out_sz += sizeof(chunk) + (unsigned long long)run * blk_sz;
+			break;
+		case BLK_FILL:
+			chunk.chunk_type = cpu_to_le16(SPARSE_CHUNK_FILL);
+			chunk.total_sz = cpu_to_le32(sizeof(chunk) + sizeof(val));
+			val = cpu_to_le32(val);
+			xwrite(ofd, &chunk, sizeof(chunk), &crc);
+			xwrite(ofd, &val, sizeof(val), &crc);
+			out_sz += sizeof(chunk) + sizeof(val);
+			break;
+		default:
+			chunk.chunk_type = cpu_to_le16(SPARSE_CHUNK_DONT_CARE);
+			chunk.total_sz = cpu_to_le32(sizeof(chunk));
+			xwrite(ofd, &chunk, sizeof(chunk), &crc);
+			out_sz += sizeof(chunk);
+			break;
+		}
+
+		count[type] += run;
+		chunks++;
+		blk += run;
+	}
+
+	hdr.magic = cpu_to_le32(SPARSE_HEADER_MAGIC);
+	hdr.major_version = cpu_to_le16(SPARSE_MAJOR_VERSION);
+	hdr.minor_version = cpu_to_le16(0);
+	hdr.file_hdr_sz = cpu_to_le16(sizeof(hdr));
+	hdr.chunk_hdr_sz = cpu_to_le16(sizeof(chunk));
+	hdr.blk_sz = cpu_to_le32(blk_sz);
+	hdr.total_blks = cpu_to_le32(nblks);
+	hdr.total_chunks = cpu_to_le32(chunks);
+	hdr.image_checksum = cpu_to_le32(crc);
+
+	if (lseek(ofd, 0, SEEK_SET) != 0) {
+		fprintf(stderr, "%s: Can't seek %s: %s\n", cmdname,
+			argv[optind + 1], strerror(errno));
+		exit(EXIT_FAILURE);
+	}
+	xwrite(ofd, &hdr, sizeof(hdr), NULL);
+
+	if (close(ofd)) {
+		fprintf(stderr, "%s: Write error on %s: %s\n", cmdname,
+			argv[optind + 1], strerror(errno));
+		exit(EXIT_FAILURE);
+	}
+
+	if (!quiet)
+		printf("%u blocks of %u bytes in %u chunks: %u raw, %u fill, "
+		       "%u don't care\n"
+		       "sparse image %llu bytes (%llu%% of %llu)\n",
+		       nblks, blk_sz, chunks, count[BLK_RAW], count[BLK_FILL],
+		       count[BLK_DONT_CARE], out_sz,
+		       out_sz * 100 / ((unsigned long long)nblks * blk_sz),
+		       (unsigned long long)nblks * blk_sz);
+
+	free(data);
+	return EXIT_SUCCESS;
+}